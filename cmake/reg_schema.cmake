@@ -0,0 +1,116 @@
+## Registry schema generator
+# Turns registry.db0-output.txt into static registry tables.
+# Usage: cmake -DINPUT=<registry.db0-output.txt> -DOUTPUT_DIR=<dir> -P reg_schema.cmake
+# Writes reg_schema.h (per key id defines) and reg_schema_tables.h (key table and id index).
+# Per key id defines are category path, name, type and size.
+
+if(NOT DEFINED INPUT OR NOT DEFINED OUTPUT_DIR)
+  message(FATAL_ERROR "INPUT and OUTPUT_DIR must be defined")
+endif()
+
+file(READ "${INPUT}" content)
+
+# BASE section: id=name of each folder/key name
+string(FIND "${content}" "\n[BASE\n" base_start)
+string(FIND "${content}" "\n[REG-BAS\n" keys_start)
+if(base_start LESS 0 OR keys_start LESS 0)
+  message(FATAL_ERROR "${INPUT}: missing [BASE or [REG-BAS section")
+endif()
+math(EXPR base_start "${base_start} + 7")
+math(EXPR base_length "${keys_start} - ${base_start}")
+string(SUBSTRING "${content}" ${base_start} ${base_length} base_section)
+
+# REG-BAS section: default keys, later sections only hold regional default values
+math(EXPR keys_start "${keys_start} + 10")
+string(SUBSTRING "${content}" ${keys_start} -1 keys_section)
+string(FIND "${keys_section}" "\n[" keys_end)
+if(keys_end GREATER_EQUAL 0)
+  string(SUBSTRING "${keys_section}" 0 ${keys_end} keys_section)
+endif()
+
+string(REGEX MATCHALL "[0-9]+=[^\n]+" base_lines "${base_section}")
+foreach(line IN LISTS base_lines)
+  string(REGEX MATCH "^([0-9]+)=(.*)$" match "${line}")
+  set(name_${CMAKE_MATCH_1} "${CMAKE_MATCH_2}")
+endforeach()
+
+# build sortable key list "<path>/<name> <id>|<size path>|<type>|<size>|<slot min>|<slot max>"
+set(keys)
+set(max_id 0)
+string(REGEX MATCHALL "/[0-9/]+=[0-9]+:[0-9]+:" key_lines "${keys_section}")
+foreach(line IN LISTS key_lines)
+  string(REGEX MATCH "^([0-9/]+)=([0-9]+):([0-9]+):$" match "${line}")
+  set(key_type ${CMAKE_MATCH_2})
+  set(key_size ${CMAKE_MATCH_3})
+  string(REGEX REPLACE "^/" "" ids "${CMAKE_MATCH_1}")
+  string(REPLACE "/" ";" ids "${ids}")
+  list(GET ids -1 key_id)
+  list(REMOVE_AT ids -1)
+
+  # numbered folders like 01-30/ become a %02i slot
+  set(key_path "")
+  set(slot_min 0)
+  set(slot_max 0)
+  foreach(id IN LISTS ids)
+    string(REGEX REPLACE "/$" "" folder "${name_${id}}")
+    if(folder MATCHES "^([0-9]+)-([0-9]+)$")
+      math(EXPR slot_min "${CMAKE_MATCH_1}")
+      math(EXPR slot_max "${CMAKE_MATCH_2}")
+      set(folder "%02i")
+    endif()
+    string(APPEND key_path "/${folder}")
+  endforeach()
+  string(LENGTH "${key_path}" size_path)
+
+  # space sorts before any path character, so the list sorts like strcmp() on the full path
+  list(APPEND keys "${key_path}/${name_${key_id}} ${key_id}|${size_path}|${key_type}|${key_size}|${slot_min}|${slot_max}")
+  if(key_id GREATER max_id)
+    set(max_id ${key_id})
+  endif()
+endforeach()
+list(SORT keys)
+list(LENGTH keys key_count)
+
+set(header "// generated from registry.db0-output.txt by cmake/reg_schema.cmake, do not edit\n\n")
+string(APPEND header "#ifndef __REG_SCHEMA_H__\n#define __REG_SCHEMA_H__\n\n")
+string(APPEND header "#define REG_SCHEMA_KEY_COUNT ${key_count}\n#define REG_SCHEMA_MAX_ID ${max_id}\n\n")
+set(tables "// generated from registry.db0-output.txt by cmake/reg_schema.cmake, do not edit\n\n")
+string(APPEND tables "// sorted by key path and name\nconst struct Schema_Key reg_schema_keys[(REG_SCHEMA_KEY_COUNT)] = {\n")
+
+set(index 0)
+foreach(key IN LISTS keys)
+  string(REPLACE " " "|" fields "${key}")
+  string(REPLACE "|" ";" fields "${fields}")
+  list(GET fields 0 full_path)
+  list(GET fields 1 key_id)
+  list(GET fields 2 size_path)
+  list(GET fields 3 key_type)
+  list(GET fields 4 key_size)
+  list(GET fields 5 slot_min)
+  list(GET fields 6 slot_max)
+  string(APPEND tables "\t{ ${key_id}, \"${full_path}\", ${size_path}, ${key_type}, ${key_size}, ${slot_min}, ${slot_max}, },\n")
+  string(SUBSTRING "${full_path}" 0 ${size_path} key_path)
+  math(EXPR name_start "${size_path} + 1")
+  string(SUBSTRING "${full_path}" ${name_start} -1 key_name)
+  string(APPEND header "#define REG_KEY_PATH_${key_id} \"${key_path}\"\n#define REG_KEY_NAME_${key_id} \"${key_name}\"\n")
+  string(APPEND header "#define REG_KEY_TYPE_${key_id} ${key_type}\n#define REG_KEY_SIZE_${key_id} ${key_size}\n")
+  set(index_${key_id} ${index})
+  math(EXPR index "${index} + 1")
+endforeach()
+string(APPEND tables "};\n\n")
+
+# key ids are unique, so the id itself is a perfect hash into this index
+string(APPEND tables "// key table index of each key id, -1 for folder ids\nconst short reg_schema_index_by_id[(REG_SCHEMA_MAX_ID)+1] = {\n")
+foreach(id RANGE 0 ${max_id})
+  if(DEFINED index_${id})
+    string(APPEND tables "\t${index_${id}},\n")
+  else()
+    string(APPEND tables "\t-1,\n")
+  endif()
+endforeach()
+string(APPEND tables "};\n")
+
+string(APPEND header "\n#endif  /* __REG_SCHEMA_H__ */\n")
+
+file(WRITE "${OUTPUT_DIR}/reg_schema.h" "${header}")
+file(WRITE "${OUTPUT_DIR}/reg_schema_tables.h" "${tables}")
@@ -20,6 +20,7 @@
 #ifndef __ACCOUNT_H__
 #define __ACCOUNT_H__
 
+#include <blob.h> // for Manifest_Entry
 #include <registry.h> // for Registry_Data
 
 struct File_Entry {
@@ -35,12 +36,17 @@ struct File_Data {
 	struct File_Entry *file_entries;
 };
 
+extern const char *const accounts_folder;
+extern struct Registry_Data template_account_reg_data;
+extern struct File_Data template_account_file_data;
+
 void init_account_reg_data(struct Registry_Data **reg_data_ptr);
 void get_initial_account_reg_data(struct Registry_Data *reg_data);
 void get_current_account_reg_data(struct Registry_Data *reg_data);
 
 void init_account_file_data(struct File_Data *file_data);
 void get_current_account_file_data(struct File_Data *file_data);
+int restore_account_file(const char *source_path, const struct Manifest_Entry *const entry, const char *save_path, char *target_path);
 void unlink_all_memory_cards(char *title);
 
 char* get_user_combination(const char* username);
@@ -49,6 +55,8 @@ int switch_saves_folder(const char* base_path, const char* current_user, const c
 void display_account_details_short(struct Registry_Data *reg_data, int *no_user);
 void display_account_details_full(struct Registry_Data *reg_data, struct File_Data *file_data, char *title);
 void save_account_details(struct Registry_Data *reg_data, struct File_Data *file_data, char *title);
+void read_account_details(struct Registry_Data *reg_data, struct File_Data *file_data, struct Registry_Data *reg_init_data, struct File_Data *file_init_data, int display);
+int switch_to_account(struct Registry_Data *reg_data, struct Registry_Data *reg_init_data, struct File_Data *file_init_data, const char *username);
 int switch_account(struct Registry_Data *reg_data, struct Registry_Data *reg_init_data, struct File_Data *file_init_data, char *title);
 int remove_account(struct Registry_Data *reg_data, struct Registry_Data *reg_init_data, struct File_Data *file_init_data, char *title);
 
@@ -0,0 +1,69 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __ARCHIVE_H__
+#define __ARCHIVE_H__
+
+// single file archive: header, entry payloads, then table of contents
+// toc entries are followed by their path, relative to the accounts folder
+#define ARCHIVE_VERSION 1
+
+enum {
+	ARCHIVE_ENTRY_FILE=0,  // plain file, extracted as is
+	ARCHIVE_ENTRY_PAYLOAD=1,  // account file, extracted into blob store
+};
+
+struct Archive_Header {
+	char magic[4];
+	unsigned int version;
+	unsigned int toc_offset;
+	unsigned int toc_count;
+};
+
+struct Archive_Toc_Entry {
+	unsigned int offset;
+	unsigned int size;
+	unsigned short type;
+	unsigned short path_size;
+};
+
+struct Archive_Entry {
+	unsigned int offset;
+	unsigned int size;
+	int type;
+	char *path;
+};
+
+struct Archive_Toc {
+	int count;
+	struct Archive_Entry *entries;
+	char *data;
+};
+
+extern const char *const archive_file;
+
+int read_archive_toc(const char *archive_path, struct Archive_Toc *toc);
+void free_archive_toc(struct Archive_Toc *toc);
+int export_accounts_archive(const char *archive_path, int display);
+int import_accounts_archive(const char *archive_path, const char *username, int display);
+void export_accounts(char *title);
+void import_accounts(char *title);
+
+#endif  /* __ARCHIVE_H__ */
@@ -0,0 +1,57 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __BATCH_H__
+#define __BATCH_H__
+
+#include <account.h>
+#include <wlan.h>
+
+#define BATCH_LINE_SIZE 256
+#define BATCH_LOG_SIZE ((BATCH_LINE_SIZE) + 64)
+
+enum {
+	BATCH_NONE=-1,  // no batch file found
+	BATCH_DONE=0,
+	BATCH_REBOOT=1,  // batch requested reboot
+};
+
+// data the batch commands work on, owned by main menu
+struct Batch_Data {
+	struct Registry_Data *initial_account_reg_data;
+	struct Registry_Data *current_account_reg_data;
+	struct File_Data *initial_account_file_data;
+	struct File_Data *current_account_file_data;
+	struct Wlan_Data *current_wlan_data;
+	int reboot;  // changes need reboot to take effect
+	int reboot_now;  // reboot command reached
+};
+
+struct Batch_Command {
+	const char *const name;
+	int (*run)(struct Batch_Data *batch_data, const char *argument);
+};
+
+extern int batch_mode;
+extern const char *const batch_file;
+
+int run_batch(struct Batch_Data *batch_data);
+
+#endif  /* __BATCH_H__ */
@@ -0,0 +1,36 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#define BENCH_LINE_SIZE 255
+
+// one measurement, result is a single line of text
+struct Bench_Entry {
+	const char *const name;
+	int (*run)(char *result, int size);  // returns < 0 on failure
+};
+
+extern const char *const bench_report_file;
+
+void run_benchmarks(char *title);
+
+#endif  /* __BENCH_H__ */
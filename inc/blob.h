@@ -0,0 +1,73 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __BLOB_H__
+#define __BLOB_H__
+
+#define MANIFEST_PATH_SIZE 256
+
+struct Blob_Ref {
+	unsigned long long hash;
+	int size;
+	int refs;
+	unsigned int checksum;  // xxHash32 of content
+	int has_checksum;  // refs of older versions have none
+};
+
+struct Blob_Store {
+	int count;
+	int dirty;
+	struct Blob_Ref *refs;
+};
+
+struct Manifest_Entry {
+	unsigned long long hash;
+	int size;
+	unsigned int checksum;  // xxHash32 of content, computed while storing
+	int has_checksum;  // manifests of older versions have none
+	char save_path[(MANIFEST_PATH_SIZE)+1];
+};
+
+struct Manifest_Data {
+	int count;
+	struct Manifest_Entry *entries;
+};
+
+extern const char *const blobs_folder;
+extern const char *const manifest_file;
+
+void open_blob_store(struct Blob_Store *store);
+void close_blob_store(struct Blob_Store *store);
+void build_blob_path(char *path, unsigned long long hash, int compressed);
+int check_blob_exists(unsigned long long hash);
+int restore_blob(unsigned long long hash, const char *target_path, unsigned int *checksum_ptr);
+int restore_checked_blob(const struct Manifest_Entry *const entry, const char *target_path);
+int store_blob(struct Blob_Store *store, const char *source_path, unsigned long long *hash_ptr, int *size_ptr, unsigned int *checksum_ptr);
+void ref_blob(struct Blob_Store *store, unsigned long long hash, int size, unsigned int checksum);
+void unref_blob(struct Blob_Store *store, unsigned long long hash);
+
+void load_manifest(const char *const base_path, struct Manifest_Data *manifest);
+void save_manifest(const char *const base_path, const struct Manifest_Data *const manifest);
+void free_manifest(struct Manifest_Data *manifest);
+struct Manifest_Entry *find_manifest_entry(const struct Manifest_Data *const manifest, const char *save_path);
+void set_manifest_entry(struct Blob_Store *store, struct Manifest_Data *manifest, const char *save_path, unsigned long long hash, int size, unsigned int checksum);
+void remove_manifest_entry(struct Blob_Store *store, struct Manifest_Data *manifest, const char *save_path);
+
+#endif  /* __BLOB_H__ */
@@ -0,0 +1,45 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef __BUFPOOL_H__
+#define __BUFPOOL_H__
+
+#include <file.h>  // for TRANSFER_SIZE
+
+#define BUFFER_POOL_BLOCKS 8  // ui thread, worker, verify threads and prefetch, compression needs two
+#define BUFFER_POOL_BLOCK_SIZE (TRANSFER_SIZE)
+#define BUFFER_POOL_ALIGN 4096
+
+struct Buffer_Pool_Stats {
+	int in_use;
+	int high_water;  // most blocks in use at once
+	int borrowed;
+	int fallbacks;  // borrows served by memalign() as pool was empty
+};
+
+extern struct Buffer_Pool_Stats buffer_pool_stats;
+
+void init_buffer_pool(void);
+void free_buffer_pool(void);
+void *borrow_buffer(void);
+void return_buffer(void *buffer);
+
+#endif  /* __BUFPOOL_H__ */
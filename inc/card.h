@@ -0,0 +1,36 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __CARD_H__
+#define __CARD_H__
+
+#include <account.h>
+#include <blob.h>
+
+#define CARD_ID_SIZE 16  // hex digits of random card id
+
+extern const char *const card_folder;
+
+int find_card_device(const struct File_Entry *const file_entry);
+int get_card_id(const char *device, char *card_id, int create);
+int build_card_save_path(const char *device, char *save_path, int create);
+void save_card_links(struct Blob_Store *store, struct Manifest_Data *manifest);
+
+#endif  /* __CARD_H__ */
@@ -20,15 +20,32 @@
 #ifndef __DIR_H__
 #define __DIR_H__
 
+#define DIR_PREFIX_SIZE 64
+
 struct Dir_Entry {
 	size_t size;
 	char *name;
 };
 
+// range of sorted dir entries starting with prefix
+struct Dir_Filter {
+	struct Dir_Entry *dirs;
+	int dir_count;
+	int first;
+	int count;
+	int size_prefix;
+	char prefix[(DIR_PREFIX_SIZE)+1];
+};
+
 extern const char *const slash_folder;
 
 void create_path(char *check_path, int start_offset, int display);
 int get_subdirs(const char *const base_path, struct Dir_Entry **dirs_ptr);
 void free_subdirs(struct Dir_Entry *dirs, int dir_count);
+void sort_subdirs(struct Dir_Entry *dirs, int dir_count);
+int find_subdir_prefix(const struct Dir_Entry *const dirs, int dir_count, const char *prefix, int size_prefix, int after);
+int find_subdir_group(const struct Dir_Entry *const dirs, int dir_count, int index, int size, int direction);
+void init_dir_filter(struct Dir_Filter *filter, struct Dir_Entry *dirs, int dir_count);
+void set_dir_filter_prefix(struct Dir_Filter *filter, const char *prefix, int size_prefix);
 
 #endif  /* __DIR_H__ */
@@ -22,12 +22,33 @@
 #define MAX_PATH_LENGTH 1024
 #define TRANSFER_SIZE (128 * 1024)
 
+extern volatile unsigned int file_bytes_copied;
+
+// Hooks of copy_file_codec(), NULL hooks copy plain bytes
+struct Copy_Codec {
+  int (*read_start)(void *context, int fd);  // check source header
+  int (*write_start)(void *context, int fd);  // write destination header
+  int (*read)(void *context, int fd, void *buf);  // up to TRANSFER_SIZE raw bytes into buf, 0 at end of source
+  int (*write)(void *context, int fd, const void *buf, int size);  // raw bytes from buf, 0 bytes once at end
+};
+
+struct Scratch_Arena {
+  char *base;
+  int size;
+  int used;
+};
+
+void init_scratch_arena(struct Scratch_Arena *arena, void *buffer, int size);
+int arena_read_file(struct Scratch_Arena *arena, const char *file, void **buffer_ptr);
 int allocate_read_file(const char *file, void **buffer_ptr);
+int borrow_read_file(const char *file, void **buffer_ptr);
 int read_file(const char *file, void *buf, int size);
+int read_text_line(const char **pos_ptr, const char *end, char *line, int size);
 int write_file(const char *file, const void *buf, int size);
 int get_file_size(const char *file);
 int check_file_exists(const char *file);
 int check_folder_exists(const char *folder);
-int copy_file(const char *src_path, const char *dst_path);
+int copy_file_codec(const char *src_path, const char *dst_path, unsigned int *checksum_ptr, const struct Copy_Codec *codec, void *context);
+int copy_file(const char *src_path, const char *dst_path, unsigned int *checksum_ptr);
 
 #endif  /* __FILE_H__ */
@@ -0,0 +1,41 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __HASH_H__
+#define __HASH_H__
+
+// FNV-1a 64-bit, used as content address for the blob store
+#define HASH_FNV1A64_INIT 0xcbf29ce484222325ULL
+
+// xxHash32, streaming checksum of copied file content
+struct Hash_Xxh32_State {
+	unsigned int acc[4];
+	unsigned long long total;
+	int buffered;
+	unsigned char buffer[16];
+};
+
+unsigned long long hash_fnv1a64_update(unsigned long long hash, const void *data, int size);
+void hash_xxh32_init(struct Hash_Xxh32_State *state);
+void hash_xxh32_update(struct Hash_Xxh32_State *state, const void *data, int size);
+unsigned int hash_xxh32_digest(const struct Hash_Xxh32_State *const state);
+int hash_file(const char *file, unsigned long long *hash_ptr, unsigned int *checksum_ptr);
+
+#endif  /* __HASH_H__ */
@@ -20,9 +20,12 @@
 #ifndef __HISTORY_H__
 #define __HISTORY_H__
 
+#define TITLE_ID_SIZE 9
+
 struct History_Entry {
 	const char *const file_path;
 	const char *const file_name_path;
+	const int text_records;  // one record per line, can be scrubbed line by line
 	int file_available;
 	int file_protected;
 };
@@ -33,8 +36,19 @@ struct History_Data {
 	struct History_Entry *entries;
 };
 
+// sorted title IDs of installed homebrew
+struct Title_Filter {
+	int count;
+	char (*ids)[(TITLE_ID_SIZE)];
+	unsigned char first_chars[256 / 8];  // bitset of first characters for quick rejection
+};
+
 extern struct History_Data execution_history_data;
 
+int load_homebrew_title_filter(struct Title_Filter *filter);
+void free_title_filter(struct Title_Filter *filter);
+int scrub_mlog_file(const char *file, const struct Title_Filter *const filter);
+
 void get_current_execution_history_data(struct History_Data *hist_data);
 void display_execution_history_details(struct History_Data *hist_data, char *title);
 void delete_execution_history(struct History_Data *hist_data, char *title);
@@ -0,0 +1,51 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __LISTVIEW_H__
+#define __LISTVIEW_H__
+
+#define LIST_VIEW_MAX_ROWS 68  // screen height with smallest font
+
+// draws row content after the marker cell, must not print a newline
+typedef void (*List_View_Draw_Row)(void *context, int index);
+
+// paged list that remembers what is on screen and only repaints changed rows and markers
+struct List_View {
+	int x;
+	int y;
+	int rows;
+	int count;
+	int top;
+	int cursor;
+	int drawn_cursor;
+	int drawn_index[(LIST_VIEW_MAX_ROWS)];  // entry shown in each row, -1 = empty, -2 = unknown
+	List_View_Draw_Row draw_row;
+	void *context;
+};
+
+void init_list_view(struct List_View *view, int x, int y, int count, List_View_Draw_Row draw_row, void *context);
+void invalidate_list_view(struct List_View *view);
+void invalidate_list_row(struct List_View *view, int index);
+void set_list_view_count(struct List_View *view, int count);
+void set_list_view_cursor(struct List_View *view, int cursor);
+int handle_list_view_key(struct List_View *view, int button_pressed);
+void draw_list_view(struct List_View *view);
+
+#endif  /* __LISTVIEW_H__ */
@@ -0,0 +1,36 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __LZ_H__
+#define __LZ_H__
+
+// LZ4-style block codec, files are framed as a sequence of independent blocks
+#define LZ_BLOCK_SIZE (64 * 1024)  // positions must fit into 16 bit
+#define LZ_BLOCK_BOUND(size) ((size) + ((size) / 255) + 16)
+#define LZ_HASH_BITS 12
+
+extern const char lz_magic[4];
+
+int lz_compress_block(const unsigned char *src, int src_size, unsigned char *dst, int dst_capacity, unsigned short *hash_table);
+int lz_decompress_block(const unsigned char *src, int src_size, unsigned char *dst, int dst_capacity);
+int copy_file_compress(const char *src_path, const char *dst_path, unsigned int *checksum_ptr);
+int copy_file_decompress(const char *src_path, const char *dst_path, unsigned int *checksum_ptr);
+
+#endif  /* __LZ_H__ */
@@ -0,0 +1,66 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __MENU_H__
+#define __MENU_H__
+
+#include <dir.h>
+#include <listview.h>
+
+// results of select callback
+#define MENU_STAY    0  // keep menu as is
+#define MENU_REDRAW  1  // redraw complete screen
+#define MENU_EXIT    2  // leave menu
+
+struct Menu;
+
+// draws info between title and list, may update count of rows
+typedef void (*Menu_Draw_Info)(struct Menu *menu);
+// returns whether row can be highlighted
+typedef int (*Menu_Check_Row)(struct Menu *menu, int index);
+// handles enter button on row, returns MENU_STAY, MENU_REDRAW or MENU_EXIT
+typedef int (*Menu_Select_Row)(struct Menu *menu, int index);
+// called with highlighted row before waiting for next key
+typedef void (*Menu_Highlight_Row)(struct Menu *menu, int index);
+// handles keys not used for moving or selecting, returns MENU_STAY, MENU_REDRAW or MENU_EXIT
+typedef int (*Menu_Handle_Key)(struct Menu *menu, int button_pressed);
+
+// paged menu, rows are drawn lazily by index via draw_row(context, index)
+struct Menu {
+	const char *title;
+	int count;
+	Menu_Draw_Info draw_info;
+	List_View_Draw_Row draw_row;
+	Menu_Check_Row check_row;  // optional
+	Menu_Select_Row select_row;
+	Menu_Highlight_Row highlight_row;  // optional
+	Menu_Handle_Key handle_key;  // optional
+	void *context;
+	int data_x;  // start of data part below first pixel line
+	int data_y;
+	struct List_View list_view;
+};
+
+void init_menu(struct Menu *menu, const char *title, int count, List_View_Draw_Row draw_row, Menu_Select_Row select_row, void *context);
+void clear_menu_data(struct Menu *menu);
+void run_menu(struct Menu *menu);
+int handle_dir_filter_key(struct Menu *menu, struct Dir_Filter *filter, int first_row, int button_pressed);
+
+#endif  /* __MENU_H__ */
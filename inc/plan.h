@@ -0,0 +1,64 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __PLAN_H__
+#define __PLAN_H__
+
+#include <account.h>
+#include <blob.h>
+#include <file.h>
+#include <registry.h>
+
+enum {
+	PLAN_STEP_REGISTRY=0,  // write changed registry keys
+	PLAN_STEP_RESTORE_FILE=1,  // replace live account file by stored one
+	PLAN_STEP_DELETE_FILE=2,  // remove live account file not stored for account
+	PLAN_STEP_DELETE_HISTORY=3,
+	PLAN_STEP_SWAP_SAVES=4,
+	PLAN_STEP_RESTORE_CARD=5,  // restore stored id.dat of inserted memory card
+	PLAN_STEP_ARCHIVE_TROPHIES=6,  // store trophy data of current account
+	PLAN_STEP_RESTORE_TROPHIES=7,  // replace trophy data by stored one of new account
+};
+
+struct Plan_Step {
+	int type;
+	int file_index;  // entry of file data for file steps
+};
+
+// steps needed to switch from current to new account
+struct Switch_Plan {
+	int count;  // planned steps
+	int total;  // steps of a full switch
+	int done;  // successfully executed steps
+	int cancelled;  // steps skipped after cancel
+	int trophy_archived;  // trophy archive step succeeded, live trophy data may be replaced
+	unsigned long long total_bytes;  // stored file bytes to restore
+	struct Plan_Step *steps;
+	struct Registry_Diff reg_diff;
+	struct Manifest_Data manifest;
+	int size_base_path;
+	char base_path[(MAX_PATH_LENGTH)+1];
+};
+
+int build_switch_plan(struct Switch_Plan *plan, struct Registry_Data *reg_data, struct Registry_Data *reg_new_data, struct File_Data *file_new_data, int full);
+int execute_switch_plan(struct Switch_Plan *plan, struct Registry_Data *reg_data, struct Registry_Data *reg_new_data, struct File_Data *file_new_data);
+void free_switch_plan(struct Switch_Plan *plan);
+
+#endif  /* __PLAN_H__ */
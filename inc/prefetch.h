@@ -0,0 +1,49 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __PREFETCH_H__
+#define __PREFETCH_H__
+
+#include <account.h>  // for File_Data
+#include <registry.h>  // for Registry_Data
+
+#define PREFETCH_SLOTS 4
+#define PREFETCH_NAME_SIZE 64
+
+enum {
+	PREFETCH_EMPTY=0,
+	PREFETCH_LOADING=1,
+	PREFETCH_READY=2,
+};
+
+struct Prefetch_Entry {
+	char username[(PREFETCH_NAME_SIZE)+1];
+	int state;
+	unsigned int last_used;
+	struct Registry_Data *reg_data;
+	struct File_Data file_data;
+};
+
+void start_prefetch(struct Registry_Data *reg_init_data, struct File_Data *file_init_data);
+void stop_prefetch(void);
+void request_prefetch(const char *username);
+int take_prefetched(const char *username, struct Registry_Data **reg_data_ptr, struct File_Data *file_data);
+
+#endif  /* __PREFETCH_H__ */
@@ -0,0 +1,45 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef __REGCACHE_H__
+#define __REGCACHE_H__
+
+#define REG_CACHE_BUCKETS 64  // power of 2
+
+struct Reg_Cache_Stats {
+	int hits;
+	int misses;
+	int writes;
+	int invalidations;
+};
+
+extern struct Reg_Cache_Stats reg_cache_stats;
+
+int reg_cache_get_int(const char *const reg_path, const char *const key_name, int *value);
+int reg_cache_get_str(const char *const reg_path, const char *const key_name, char *value, int size);
+int reg_cache_get_bin(const char *const reg_path, const char *const key_name, void *value, int size);
+int reg_cache_set_int(const char *const reg_path, const char *const key_name, int value);
+int reg_cache_set_str(const char *const reg_path, const char *const key_name, const char *value, int size);
+int reg_cache_set_bin(const char *const reg_path, const char *const key_name, const void *value, int size);
+void refresh_reg_cache(void);
+int get_reg_cache_hit_rate(void);
+
+#endif  /* __REGCACHE_H__ */
@@ -32,29 +32,55 @@ struct Registry_Entry {
 	int key_id;
 	const char *const key_path;
 	const char *const key_save_path;
-	const char *const key_path_extension;
 	const char *const key_name;
 	int key_type;
 	int key_size;
-	void *key_value;
+};
+
+// packed key arrays of a template, built once and shared by all its reg data
+struct Registry_Layout {
+	unsigned short *key_ids;
+	unsigned char *key_types;
+	unsigned short *key_sizes;
+	int *key_offsets;  // offset of each key value inside the values blob
+	int values_size;
 };
 
 struct Registry_Data {
 	int reg_count;
-	size_t reg_size;
-	struct Registry_Entry *reg_entries;
+	const struct Registry_Entry *reg_entries;  // shared with template, never modified
+	struct Registry_Layout *layout;
+	unsigned char *values;  // all key values in one blob, each plus string terminator
 	int idx_username;
 	int idx_login_id;
 	int idx_ssid;
 	int idx_conf_name;
 };
 
+struct Registry_Diff {
+	int count;
+	int changed_count;
+	unsigned char *changed;
+};
+
 #define REG_BUFFER_DEFAULT_SIZE 256
 
+static inline void *get_reg_value(const struct Registry_Data *const reg_data, int i)
+{
+	return (void *)&(reg_data->values[reg_data->layout->key_offsets[i]]);
+}
+
+extern const char *const file_ext_bin;
+extern const char *const file_ext_txt;
+
 void init_reg_data(struct Registry_Data **reg_data_ptr, const struct Registry_Data *const template_reg_data);
 void free_reg_data(struct Registry_Data *reg_data);
-void save_reg_data(const char *const base_path, const struct Registry_Data *const reg_data);
+void save_reg_data(const char *const base_path, const struct Registry_Data *const reg_data, int display);
+void get_reg_data(struct Registry_Data *reg_data, int slot);
 void set_reg_data(struct Registry_Data *reg_data, int slot);
-void load_reg_data(const char *const base_path, struct Registry_Data *reg_data, const struct Registry_Data *const reg_init_data, const int skip_reg_id_1, const int skip_reg_id_2);
+void set_reg_data_diff(struct Registry_Data *reg_data, int slot, const struct Registry_Diff *const reg_diff);
+int diff_reg_data(const struct Registry_Data *const old_data, const struct Registry_Data *const new_data, struct Registry_Diff *reg_diff);
+void free_reg_diff(struct Registry_Diff *reg_diff);
+int load_reg_data(const char *const base_path, struct Registry_Data *reg_data, const struct Registry_Data *const reg_init_data, const int skip_reg_id_1, const int skip_reg_id_2, int display);
 
 #endif  /* __REGISTRY_H__ */
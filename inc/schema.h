@@ -0,0 +1,56 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __SCHEMA_H__
+#define __SCHEMA_H__
+
+#include <reg_schema.h>  // generated from registry.db0-output.txt at build time
+
+// registry key from os0:kd/registry.db0
+struct Schema_Key {
+	int key_id;
+	const char *const key;  // full path incl. key name, numbered folders as %02i
+	int size_path;  // length of category path in key
+	int key_type;
+	int key_size;
+	int slot_min;  // slot range of numbered folder, 0 if none
+	int slot_max;
+};
+
+// type and size of a key id resolved at compile time, for registry templates
+#define SCHEMA_KEY_TYPE(key_id) REG_KEY_TYPE_##key_id
+#define SCHEMA_KEY_SIZE(key_id) REG_KEY_SIZE_##key_id
+
+// registry template entry of a key id, path, name, type and size all come from the schema
+// templates list their keys once as KEY(key_id, save_path) and expand that list with both macros below
+#define REG_TEMPLATE_KEY(key_id, save_path) REG_TEMPLATE_KEY_ENTRY(key_id, save_path)
+#define REG_TEMPLATE_KEY_ENTRY(key_id, save_path) { key_id, REG_KEY_PATH_##key_id, save_path, REG_KEY_NAME_##key_id, SCHEMA_KEY_TYPE(key_id), SCHEMA_KEY_SIZE(key_id), },
+// enum of template positions, so fixed template indexes can be checked at compile time
+#define REG_TEMPLATE_INDEX(key_id, save_path) REG_TEMPLATE_INDEX_OF(key_id),
+#define REG_TEMPLATE_INDEX_OF(key_id) REG_TEMPLATE_INDEX_ID(key_id)
+#define REG_TEMPLATE_INDEX_ID(key_id) REG_TEMPLATE_INDEX_##key_id
+
+extern const struct Schema_Key reg_schema_keys[(REG_SCHEMA_KEY_COUNT)];
+
+const struct Schema_Key *get_schema_key(int key_id);
+const char *get_schema_key_name(const struct Schema_Key *const schema_key);
+void build_schema_key_path(char *reg_path, const struct Schema_Key *const schema_key, int slot);
+
+#endif  /* __SCHEMA_H__ */
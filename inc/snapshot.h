@@ -0,0 +1,79 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <registry.h>  // for Registry_Data
+
+// compact binary image of a registry section:
+// header, then per key: id, type, value size and value bytes
+struct Reg_Snapshot_Header {
+	char magic[4];
+	unsigned short version;
+	unsigned short count;
+};
+
+struct Reg_Snapshot_Key {
+	unsigned short key_id;
+	unsigned short key_type;
+	unsigned short size;
+};
+
+// full registry image of all schema keys: same header with own magic,
+// then per key and slot: id, slot, type, value size and value bytes
+struct Reg_Full_Snapshot_Key {
+	unsigned short key_id;
+	unsigned char slot;
+	unsigned char key_type;
+	unsigned short size;
+};
+
+struct Reg_Full_Stats {
+	int keys;
+	int changed;
+	int failed;
+};
+
+struct Reg_Snapshot {
+	int size;
+	unsigned char *data;
+};
+
+extern const char *const snapshots_folder;
+extern const char *const account_snapshot_name;
+extern const char *const wlan_snapshot_name;
+
+int capture_reg_snapshot(const struct Registry_Data *const reg_data, struct Reg_Snapshot *snapshot);
+int restore_reg_snapshot(const struct Reg_Snapshot *const snapshot, struct Registry_Data *reg_data);
+void free_reg_snapshot(struct Reg_Snapshot *snapshot);
+int save_reg_snapshot(const char *const name, const struct Reg_Snapshot *const snapshot);
+int load_reg_snapshot(const char *const name, struct Reg_Snapshot *snapshot);
+int save_reg_data_snapshot(const char *const name, const struct Registry_Data *const reg_data);
+void clear_reg_section_snapshots(void);
+int snapshot_reg_section(const char *const name, const struct Registry_Data *const template_reg_data, int slot);
+int capture_full_reg_snapshot(struct Reg_Snapshot *snapshot);
+int restore_full_reg_snapshot(const struct Reg_Snapshot *const snapshot, struct Reg_Full_Stats *stats);
+int snapshot_full_registry(void);
+void save_full_registry(char *title);
+int restore_full_registry(char *title);
+void show_last_reg_change(char *title);
+
+#endif  /* __SNAPSHOT_H__ */
@@ -0,0 +1,41 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __TROPHY_H__
+#define __TROPHY_H__
+
+#include <account.h>
+#include <blob.h>
+
+struct Trophy_Stats {
+	int files;
+	int failed;
+	unsigned long long bytes;
+};
+
+extern const char *const trophy_data_path;
+extern const char *const trophy_folder;
+
+int is_trophy_file_entry(const struct File_Entry *const file_entry);
+int check_trophy_archive(const struct Manifest_Data *const manifest);
+int archive_trophy_data(const char *base_path, struct Trophy_Stats *stats);
+int restore_trophy_data(const struct Manifest_Data *const manifest, struct Trophy_Stats *stats);
+
+#endif  /* __TROPHY_H__ */
@@ -0,0 +1,58 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __VERIFY_H__
+#define __VERIFY_H__
+
+#define VERIFY_THREADS 3
+#define VERIFY_NAME_SIZE 64
+
+enum {
+	VERIFY_OK=0,
+	VERIFY_NO_LOGIN_ID=1,
+	VERIFY_MISSING_KEYS=2,
+	VERIFY_BAD_KEYS=4,
+	VERIFY_BAD_FILES=8,  // stored file missing, wrong size or checksum
+};
+
+struct Verify_Result {
+	char username[(VERIFY_NAME_SIZE)+1];
+	unsigned long long signature;  // of registry files and manifest, for cache lookup
+	int status;
+	int keys_missing;
+	int keys_bad;
+	int files_ok;
+	int files_bad;
+	int cached;
+};
+
+struct Verify_Data {
+	int count;
+	struct Verify_Result *results;
+};
+
+extern const char *const verify_report_file;
+
+int verify_account(const char *username, struct Verify_Result *result, int worker);
+int verify_all_accounts(struct Verify_Data *verify_data, int display);
+void free_verify_data(struct Verify_Data *verify_data);
+void verify_accounts(char *title);
+
+#endif  /* __VERIFY_H__ */
@@ -23,16 +23,33 @@
 #include <registry.h>
 
 #define MAX_WLAN 30
+#define WLAN_SSID_SIZE 33
+#define WLAN_INDEX_SIZE 64  // power of 2 above MAX_WLAN
+
+struct Wlan_Index {
+	unsigned int free_slots;  // bit n set = slot n+1 is free
+	unsigned int ssid_hash[(MAX_WLAN)];
+	char ssid[(MAX_WLAN)][(WLAN_SSID_SIZE)+1];
+	signed char slot_by_hash[(WLAN_INDEX_SIZE)];  // -1 = empty bucket
+};
 
 struct Wlan_Data {
 	int wlan_found;
 	struct Registry_Data *wlan_reg_data[(MAX_WLAN)];
+	struct Wlan_Index wlan_index;
 };
 
+extern struct Registry_Data template_wlan_reg_data;
+
 void init_wlan_data(struct Wlan_Data *wlan_data);
 void get_current_wlan_data(struct Wlan_Data *wlan_data);
+int find_wlan_slot(const struct Wlan_Data *const wlan_data, const char *ssid);
+int get_free_wlan_slot(const struct Wlan_Data *const wlan_data);
+void set_wlan_index_slot(struct Wlan_Data *wlan_data, int slot, const char *ssid);
 void save_wlan_details(struct Wlan_Data *wlan_data, char *title);
+void save_all_wlan_details(struct Wlan_Data *wlan_data, char *title);
 void load_wlan_details(struct Wlan_Data *wlan_data, char *title);
+void restore_all_wlan_details(struct Wlan_Data *wlan_data, char *title);
 void main_wlan(void);
 
 #endif  /* __WLAN_H__ */
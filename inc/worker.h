@@ -0,0 +1,66 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef __WORKER_H__
+#define __WORKER_H__
+
+#define WORKER_QUEUE_SIZE 32  // power of 2
+
+enum {
+	WORKER_COMMAND_STEP=0,  // run step of current job
+	WORKER_COMMAND_QUIT=1,
+};
+
+enum {
+	WORKER_EVENT_DONE=0,
+	WORKER_EVENT_FAILED=1,
+	WORKER_EVENT_SKIPPED=2,  // step not run as job got cancelled
+};
+
+struct Worker_Message {
+	int type;
+	int index;
+};
+
+// single producer single consumer ring, head is only written by consumer, tail only by producer
+struct Worker_Queue {
+	volatile unsigned int head;
+	volatile unsigned int tail;
+	struct Worker_Message messages[(WORKER_QUEUE_SIZE)];
+};
+
+// job of independent steps, run in order on the worker thread
+struct Worker_Job {
+	int count;
+	unsigned long long total_bytes;  // expected bytes to copy for rate and ETA, 0 if unknown
+	void *context;
+	int (*run_step)(void *context, int index);  // returns < 0 on failure
+	int commit_step;  // once this step ran all remaining steps run despite cancel, count to allow cancel at every step
+	int done;
+	int failed;
+	int cancelled;
+};
+
+void start_worker(void);
+void stop_worker(void);
+int run_worker_job(struct Worker_Job *job);
+
+#endif  /* __WORKER_H__ */
@@ -21,54 +21,82 @@
 #include <vitasdk.h>
 
 #include <account.h>
+#include <blob.h>
+#include <bufpool.h>
+#include <card.h>
 #include <common.h>
 #include <dir.h>
 #include <file.h>
 #include <history.h>
 #include <main.h>
+#include <menu.h>
+#include <plan.h>
+#include <prefetch.h>
+#include <regcache.h>
 #include <registry.h>
+#include <schema.h>
+#include <settings.h>
+#include <snapshot.h>
+#include <worker.h>
 
 #include <debugScreen.h>
 #define printf psvDebugScreenPrintf
 
 const char *const accounts_folder = "accounts/";
 
-const char *const reg_config_np = "/CONFIG/NP";
-const char *const reg_config_system = "/CONFIG/SYSTEM";
 const char *const file_reg_config_np = "registry/CONFIG/NP/";
 const char *const file_reg_config_system = "registry/CONFIG/SYSTEM/";
-const int reg_id_username = 14;
-const int reg_id_login_id = 258;
-const int reg_id_lang = 271;
-const int reg_id_country = 270;
-const int reg_id_yob = 272;
-const int reg_id_mob = 273;
-const int reg_id_dob = 274;
-const int reg_id_env = 260;
-
-// values from os0:kd/registry.db0 and https://github.com/devnoname120/RegistryEditorMOD/blob/master/regs.c
-struct Registry_Entry template_account_reg_entries[] = {
-	{ reg_id_username, reg_config_system, NULL, NULL, "username", KEY_TYPE_STR, 17, NULL, },
-	{ reg_id_login_id, reg_config_np, file_reg_config_np, NULL, "login_id", KEY_TYPE_STR, 65, NULL, },
-	{ 257, reg_config_np, file_reg_config_np, NULL, "account_id", KEY_TYPE_BIN, 8, NULL, },
-	{ 259, reg_config_np, file_reg_config_np, NULL, "password", KEY_TYPE_STR, 31, NULL, },
-	{ reg_id_country, reg_config_np, file_reg_config_np, NULL, "country", KEY_TYPE_STR, 3, NULL, },
-	{ reg_id_lang, reg_config_np, file_reg_config_np, NULL, "lang", KEY_TYPE_STR, 6, NULL, },
-	{ reg_id_dob, reg_config_np, file_reg_config_np, NULL, "dob", KEY_TYPE_INT, 4, NULL, },
-	{ reg_id_mob, reg_config_np, file_reg_config_np, NULL, "mob", KEY_TYPE_INT, 4, NULL, },
-	{ reg_id_yob, reg_config_np, file_reg_config_np, NULL, "yob", KEY_TYPE_INT, 4, NULL, },
-	{ reg_id_env, reg_config_np, file_reg_config_np, NULL, "env", KEY_TYPE_STR, 17, NULL, },
-	{ 275, reg_config_np, file_reg_config_np, NULL, "has_subaccount", KEY_TYPE_INT, 4, NULL, },
-	{ 269, reg_config_np, file_reg_config_np, NULL, "download_confirmed", KEY_TYPE_INT, 4, NULL, },
-	{ 256, reg_config_np, file_reg_config_np, NULL, "enable_np", KEY_TYPE_INT, 4, NULL, },
+
+#define REG_ID_USERNAME 14
+#define REG_ID_LOGIN_ID 258
+#define REG_ID_LANG 271
+#define REG_ID_COUNTRY 270
+#define REG_ID_YOB 272
+#define REG_ID_MOB 273
+#define REG_ID_DOB 274
+#define REG_ID_ENV 260
+
+// fixed template indexes of special keys
+enum {
+	ACCOUNT_REG_USERNAME=0,
+	ACCOUNT_REG_LOGIN_ID=1,
+};
+
+// key id and save path of each template key, path, name, type and size come from registry schema of os0:kd/registry.db0
+#define ACCOUNT_REG_KEYS(KEY) \
+	KEY(REG_ID_USERNAME, NULL) \
+	KEY(REG_ID_LOGIN_ID, file_reg_config_np) \
+	KEY(257, file_reg_config_np) /* account_id */ \
+	KEY(259, file_reg_config_np) /* password */ \
+	KEY(REG_ID_COUNTRY, file_reg_config_np) \
+	KEY(REG_ID_LANG, file_reg_config_np) \
+	KEY(REG_ID_DOB, file_reg_config_np) \
+	KEY(REG_ID_MOB, file_reg_config_np) \
+	KEY(REG_ID_YOB, file_reg_config_np) \
+	KEY(REG_ID_ENV, file_reg_config_np) \
+	KEY(275, file_reg_config_np) /* has_subaccount */ \
+	KEY(269, file_reg_config_np) /* download_confirmed */ \
+	KEY(256, file_reg_config_np) /* enable_np */
+
+enum {
+	ACCOUNT_REG_KEYS(REG_TEMPLATE_INDEX)
+};
+
+_Static_assert((int)(REG_TEMPLATE_INDEX_OF(REG_ID_USERNAME)) == (int)(ACCOUNT_REG_USERNAME), "username must be at ACCOUNT_REG_USERNAME");
+_Static_assert((int)(REG_TEMPLATE_INDEX_OF(REG_ID_LOGIN_ID)) == (int)(ACCOUNT_REG_LOGIN_ID), "login_id must be at ACCOUNT_REG_LOGIN_ID");
+
+const struct Registry_Entry template_account_reg_entries[] = {
+	ACCOUNT_REG_KEYS(REG_TEMPLATE_KEY)
 };
 
+static struct Registry_Layout template_account_reg_layout;  // built on first use
+
 struct Registry_Data template_account_reg_data = {
 	.reg_count = sizeof(template_account_reg_entries) / sizeof(template_account_reg_entries[0]),
-	.reg_size = sizeof(template_account_reg_entries),
 	.reg_entries = template_account_reg_entries,
-	.idx_username = -1,
-	.idx_login_id = -1,
+	.layout = &template_account_reg_layout,
+	.idx_username = ACCOUNT_REG_USERNAME,
+	.idx_login_id = ACCOUNT_REG_LOGIN_ID,
 	.idx_ssid = -1,
 	.idx_conf_name = -1,
 };
@@ -119,38 +147,38 @@ void get_initial_account_reg_data(struct Registry_Data *reg_data)
 	// set/get initial account registry data
 	for (i = 0; i < reg_data->reg_count; i++) {
 		key_id = reg_data->reg_entries[i].key_id;
-		if (key_id == reg_id_username) {  // create dummy user name
+		if (key_id == (REG_ID_USERNAME)) {  // create dummy user name
 			sceKernelGetRandomNumber((void *)(&user_number), sizeof(user_number));
 			user_number %= 998;
 			user_number++;
 			sceClibSnprintf(string, (STRING_BUFFER_DEFAULT_SIZE), "user%03i", user_number);
 			//
-			value = (char *)(reg_data->reg_entries[i].key_value);
+			value = (char *)(get_reg_value(reg_data, i));
 			sceClibStrncpy(value, string, reg_data->reg_entries[i].key_size);
 			value[reg_data->reg_entries[i].key_size] = '\0';
-		} else if (key_id == reg_id_lang) {  // keep language
-			value = (char *)(reg_data->reg_entries[i].key_value);
-			sceRegMgrGetKeyStr(reg_data->reg_entries[i].key_path, reg_data->reg_entries[i].key_name, value, reg_data->reg_entries[i].key_size);
+		} else if (key_id == (REG_ID_LANG)) {  // keep language
+			value = (char *)(get_reg_value(reg_data, i));
+			reg_cache_get_str(reg_data->reg_entries[i].key_path, reg_data->reg_entries[i].key_name, value, reg_data->reg_entries[i].key_size);
 			if (value[0] == '\0') {  // fallback dummy
 				sceClibStrncpy(value, "en", reg_data->reg_entries[i].key_size);
 			}
 			value[reg_data->reg_entries[i].key_size] = '\0';
-		} else if (key_id == reg_id_country) {  // keep country
-			value = (char *)(reg_data->reg_entries[i].key_value);
-			sceRegMgrGetKeyStr(reg_data->reg_entries[i].key_path, reg_data->reg_entries[i].key_name, value, reg_data->reg_entries[i].key_size);
+		} else if (key_id == (REG_ID_COUNTRY)) {  // keep country
+			value = (char *)(get_reg_value(reg_data, i));
+			reg_cache_get_str(reg_data->reg_entries[i].key_path, reg_data->reg_entries[i].key_name, value, reg_data->reg_entries[i].key_size);
 			if (value[0] == '\0') {  // fallback dummy
 				sceClibStrncpy(value, "gb", reg_data->reg_entries[i].key_size);
 			}
 			value[reg_data->reg_entries[i].key_size] = '\0';
-		} else if (key_id == reg_id_yob) {  // dummy year
-			*((int *)(reg_data->reg_entries[i].key_value)) = 2000;
-		} else if (key_id == reg_id_mob) {  // dummy month
-			*((int *)(reg_data->reg_entries[i].key_value)) = 1;
-		} else if (key_id == reg_id_dob) {  // dummy day
-			*((int *)(reg_data->reg_entries[i].key_value)) = 1;
-		} else if (key_id == reg_id_env) {  // keep environment
-			value = (char *)(reg_data->reg_entries[i].key_value);
-			sceRegMgrGetKeyStr(reg_data->reg_entries[i].key_path, reg_data->reg_entries[i].key_name, value, reg_data->reg_entries[i].key_size);
+		} else if (key_id == (REG_ID_YOB)) {  // dummy year
+			*((int *)(get_reg_value(reg_data, i))) = 2000;
+		} else if (key_id == (REG_ID_MOB)) {  // dummy month
+			*((int *)(get_reg_value(reg_data, i))) = 1;
+		} else if (key_id == (REG_ID_DOB)) {  // dummy day
+			*((int *)(get_reg_value(reg_data, i))) = 1;
+		} else if (key_id == (REG_ID_ENV)) {  // keep environment
+			value = (char *)(get_reg_value(reg_data, i));
+			reg_cache_get_str(reg_data->reg_entries[i].key_path, reg_data->reg_entries[i].key_name, value, reg_data->reg_entries[i].key_size);
 			if (value[0] == '\0') {  // fallback dummy
 				sceClibStrncpy(value, "np", reg_data->reg_entries[i].key_size);
 			}
@@ -163,27 +191,7 @@ void get_initial_account_reg_data(struct Registry_Data *reg_data)
 
 void get_current_account_reg_data(struct Registry_Data *reg_data)
 {
-	int i;
-
-	for (i = 0; i < reg_data->reg_count; i++) {
-		if (reg_data->reg_entries[i].key_value == NULL) {
-			continue;
-		}
-		sceClibMemset(reg_data->reg_entries[i].key_value, 0x00, reg_data->reg_entries[i].key_size);
-
-		switch(reg_data->reg_entries[i].key_type) {
-			case KEY_TYPE_INT:
-				sceRegMgrGetKeyInt(reg_data->reg_entries[i].key_path, reg_data->reg_entries[i].key_name, (int *)(reg_data->reg_entries[i].key_value));
-				break;
-			case KEY_TYPE_STR:
-				sceRegMgrGetKeyStr(reg_data->reg_entries[i].key_path, reg_data->reg_entries[i].key_name, (char *)(reg_data->reg_entries[i].key_value), reg_data->reg_entries[i].key_size);
-				((char *)(reg_data->reg_entries[i].key_value))[reg_data->reg_entries[i].key_size] = '\0';
-				break;
-			case KEY_TYPE_BIN:
-				sceRegMgrGetKeyBin(reg_data->reg_entries[i].key_path, reg_data->reg_entries[i].key_name, reg_data->reg_entries[i].key_value, reg_data->reg_entries[i].key_size);
-				break;
-		}
-	}
+	get_reg_data(reg_data, -1);
 
 	return;
 }
@@ -222,24 +230,64 @@ void get_current_account_file_data(struct File_Data *file_data)
 	return;
 }
 
+int restore_account_file(const char *source_path, const struct Manifest_Entry *const entry, const char *save_path, char *target_path)
+{
+	// copy source, from blob store when listed in manifest
+	if ((entry != NULL) ? (check_blob_exists(entry->hash) < 0) : (!check_file_exists(source_path))) {
+		// never leave file of previous account behind
+		if (check_file_exists(target_path)) {
+			printf("\e[2mDeleting target %s...\e[22m\e[0K\n", target_path);
+			sceIoRemove(target_path);
+		}
+		printf("\e[1mMissing source %s...\e[22m\e[0K\n", save_path);
+		return -1;
+	}
+
+	// create target path directories
+	create_path(target_path, 0, 1);
+	// copy file
+	printf("\e[2mCopying %s...\e[22m\e[0K\n", save_path);
+	if (entry != NULL) {
+		// target is only replaced after restored content was verified
+		return restore_checked_blob(entry, target_path);
+	}
+
+	// plain copy of older versions, always remove target
+	if (check_file_exists(target_path)) {
+		printf("\e[2mDeleting target %s...\e[22m\e[0K\n", target_path);
+		sceIoRemove(target_path);
+	}
+
+	return copy_file(source_path, target_path, NULL);
+}
+
 void set_account_file_data(struct File_Data *file_data, char *username)
 {
 	int i;
 	int size_base_path;
 	char source_path[(MAX_PATH_LENGTH)+1];
 	char target_path[(MAX_PATH_LENGTH)+1];
+	char save_path[(MANIFEST_PATH_SIZE)+1];
+	struct Manifest_Data manifest;
+	struct Manifest_Entry *entry;
 
 	source_path[(MAX_PATH_LENGTH)] = '\0';
 	target_path[(MAX_PATH_LENGTH)] = '\0';
+	save_path[(MANIFEST_PATH_SIZE)] = '\0';
 
 	// build source base path
 	size_base_path = 0;
+	manifest.count = 0;
+	manifest.entries = NULL;
 	if (username != NULL) {
 		sceClibStrncpy(source_path, app_base_path, (MAX_PATH_LENGTH));
 		sceClibStrncat(source_path, accounts_folder, (MAX_PATH_LENGTH));
 		sceClibStrncat(source_path, username, (MAX_PATH_LENGTH));
 		sceClibStrncat(source_path, slash_folder, (MAX_PATH_LENGTH));
 		size_base_path = sceClibStrnlen(source_path, (MAX_PATH_LENGTH));
+
+		// load manifest of blob store
+		load_manifest(source_path, &manifest);
 	}
 
 	for (i = 0; i < file_data->file_count; i++) {
@@ -252,25 +300,14 @@ void set_account_file_data(struct File_Data *file_data, char *username)
 		sceClibStrncat(target_path, file_data->file_entries[i].file_name_path, (MAX_PATH_LENGTH));
 
 		if ((username != NULL) && (file_data->file_entries[i].file_available)) {
-			// build source path
+			// build save path
+			sceClibStrncpy(save_path, file_data->file_entries[i].file_save_path, (MANIFEST_PATH_SIZE));
+			sceClibStrncat(save_path, file_data->file_entries[i].file_name_path, (MANIFEST_PATH_SIZE));
+			// build source path, prefer blob store over plain copy
+			entry = find_manifest_entry(&manifest, save_path);
 			source_path[size_base_path] = '\0';
-			sceClibStrncat(source_path, file_data->file_entries[i].file_save_path, (MAX_PATH_LENGTH));
-			sceClibStrncat(source_path, file_data->file_entries[i].file_name_path, (MAX_PATH_LENGTH));
-			// always remove target
-			if (check_file_exists(target_path)) {
-				printf("\e[2mDeleting target %s...\e[22m\e[0K\n", target_path);
-				sceIoRemove(target_path);
-			}
-			// copy source
-			if (!check_file_exists(source_path)) {
-				printf("\e[1mMissing source %s...\e[22m\e[0K\n", &(source_path[size_base_path]));
-			} else {
-				// create target path directories
-				create_path(target_path, 0, 1);
-				// copy file
-				printf("\e[2mCopying %s...\e[22m\e[0K\n", &(source_path[size_base_path]));
-				copy_file(source_path, target_path);
-			}
+			sceClibStrncat(source_path, save_path, (MAX_PATH_LENGTH));
+			restore_account_file(source_path, entry, save_path, target_path);
 		} else {
 			if (!check_file_exists(target_path)) {
 				printf("\e[2mSkip deleting missing %s...\e[22m\e[0K\n", target_path);
@@ -281,6 +318,8 @@ void set_account_file_data(struct File_Data *file_data, char *username)
 		}
 	}
 
+	free_manifest(&manifest);
+
 	return;
 }
 
@@ -340,8 +379,8 @@ void display_account_details_short(struct Registry_Data *reg_data, int *no_user)
 	}
 	// username
 	printf("Current User Name: ");
-	if ((reg_data->idx_username >= 0) && (reg_data->reg_entries[reg_data->idx_username].key_value != NULL) && ((len = sceClibStrnlen((char *)(reg_data->reg_entries[reg_data->idx_username].key_value), reg_data->reg_entries[reg_data->idx_username].key_size)) > 0)) {
-		printf("%s\e[0K\n", (char *)(reg_data->reg_entries[reg_data->idx_username].key_value), len);
+	if ((reg_data->idx_username >= 0) && ((len = sceClibStrnlen((char *)(get_reg_value(reg_data, reg_data->idx_username)), reg_data->reg_entries[reg_data->idx_username].key_size)) > 0)) {
+		printf("%s\e[0K\n", (char *)(get_reg_value(reg_data, reg_data->idx_username)), len);
 	} else {
 		printf("<None>\e[0K\n");
 		if (no_user != NULL) {
@@ -350,8 +389,8 @@ void display_account_details_short(struct Registry_Data *reg_data, int *no_user)
 	}
 	// login id
 	printf("Current Login ID: ");
-	if ((reg_data->idx_login_id >= 0) && (reg_data->reg_entries[reg_data->idx_login_id].key_value != NULL) && ((len = sceClibStrnlen((char *)(reg_data->reg_entries[reg_data->idx_login_id].key_value), reg_data->reg_entries[reg_data->idx_login_id].key_size)) > 0)) {
-		printf("%s\e[0K\n", (char *)(reg_data->reg_entries[reg_data->idx_login_id].key_value), len);
+	if ((reg_data->idx_login_id >= 0) && ((len = sceClibStrnlen((char *)(get_reg_value(reg_data, reg_data->idx_login_id)), reg_data->reg_entries[reg_data->idx_login_id].key_size)) > 0)) {
+		printf("%s\e[0K\n", (char *)(get_reg_value(reg_data, reg_data->idx_login_id)), len);
 	} else {
 		printf("<None>\e[0K\n");
 		if (no_user != NULL) {
@@ -359,7 +398,7 @@ void display_account_details_short(struct Registry_Data *reg_data, int *no_user)
 		}
 	}
 
-	char* username = (char *)(reg_data->reg_entries[reg_data->idx_username].key_value);
+	char* username = (char *)(get_reg_value(reg_data, reg_data->idx_username));
 	char* user_combination = get_user_combination(username);
 	if (user_combination){
 		printf("Current Combination: %s\n", user_combination);
@@ -389,23 +428,25 @@ void display_account_details_full(struct Registry_Data *reg_data, struct File_Da
 
 		switch(reg_data->reg_entries[i].key_type) {
 			case KEY_TYPE_INT:
-				printf("%i\e[0K\n", *((int *)(reg_data->reg_entries[i].key_value)));
+				printf("%i\e[0K\n", *((int *)(get_reg_value(reg_data, i))));
 				break;
 			case KEY_TYPE_STR:
-				if ((reg_data->reg_entries[i].key_value != NULL) && ((len = sceClibStrnlen((char *)(reg_data->reg_entries[i].key_value), reg_data->reg_entries[i].key_size)) > 0)) {
-					printf("%s (%i)\e[0K\n", (char *)(reg_data->reg_entries[i].key_value), len);
+				if (((len = sceClibStrnlen((char *)(get_reg_value(reg_data, i)), reg_data->reg_entries[i].key_size)) > 0)) {
+					printf("%s (%i)\e[0K\n", (char *)(get_reg_value(reg_data, i)), len);
 				} else {
 					printf("<None>\e[0K\n");
 				}
 				break;
 			case KEY_TYPE_BIN:
 				for (j = 0; j < reg_data->reg_entries[i].key_size; j++) {
-					printf("%02x", ((unsigned char *)(reg_data->reg_entries[i].key_value))[j]);
+					printf("%02x", ((unsigned char *)(get_reg_value(reg_data, i)))[j]);
 				}
 				printf(" (%i)\e[0K\n", reg_data->reg_entries[i].key_size);
 				break;
 		}
 	}
+	printf("\e[2mRegistry cache: %i hits, %i misses (%i%%), %i writes.\e[22m\e[0K\n", reg_cache_stats.hits, reg_cache_stats.misses, get_reg_cache_hit_rate(), reg_cache_stats.writes);
+	printf("\e[2mBuffer pool: %i of %i blocks peak, %i borrowed, %i fallbacks.\e[22m\e[0K\n", buffer_pool_stats.high_water, (BUFFER_POOL_BLOCKS), buffer_pool_stats.borrowed, buffer_pool_stats.fallbacks);
 
 	// file data
 	printf("File Data:\e[0K\n");
@@ -430,13 +471,79 @@ void display_account_details_full(struct Registry_Data *reg_data, struct File_Da
 	return;
 }
 
+// data of save steps run on worker thread
+struct Save_Context {
+	struct File_Data *file_data;
+	struct Blob_Store *blob_store;
+	struct Manifest_Data *manifest;
+	char *target_path;
+	int size_base_path;
+};
+
+static int save_account_file_step(void *context, int index)
+{
+	struct Save_Context *save_context;
+	struct File_Entry *file_entry;
+	int result;
+	int size;
+	unsigned long long hash;
+	unsigned int checksum;
+	char source_path[(MAX_PATH_LENGTH)+1];
+	char save_path[(MANIFEST_PATH_SIZE)+1];
+
+	save_context = (struct Save_Context *)context;
+	file_entry = &(save_context->file_data->file_entries[index]);
+	if ((file_entry->file_save_path == NULL) || (file_entry->file_name_path == NULL) || (file_entry->file_path == NULL)) {
+		return 0;
+	}
+
+	// build source path
+	source_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(source_path, file_entry->file_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(source_path, file_entry->file_name_path, (MAX_PATH_LENGTH));
+
+	if (!file_entry->file_available) {
+		printf("\e[2mSkip missing %s...\e[22m\e[0K\n", source_path);
+		return 0;
+	}
+
+	// build save path
+	save_path[(MANIFEST_PATH_SIZE)] = '\0';
+	sceClibStrncpy(save_path, file_entry->file_save_path, (MANIFEST_PATH_SIZE));
+	sceClibStrncat(save_path, file_entry->file_name_path, (MANIFEST_PATH_SIZE));
+
+	// store file, only new content is written
+	result = store_blob(save_context->blob_store, source_path, &hash, &size, &checksum);
+	if (result < 0) {
+		printf("\e[1mFailed to store %s (0x%08x)...\e[22m\e[0K\n", source_path, result);
+		return result;
+	} else if (result > 0) {
+		printf("\e[2mStored %s...\e[22m\e[0K\n", source_path);
+	} else {
+		printf("\e[2mAlready stored %s...\e[22m\e[0K\n", source_path);
+	}
+	set_manifest_entry(save_context->blob_store, save_context->manifest, save_path, hash, size, checksum);
+
+	// remove plain copy of older versions
+	save_context->target_path[save_context->size_base_path] = '\0';
+	sceClibStrncat(save_context->target_path, save_path, (MAX_PATH_LENGTH));
+	if (check_file_exists(save_context->target_path)) {
+		printf("\e[2mDeleting plain copy %s...\e[22m\e[0K\n", save_path);
+		sceIoRemove(save_context->target_path);
+	}
+
+	return 0;
+}
+
 void save_account_details(struct Registry_Data *reg_data, struct File_Data *file_data, char *title)
 {
-	int i;
 	int size_base_path;
 	char base_path[(MAX_PATH_LENGTH)+1];
 	char target_path[(MAX_PATH_LENGTH)+1];
-	char source_path[(MAX_PATH_LENGTH)+1];
+	struct Blob_Store blob_store;
+	struct Manifest_Data manifest;
+	struct Save_Context context;
+	struct Worker_Job job;
 
 	// draw title line
 	draw_title_line(title);
@@ -445,86 +552,88 @@ void save_account_details(struct Registry_Data *reg_data, struct File_Data *file
 	draw_pixel_line(NULL, NULL);
 
 	// check username and login id
-	if ((reg_data->idx_username < 0) || (reg_data->reg_entries[reg_data->idx_username].key_value == NULL) || (sceClibStrnlen((char *)(reg_data->reg_entries[reg_data->idx_username].key_value), 1) == 0)  // check username
-	    || (reg_data->idx_login_id < 0) || (reg_data->reg_entries[reg_data->idx_login_id].key_value == NULL) || (sceClibStrnlen((char *)(reg_data->reg_entries[reg_data->idx_login_id].key_value), 1) == 0))  // check login id
+	if ((reg_data->idx_username < 0) || (sceClibStrnlen((char *)(get_reg_value(reg_data, reg_data->idx_username)), 1) == 0)  // check username
+	    || (reg_data->idx_login_id < 0) || (sceClibStrnlen((char *)(get_reg_value(reg_data, reg_data->idx_login_id)), 1) == 0))  // check login id
 	{
 		printf("\e[1mThere is no linked account.\e[22m\e[0K\n");
 		sceKernelDelayThread(1500000);  // 1.5s
 		return;
 	}
 
-	source_path[(MAX_PATH_LENGTH)] = '\0';
-
 	// build target base path
 	base_path[(MAX_PATH_LENGTH)] = '\0';
 	sceClibStrncpy(base_path, app_base_path, (MAX_PATH_LENGTH));
 	sceClibStrncat(base_path, accounts_folder, (MAX_PATH_LENGTH));
-	sceClibStrncat(base_path, (char *)(reg_data->reg_entries[reg_data->idx_username].key_value), (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, (char *)(get_reg_value(reg_data, reg_data->idx_username)), (MAX_PATH_LENGTH));
 	sceClibStrncat(base_path, slash_folder, (MAX_PATH_LENGTH));
 	printf("Saving account details to %s...\e[0K\n", base_path);
 
 	// save account registry data
-	save_reg_data(base_path, reg_data);
+	save_reg_data(base_path, reg_data, 1);
 
-	// save account file data
+	// save account file data into blob store
 	size_base_path = sceClibStrnlen(base_path, (MAX_PATH_LENGTH));
 	sceClibStrncpy(target_path, base_path, (MAX_PATH_LENGTH));
 	target_path[size_base_path] = '\0';
 	target_path[(MAX_PATH_LENGTH)] = '\0';
 	create_path(target_path, 0, 0);
-	for (i = 0; i < file_data->file_count; i++) {
-		if ((file_data->file_entries[i].file_save_path == NULL) || (file_data->file_entries[i].file_name_path == NULL) || (file_data->file_entries[i].file_path == NULL)) {
-			continue;
-		}
-
-		// build source path
-		sceClibStrncpy(source_path, file_data->file_entries[i].file_path, (MAX_PATH_LENGTH));
-		sceClibStrncat(source_path, file_data->file_entries[i].file_name_path, (MAX_PATH_LENGTH));
-
-		if (!file_data->file_entries[i].file_available) {
-			printf("\e[2mSkip missing %s...\e[22m\e[0K\n", source_path);
-			continue;
-		}
-
-		// build target path
-		target_path[size_base_path] = '\0';
-		sceClibStrncat(target_path, file_data->file_entries[i].file_save_path, (MAX_PATH_LENGTH));
-		sceClibStrncat(target_path, file_data->file_entries[i].file_name_path, (MAX_PATH_LENGTH));
-
-		// create target path directories
-		create_path(target_path, size_base_path, 0);
+	open_blob_store(&blob_store);
+	load_manifest(base_path, &manifest);
+
+	// store each file on worker thread
+	context.file_data = file_data;
+	context.blob_store = &blob_store;
+	context.manifest = &manifest;
+	context.target_path = target_path;
+	context.size_base_path = size_base_path;
+	job.count = file_data->file_count;
+	job.total_bytes = 0;
+	job.context = (void *)&context;
+	job.run_step = save_account_file_step;
+	job.commit_step = job.count;
+	run_worker_job(&job);
+	if (job.cancelled > 0) {
+		printf("\e[1mSaving cancelled, %i files not stored!\e[22m\e[0K\n", job.cancelled);
+	}
 
-		// copy file
-		printf("\e[2mCopying %s...\e[22m\e[0K\n", source_path);
-		copy_file(source_path, target_path);
+	// keep link of each inserted memory card to this account, but only for a complete save
+	if (job.cancelled == 0) {
+		save_card_links(&blob_store, &manifest);
 	}
+	save_manifest(base_path, &manifest);
+	free_manifest(&manifest);
+	close_blob_store(&blob_store);
 
-	printf("Account %s saved!\e[0K\n", (char *)(reg_data->reg_entries[reg_data->idx_username].key_value));
+	printf("Account %s saved!\e[0K\n", (char *)(get_reg_value(reg_data, reg_data->idx_username)));
 	wait_for_cancel_button();
 
 	return;
 }
 
-void read_account_details(struct Registry_Data *reg_data, struct File_Data *file_data, struct Registry_Data *reg_init_data, struct File_Data *file_init_data)
+void read_account_details(struct Registry_Data *reg_data, struct File_Data *file_data, struct Registry_Data *reg_init_data, struct File_Data *file_init_data, int display)
 {
 	int i;
 	int size_base_path;
 	char base_path[(MAX_PATH_LENGTH)+1];
 	char source_path[(MAX_PATH_LENGTH)+1];
+	struct Manifest_Data manifest;
 
 	// build source base path
 	base_path[(MAX_PATH_LENGTH)] = '\0';
 	sceClibStrncpy(base_path, app_base_path, (MAX_PATH_LENGTH));
 	sceClibStrncat(base_path, accounts_folder, (MAX_PATH_LENGTH));
-	sceClibStrncat(base_path, (char *)(reg_data->reg_entries[reg_data->idx_username].key_value), (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, (char *)(get_reg_value(reg_data, reg_data->idx_username)), (MAX_PATH_LENGTH));
 	sceClibStrncat(base_path, slash_folder, (MAX_PATH_LENGTH));
 	size_base_path = sceClibStrnlen(base_path, (MAX_PATH_LENGTH));
-	printf("Reading account details from %s...\e[0K\n", base_path);
+	if (display) {
+		printf("Reading account details from %s...\e[0K\n", base_path);
+	}
 
 	// load account registry data
-	load_reg_data(base_path, reg_data, reg_init_data, reg_id_username, -1);
+	load_reg_data(base_path, reg_data, reg_init_data, (REG_ID_USERNAME), -1, display);
 
-	// load account file data
+	// load account file data, either from blob store or plain copy
+	load_manifest(base_path, &manifest);
 	sceClibStrncpy(source_path, base_path, (MAX_PATH_LENGTH));
 	source_path[size_base_path] = '\0';
 	source_path[(MAX_PATH_LENGTH)] = '\0';
@@ -538,33 +647,199 @@ void read_account_details(struct Registry_Data *reg_data, struct File_Data *file
 		source_path[size_base_path] = '\0';
 		sceClibStrncat(source_path, file_data->file_entries[i].file_save_path, (MAX_PATH_LENGTH));
 		sceClibStrncat(source_path, file_data->file_entries[i].file_name_path, (MAX_PATH_LENGTH));
-		file_data->file_entries[i].file_available = check_file_exists(source_path);
+		if (find_manifest_entry(&manifest, &(source_path[size_base_path])) != NULL) {
+			file_data->file_entries[i].file_available = 1;
+		} else {
+			file_data->file_entries[i].file_available = check_file_exists(source_path);
+		}
 	}
+	free_manifest(&manifest);
 }
 
-int switch_account(struct Registry_Data *reg_data, struct Registry_Data *reg_init_data, struct File_Data *file_init_data, char *title)
+// sorted account list shown by switch menu, row 0 is cancel
+struct Account_List {
+	struct Dir_Filter filter;
+	int name_size;
+	struct Registry_Data *reg_data;
+	struct Registry_Data *reg_init_data;
+	struct File_Data *file_init_data;
+	int result;
+};
+
+static void draw_account_row(void *context, int index)
+{
+	struct Account_List *list;
+	struct Dir_Entry *dir;
+	int size;
+	char *user_combination;
+
+	list = (struct Account_List *)context;
+	if (index == 0) {
+		printf("Cancel.");
+		return;
+	}
+
+	dir = &(list->filter.dirs[list->filter.first + index - 1]);
+	size = (dir->size > (list->name_size - 1));
+	if (size) {
+		printf("\e[2m");
+	}
+	printf("%.*s", list->name_size, dir->name);
+	if (size) {
+		printf("... (name too long)\e[22m");
+	}
+
+	user_combination = get_user_combination(dir->name);
+	if (user_combination) {
+		printf("| %s", user_combination);
+		free(user_combination);
+	}
+
+	return;
+}
+
+static void draw_switch_info(struct Menu *menu)
+{
+	struct Account_List *list;
+
+	list = (struct Account_List *)menu->context;
+
+	// draw current account data
+	display_account_details_short(list->reg_data, NULL);
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
+
+	// draw info
+	printf("Switch to another account by changing account data\e[0K\n");
+	printf("in registry and replacing account files.\e[0K\n");
+	if (list->filter.size_prefix > 0) {
+		printf("\e[2K\n%i of %i accounts start with \"%s\": (L/R to page)\e[0K\n", list->filter.count, list->filter.dir_count, list->filter.prefix);
+	} else {
+		printf("\e[2K\nThe following %i accounts are available: (L/R to page)\e[0K\n", list->filter.dir_count);
+	}
+	printf("\e[2mLeft/right jump by letter, square/triangle filter +/-\e[22m\e[0K\n");
+
+	return;
+}
+
+static int handle_switch_key(struct Menu *menu, int button_pressed)
+{
+	return handle_dir_filter_key(menu, &(((struct Account_List *)menu->context)->filter), 1, button_pressed);
+}
+
+static void prefetch_account_row(struct Menu *menu, int index)
 {
+	struct Account_List *list;
+	struct Dir_Entry *dir;
+
+	// load highlighted account in background
+	list = (struct Account_List *)menu->context;
+	if (index > 0) {
+		dir = &(list->filter.dirs[list->filter.first + index - 1]);
+		if (dir->size <= (list->name_size - 1)) {
+			request_prefetch(dir->name);
+		}
+	}
+
+	return;
+}
+
+int switch_to_account(struct Registry_Data *reg_data, struct Registry_Data *reg_init_data, struct File_Data *file_init_data, const char *username)
+{
+	struct Registry_Data *reg_new_data;
+	struct File_Data file_new_data;
+	struct Switch_Plan plan;
+	SceUInt64 time_start;
 	int result;
-	int menu_redraw_screen;
-	int menu_redraw;
-	int menu_run;
-	int menu_items;
-	int menu_item;
-	int x, y;
-	int x2, y2;
-	int x3, y3;
-	int button_pressed;
-	int i;
+
+	if ((username == NULL) || (sceClibStrnlen(username, reg_init_data->reg_entries[reg_init_data->idx_username].key_size) > (reg_init_data->reg_entries[reg_init_data->idx_username].key_size - 1))) {
+		return 0;
+	}
+
+	// use prefetched data of account to be switched to
+	reg_new_data = NULL;
+	if (take_prefetched(username, &reg_new_data, &file_new_data)) {
+		printf("Using prefetched account details of %s...\e[0K\n", username);
+	} else {
+		// initialize data for account to be switched to
+		init_account_reg_data(&reg_new_data);
+		init_account_file_data(&file_new_data);
+		// copy username
+		sceClibStrncpy((char *)(get_reg_value(reg_new_data, reg_new_data->idx_username)), username, (reg_new_data->reg_entries[reg_new_data->idx_username].key_size - 1));
+		// read account data
+		read_account_details(reg_new_data, &file_new_data, reg_init_data, file_init_data, 1);
+	}
+	// check for sufficient account data (login_id)
+	if ((reg_new_data->idx_login_id < 0) || (sceClibStrnlen((char *)(get_reg_value(reg_new_data, reg_new_data->idx_login_id)), 1) == 0))  // check login id
+	{
+		printf("\e[1mAccount %s data is insufficient (at least login id is needed).\e[22m\e[0K\n", (char *)(get_reg_value(reg_new_data, reg_new_data->idx_username)));
+		result = 0;
+	} else {
+		// registry may have changed while the app was suspended, only diff against live values
+		refresh_reg_cache();
+		get_current_account_reg_data(reg_data);
+		// only run steps that change something, all steps without fast switch
+		time_start = sceKernelGetProcessTimeWide();
+		if (build_switch_plan(&plan, reg_data, reg_new_data, &file_new_data, !app_settings.fast_switch) < 0) {
+			printf("\e[1mNot enough memory to plan account switch!\e[22m\e[0K\n");
+			result = 0;
+		} else {
+			printf("Planned %i of %i steps.\e[0K\n", plan.count, plan.total);
+			execute_switch_plan(&plan, reg_data, reg_new_data, &file_new_data);
+			// cancel is only accepted before anything live got changed
+			if (plan.cancelled > 0) {
+				printf("\e[1mSwitch cancelled, %i steps skipped, account not switched.\e[22m\e[0K\n", plan.cancelled);
+				result = 0;
+			} else {
+				printf("Account %s restored, %i of %i steps done in %u ms!\e[0K\n", (char *)(get_reg_value(reg_new_data, reg_new_data->idx_username)), plan.done, plan.count, (unsigned int)((sceKernelGetProcessTimeWide() - time_start) / 1000));
+				result = 1;
+			}
+		}
+		free_switch_plan(&plan);
+	}
+	free_reg_data(reg_new_data);
+	free(reg_new_data);
+	free(file_new_data.file_entries);
+
+	return result;
+}
+
+static int select_switch_row(struct Menu *menu, int index)
+{
+	struct Account_List *list;
+	struct Dir_Entry *dir;
+
+	if (index == 0) {  // cancel
+		return (MENU_EXIT);
+	}
+
+	// switch account
+	list = (struct Account_List *)menu->context;
+	dir = &(list->filter.dirs[list->filter.first + index - 1]);
+	if (dir->size > (list->name_size - 1)) {
+		return (MENU_STAY);
+	}
+
+	// clear data part of screen
+	clear_menu_data(menu);
+	list->result = switch_to_account(list->reg_data, list->reg_init_data, list->file_init_data, dir->name);
+	wait_for_cancel_button();
+	if (!list->result) {
+		return (MENU_REDRAW);
+	}
+
+	return (MENU_EXIT);
+}
+
+int switch_account(struct Registry_Data *reg_data, struct Registry_Data *reg_init_data, struct File_Data *file_init_data, char *title)
+{
 	int size_base_path;
 	char base_path[(MAX_PATH_LENGTH)+1];
 	struct Dir_Entry *dirs;
 	int dir_count;
-	int dir_count2;
-	int entries_per_screen;
-	int size;
-	int count;
-
-	result = 0;
+	struct Account_List account_list;
+	struct Menu menu;
 
 	// build source base path
 	base_path[(MAX_PATH_LENGTH)] = '\0';
@@ -577,176 +852,29 @@ int switch_account(struct Registry_Data *reg_data, struct Registry_Data *reg_ini
 	dirs = NULL;
 	dir_count = get_subdirs(base_path, &dirs);
 	base_path[size_base_path - 1] = '/';
+	sort_subdirs(dirs, dir_count);
 
-	// run switch menu
-	menu_redraw_screen = 1;
-	menu_redraw = 1;
-	menu_run = 1;
-	menu_items = 0;
-	menu_item = 0;
-	dir_count2 = 0;
-	count = dir_count2;
-	do {
-		// redraw screen
-		if (menu_redraw_screen) {
-			// draw title line
-			draw_title_line(title);
-
-			// draw pixel line
-			draw_pixel_line(NULL, NULL);
-			psvDebugScreenGetCoordsXY(NULL, &y3);  // start of data
-			x3 = 0;
-
-			// draw current account data
-			display_account_details_short(reg_data, NULL);
-
-			// draw pixel line
-			draw_pixel_line(NULL, NULL);
-
-			// draw info
-			printf("Switch to another account by changing account data\e[0K\n");
-			printf("in registry and replacing account files.\e[0K\n");
-			printf("\e[2K\nThe following %i accounts are available: (L/R to page)\e[0K\n", dir_count);
-
-			// draw first part of menu
-			psvDebugScreenGetCoordsXY(NULL, &y);  // start of menu
-			x = 0;
-			printf(" Cancel.\e[0K\n");
-			psvDebugScreenGetCoordsXY(NULL, &y2);  // start of account list
-			x2 = 0;
-
-			entries_per_screen = ((SCREEN_HEIGHT) - y2 + 1) / psv_font_current->size_h;
-
-			menu_redraw = 1;
-			menu_redraw_screen = 0;
-		}
-
-		// redraw account list
-		if (menu_redraw) {
-			psvDebugScreenSetCoordsXY(&x2, &y2);
-			printf("\e[0J");
-
-			count = dir_count2;
-			menu_items = 0;
-			for (i = 0; (i < entries_per_screen) && (count < dir_count); i++, count++) {
-				menu_items++;
-				size = (dirs[count].size > (reg_init_data->reg_entries[reg_init_data->idx_username].key_size - 1));
-				if (size) {
-					printf("\e[2m");
-				}
-				printf(" %.*s", reg_init_data->reg_entries[reg_init_data->idx_username].key_size, dirs[count].name);
-				if (size) {
-					printf("... (name too long)\e[22m");
-				}
-
-				char* username = (char*)dirs[count].name;
-				char* user_combination = get_user_combination(username);
-				if (user_combination){
-					printf("| %s", user_combination);
-					free(user_combination);
-				}
-
-				printf("\e[0K\n");
-			}
+	// load highlighted account in background
+	start_prefetch(reg_init_data, file_init_data);
 
-			menu_redraw = 0;
-		}
-
-		// draw menu marker
-		psvDebugScreenSetCoordsXY(&x, &y);
-		//
-		if (menu_item < 0) {
-			menu_item = 0;
-		}
-		if (menu_item > menu_items) {
-			menu_item = menu_items;
-		}
-		//
-		for (i = 0; i <= menu_items; i++) {
-			if (menu_item == i) {
-				printf(">\n");
-			} else {
-				printf(" \n");
-			}
-		}
-
-		// process key strokes
-		button_pressed = get_key();
-		if (button_pressed == SCE_CTRL_DOWN) {
-			menu_item++;
-		} else if (button_pressed == SCE_CTRL_UP) {
-			menu_item--;
-		} else if (button_pressed == SCE_CTRL_RTRIGGER) {
-			if (count < dir_count) {
-				dir_count2 += entries_per_screen;
-				if (dir_count2 >= dir_count) {
-					dir_count2 = dir_count - 1;
-				}
-				menu_redraw = 1;
-			}
-		} else if (button_pressed == SCE_CTRL_LTRIGGER) {
-			if (dir_count2 > 0) {
-				dir_count2 -= entries_per_screen;
-				if (dir_count2 < 0) {
-					dir_count2 = 0;
-				}
-				menu_redraw = 1;
-			}
-		} else if (button_pressed == button_enter) {
-			if (menu_item == 0) {  // cancel
-				menu_run = 0;
-			} else if (menu_item > 0) {  // switch account
-				i = dir_count2 + menu_item - 1;
-				size = (dirs[i].size > (reg_init_data->reg_entries[reg_init_data->idx_username].key_size - 1));
-				if (!size) {
-					struct Registry_Data *reg_new_data;
-					struct File_Data file_new_data;
-
-					// clear data part of screen
-					psvDebugScreenSetCoordsXY(&x3, &y3);
-					printf("\e[0J");
-					// initialize data for account to be switched to
-					reg_new_data = NULL;
-					init_account_reg_data(&reg_new_data);
-					init_account_file_data(&file_new_data);
-					// copy username
-					sceClibStrncpy((char *)(reg_new_data->reg_entries[reg_new_data->idx_username].key_value), dirs[i].name, (reg_new_data->reg_entries[reg_new_data->idx_username].key_size - 1));
-					// read account data
-					read_account_details(reg_new_data, &file_new_data, reg_init_data, file_init_data);
-					// check for sufficient account data (login_id)
-					if ((reg_new_data->idx_login_id < 0) || (reg_new_data->reg_entries[reg_new_data->idx_login_id].key_value == NULL) || (sceClibStrnlen((char *)(reg_new_data->reg_entries[reg_new_data->idx_login_id].key_value), 1) == 0))  // check login id
-					{
-						printf("\e[1mAccount %s data is insufficient (at least login id is needed).\e[22m\e[0K\n", (char *)(reg_new_data->reg_entries[reg_new_data->idx_username].key_value));
-						wait_for_cancel_button();
-						menu_redraw_screen = 1;
-						menu_redraw = 1;
-					} else {
-						// set account registry data
-						set_reg_data(reg_new_data, -1);
-						// copy/remove account file data
-						set_account_file_data(&file_new_data, reg_new_data->reg_entries[reg_new_data->idx_username].key_value);
-						// delete execution history data
-						delete_execution_history(&execution_history_data, NULL);
-						
-						printf("Account %s restored!\e[0K\n", (char *)(reg_new_data->reg_entries[reg_new_data->idx_username].key_value));
-						if (switch_saves_folder("ux0:user", (char*)(reg_data->reg_entries[reg_data->idx_username].key_value), (char*)(reg_new_data->reg_entries[reg_new_data->idx_username].key_value)))
-							printf("Saves folder swapped!\n");
-						else printf("Saves folder didn't swap!\n");
-						wait_for_cancel_button();
-						menu_run = 0;
-						result = 1;
-					}
-					free_reg_data(reg_new_data);
-					free(reg_new_data);
-				}
-			}
-		}
-	} while (menu_run);
+	// run switch menu
+	init_dir_filter(&(account_list.filter), dirs, dir_count);
+	account_list.name_size = reg_init_data->reg_entries[reg_init_data->idx_username].key_size;
+	account_list.reg_data = reg_data;
+	account_list.reg_init_data = reg_init_data;
+	account_list.file_init_data = file_init_data;
+	account_list.result = 0;
+	init_menu(&menu, title, dir_count + 1, draw_account_row, select_switch_row, &account_list);
+	menu.draw_info = draw_switch_info;
+	menu.highlight_row = prefetch_account_row;
+	menu.handle_key = handle_switch_key;
+	run_menu(&menu);
 
 	// free memory
+	stop_prefetch();
 	free_subdirs(dirs, dir_count);
 
-	return result;
+	return account_list.result;
 }
 
 int switch_saves_folder(const char* base_path, const char* current_user, const char* new_user) {
@@ -771,29 +899,33 @@ int switch_saves_folder(const char* base_path, const char* current_user, const c
 	return 1;
 }
 
-int remove_account(struct Registry_Data *reg_data, struct Registry_Data *reg_init_data, struct File_Data *file_init_data, char *title)
-{
+// state of remove menu
+struct Remove_Data {
+	struct Registry_Data *reg_data;
+	struct Registry_Data *reg_init_data;
+	struct File_Data *file_init_data;
 	int result;
-	int menu_run;
-	int menu_items;
-	int menu_item;
-	int x, y;
-	int x3, y3;
-	int button_pressed;
-	int i;
+};
 
-	result = 0;
+static void draw_remove_row(void *context, int index)
+{
+	if (index == 0) {
+		printf("Cancel.");
+	} else {
+		printf("Remove account.");
+	}
 
-	// draw title line
-	draw_title_line(title);
+	return;
+}
 
-	// draw pixel line
-	draw_pixel_line(NULL, NULL);
-	psvDebugScreenGetCoordsXY(NULL, &y3);  // start of data
-	x3 = 0;
+static void draw_remove_info(struct Menu *menu)
+{
+	struct Remove_Data *remove_data;
+
+	remove_data = (struct Remove_Data *)menu->context;
 
 	// draw current account data
-	display_account_details_short(reg_data, NULL);
+	display_account_details_short(remove_data->reg_data, NULL);
 
 	// draw pixel line
 	draw_pixel_line(NULL, NULL);
@@ -803,67 +935,64 @@ int remove_account(struct Registry_Data *reg_data, struct Registry_Data *reg_ini
 	printf("in registry and deleting account files.\e[0K\n");
 	printf("\e[2K\nContinue?\e[0K\n");
 
-	// draw menu
-	psvDebugScreenGetCoordsXY(NULL, &y);
-	x = 0;
-	menu_run = 1;
-	menu_items = 0;
-	menu_item = 0;
-	printf(" Cancel.\e[0K\n"); menu_items++;
-	printf(" Remove account.\e[0K\n");
-
-	do {
-		// draw menu marker
-		psvDebugScreenSetCoordsXY(&x, &y);
-		//
-		if (menu_item < 0) {
-			menu_item = 0;
-		}
-		if (menu_item > menu_items) {
-			menu_item = menu_items;
-		}
-		//
-		for (i = 0; i <= menu_items; i++) {
-			if (menu_item == i) {
-				printf(">\n");
-			} else {
-				printf(" \n");
-			}
-		}
+	return;
+}
 
-		// process key strokes
-		button_pressed = get_key();
-		if (button_pressed == SCE_CTRL_DOWN) {
-			menu_item++;
-		} else if (button_pressed == SCE_CTRL_UP) {
-			menu_item--;
-		} else if (button_pressed == button_enter) {
-			if (menu_item == 0) {  // cancel
-				menu_run = 0;
-			} else if (menu_item == 1) {  // remove account
-				// clear data part of screen
-				psvDebugScreenSetCoordsXY(&x3, &y3);
-				printf("\e[0J");
-				// set initial account data
-				set_reg_data(reg_init_data, -1);
-				set_account_file_data(file_init_data, NULL);
-				// delete execution history data
-				delete_execution_history(&execution_history_data, NULL);
-				//
-				printf("Account %s removed!\e[0K\n", (char *)(reg_data->reg_entries[reg_data->idx_username].key_value));
-				wait_for_cancel_button();
-				menu_run = 0;
-				result = 1;
-			}
-		}
-	} while (menu_run);
+static int select_remove_row(struct Menu *menu, int index)
+{
+	struct Remove_Data *remove_data;
+	struct Registry_Data *reg_data;
+	struct Registry_Diff reg_diff;
 
-	return result;
+	if (index == 0) {  // cancel
+		return (MENU_EXIT);
+	}
+
+	// remove account
+	remove_data = (struct Remove_Data *)menu->context;
+	reg_data = remove_data->reg_data;
+	// clear data part of screen
+	clear_menu_data(menu);
+	// registry may have changed while the app was suspended, only diff against live values
+	refresh_reg_cache();
+	get_current_account_reg_data(reg_data);
+	// keep image of complete registry and current account registry data, then set changed initial account data
+	snapshot_full_registry();
+	clear_reg_section_snapshots();
+	save_reg_data_snapshot(account_snapshot_name, reg_data);
+	diff_reg_data(reg_data, remove_data->reg_init_data, &reg_diff);
+	set_reg_data_diff(remove_data->reg_init_data, -1, &reg_diff);
+	free_reg_diff(&reg_diff);
+	set_account_file_data(remove_data->file_init_data, NULL);
+	// delete execution history data
+	delete_execution_history(&execution_history_data, NULL);
+	//
+	printf("Account %s removed!\e[0K\n", (char *)(get_reg_value(reg_data, reg_data->idx_username)));
+	wait_for_cancel_button();
+	remove_data->result = 1;
+
+	return (MENU_EXIT);
+}
+
+int remove_account(struct Registry_Data *reg_data, struct Registry_Data *reg_init_data, struct File_Data *file_init_data, char *title)
+{
+	struct Remove_Data remove_data;
+	struct Menu menu;
+
+	// run remove menu
+	remove_data.reg_data = reg_data;
+	remove_data.reg_init_data = reg_init_data;
+	remove_data.file_init_data = file_init_data;
+	remove_data.result = 0;
+	init_menu(&menu, title, 2, draw_remove_row, select_remove_row, &remove_data);
+	menu.draw_info = draw_remove_info;
+	run_menu(&menu);
+
+	return remove_data.result;
 }
 
 void main_account(void)
 {
-	int i;
 	char base_path[(MAX_PATH_LENGTH)+1];
 
 	// create accounts base path
@@ -872,19 +1001,5 @@ void main_account(void)
 	sceClibStrncat(base_path, accounts_folder, (MAX_PATH_LENGTH));
 	create_path(base_path, 0, 0);
 
-	// determine special indexes of registry data
-	for (i = 0; i < template_account_reg_data.reg_count; i++) {
-		// username
-		if ((template_account_reg_data.idx_username < 0) && (template_account_reg_data.reg_entries[i].key_id == reg_id_username)) {
-			template_account_reg_data.idx_username = i;
-		}
-		// login id
-		if ((template_account_reg_data.idx_login_id < 0) && (template_account_reg_data.reg_entries[i].key_id == reg_id_login_id)) {
-			template_account_reg_data.idx_login_id = i;
-		}
-		// all found?
-		if ((template_account_reg_data.idx_username >= 0) && (template_account_reg_data.idx_login_id >= 0)) {
-			break;
-		}
-	}
+	return;
 }
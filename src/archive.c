@@ -0,0 +1,832 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>  // for malloc(), realloc(), free()
+#include <vitasdk.h>
+
+#include <account.h>
+#include <archive.h>
+#include <blob.h>
+#include <bufpool.h>
+#include <common.h>
+#include <dir.h>
+#include <file.h>
+#include <main.h>
+#include <menu.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+const char *const archive_file = "accounts.vama";
+const char *const archive_magic = "VAMA";
+const char *const archive_temp_file = "archive.tmp";
+const char *const combinations_file = "combinations.conf";
+
+struct Archive_Writer {
+	SceUID fd;
+	unsigned int offset;
+	int count;
+	int toc_size;
+	int toc_capacity;
+	unsigned char *toc;
+	void *buffer;
+};
+
+
+static void build_app_path(char *path, const char *const name)
+{
+	path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, name, (MAX_PATH_LENGTH));
+
+	return;
+}
+
+// archive paths are relative to the accounts folder and must stay inside it
+static int check_path_component(const char *name, int size)
+{
+	int i;
+
+	if ((size == 0) || ((size == 1) && (name[0] == '.')) || ((size == 2) && (name[0] == '.') && (name[1] == '.'))) {
+		return 0;
+	}
+	for (i = 0; i < size; i++) {
+		if ((name[i] == ':') || (name[i] == '/') || (name[i] == '\\') || (name[i] == '\0')) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static int check_entry_path(const char *path)
+{
+	const char *start;
+	const char *end;
+
+	start = path;
+	while (1) {
+		end = sceClibStrchr(start, '/');
+		if (end == NULL) {
+			return check_path_component(start, sceClibStrnlen(start, (MAX_PATH_LENGTH)));
+		}
+		if (!check_path_component(start, end - start)) {  // also rejects leading slash
+			return 0;
+		}
+		start = end + 1;
+	}
+}
+
+static int add_toc_entry(struct Archive_Writer *writer, unsigned int offset, unsigned int size, int type, const char *path)
+{
+	struct Archive_Toc_Entry toc_entry;
+	unsigned char *toc;
+	int path_size;
+	int needed;
+
+	path_size = sceClibStrnlen(path, (MAX_PATH_LENGTH));
+	needed = writer->toc_size + sizeof(struct Archive_Toc_Entry) + path_size;
+	if (needed > writer->toc_capacity) {
+		toc = (unsigned char *)realloc(writer->toc, max(needed, writer->toc_capacity * 2));
+		if (toc == NULL) {
+			return -1;
+		}
+		writer->toc = toc;
+		writer->toc_capacity = max(needed, writer->toc_capacity * 2);
+	}
+
+	toc_entry.offset = offset;
+	toc_entry.size = size;
+	toc_entry.type = (unsigned short)type;
+	toc_entry.path_size = (unsigned short)path_size;
+	sceClibMemcpy(&(writer->toc[writer->toc_size]), &toc_entry, sizeof(struct Archive_Toc_Entry));
+	sceClibMemcpy(&(writer->toc[writer->toc_size + sizeof(struct Archive_Toc_Entry)]), path, path_size);
+	writer->toc_size = needed;
+	writer->count++;
+
+	return 0;
+}
+
+static int append_file(struct Archive_Writer *writer, const char *source_path, int type, const char *path)
+{
+	SceUID fdsrc;
+	unsigned int offset;
+	int read;
+	int written;
+
+	fdsrc = sceIoOpen(source_path, SCE_O_RDONLY, 0);
+	if (fdsrc < 0) {
+		return fdsrc;
+	}
+
+	// stream file into archive
+	offset = writer->offset;
+	while ((read = sceIoRead(fdsrc, writer->buffer, (TRANSFER_SIZE))) > 0) {
+		written = sceIoWrite(writer->fd, writer->buffer, read);
+		if (written != read) {
+			read = -1;
+			break;
+		}
+		writer->offset += written;
+	}
+	sceIoClose(fdsrc);
+	if (read < 0) {
+		return -1;
+	}
+
+	return add_toc_entry(writer, offset, writer->offset - offset, type, path);
+}
+
+static int append_folder(struct Archive_Writer *writer, char *source_path, int size_accounts_path, int depth, int display)
+{
+	SceUID dfd;
+	SceIoDirent entry;
+	int size_path;
+	int count;
+	int result;
+
+	dfd = sceIoDopen(source_path);
+	if (dfd < 0) {
+		return dfd;
+	}
+
+	size_path = sceClibStrnlen(source_path, (MAX_PATH_LENGTH));
+	count = 0;
+	sceClibMemset(&entry, 0, sizeof(SceIoDirent));
+	while (sceIoDread(dfd, &entry) > 0) {
+		source_path[size_path] = '\0';
+		sceClibStrncat(source_path, slash_folder, (MAX_PATH_LENGTH));
+		sceClibStrncat(source_path, entry.d_name, (MAX_PATH_LENGTH));
+
+		if (SCE_S_ISDIR(entry.d_stat.st_mode)) {
+			result = append_folder(writer, source_path, size_accounts_path, depth + 1, display);
+		} else if ((depth == 0) && (sceClibStrncmp(entry.d_name, manifest_file, (MAX_PATH_LENGTH)) == 0)) {  // payloads are resolved from the manifest
+			result = 0;
+		} else {
+			if (display) {
+				printf("\e[2mAdding %s...\e[22m\e[0K\n", &(source_path[size_accounts_path]));
+			}
+			result = append_file(writer, source_path, ARCHIVE_ENTRY_FILE, &(source_path[size_accounts_path]));
+			if (result >= 0) {
+				result = 1;
+			}
+		}
+		if (result < 0) {
+			count = result;
+			break;
+		}
+		count += result;
+	}
+	source_path[size_path] = '\0';
+	sceIoDclose(dfd);
+
+	return count;
+}
+
+int export_accounts_archive(const char *archive_path, int display)
+{
+	struct Archive_Writer writer;
+	struct Archive_Header header;
+	struct Manifest_Data manifest;
+	struct Dir_Entry *dirs;
+	int dir_count;
+	int i, j;
+	int size_accounts_path;
+	int result;
+	char source_path[(MAX_PATH_LENGTH)+1];
+	char temp_path[(MAX_PATH_LENGTH)+1];
+	char path[(MAX_PATH_LENGTH)+1];
+
+	writer.fd = sceIoOpen(archive_path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+	if (writer.fd < 0) {
+		return writer.fd;
+	}
+	writer.offset = 0;
+	writer.count = 0;
+	writer.toc_size = 0;
+	writer.toc_capacity = 0;
+	writer.toc = NULL;
+	writer.buffer = borrow_buffer();
+
+	// header is rewritten once the table of contents is known
+	sceClibMemset(&header, 0x00, sizeof(struct Archive_Header));
+	sceClibMemcpy(header.magic, archive_magic, sizeof(header.magic));
+	header.version = (ARCHIVE_VERSION);
+	result = -1;
+	if ((writer.buffer != NULL) && (sceIoWrite(writer.fd, &header, sizeof(struct Archive_Header)) == sizeof(struct Archive_Header))) {
+		writer.offset = sizeof(struct Archive_Header);
+		result = 0;
+	}
+
+	path[(MAX_PATH_LENGTH)] = '\0';
+	build_app_path(temp_path, archive_temp_file);
+	build_app_path(source_path, accounts_folder);
+	size_accounts_path = sceClibStrnlen(source_path, (MAX_PATH_LENGTH));
+
+	// combination labels of all accounts
+	sceClibStrncat(source_path, combinations_file, (MAX_PATH_LENGTH));
+	if ((result >= 0) && check_file_exists(source_path)) {
+		result = append_file(&writer, source_path, ARCHIVE_ENTRY_FILE, combinations_file);
+	}
+
+	// read account directories
+	source_path[size_accounts_path - 1] = '\0';
+	dirs = NULL;
+	dir_count = get_subdirs(source_path, &dirs);
+	source_path[size_accounts_path - 1] = '/';
+
+	for (i = 0; (result >= 0) && (i < dir_count); i++) {
+		source_path[size_accounts_path] = '\0';
+		sceClibStrncat(source_path, dirs[i].name, (MAX_PATH_LENGTH));
+		printf("Exporting account %s...\e[0K\n", dirs[i].name);
+
+		// registry values and plain files
+		result = append_folder(&writer, source_path, size_accounts_path, 0, display);
+		if (result < 0) {
+			break;
+		}
+
+		// account files stored in blob store, added under their plain save path
+		sceClibStrncat(source_path, slash_folder, (MAX_PATH_LENGTH));
+		load_manifest(source_path, &manifest);
+		for (j = 0; j < manifest.count; j++) {
+			sceClibStrncpy(path, dirs[i].name, (MAX_PATH_LENGTH));
+			sceClibStrncat(path, slash_folder, (MAX_PATH_LENGTH));
+			sceClibStrncat(path, manifest.entries[j].save_path, (MAX_PATH_LENGTH));
+			if (display) {
+				printf("\e[2mAdding %s...\e[22m\e[0K\n", path);
+			}
+
+			result = restore_checked_blob(&(manifest.entries[j]), temp_path);
+			if (result >= 0) {
+				result = append_file(&writer, temp_path, ARCHIVE_ENTRY_PAYLOAD, path);
+			}
+			sceIoRemove(temp_path);
+			if (result < 0) {
+				printf("\e[1mFailed to export %s (0x%08x)...\e[22m\e[0K\n", path, result);
+				break;
+			}
+		}
+		free_manifest(&manifest);
+	}
+	free_subdirs(dirs, dir_count);
+
+	// table of contents at the end, then final header
+	if (result >= 0) {
+		header.toc_offset = writer.offset;
+		header.toc_count = writer.count;
+		if ((writer.toc_size > 0) && (sceIoWrite(writer.fd, writer.toc, writer.toc_size) != writer.toc_size)) {
+			result = -1;
+		}
+	}
+	if (result >= 0) {
+		sceIoLseek(writer.fd, 0, SCE_SEEK_SET);
+		if (sceIoWrite(writer.fd, &header, sizeof(struct Archive_Header)) != sizeof(struct Archive_Header)) {
+			result = -1;
+		}
+	}
+
+	free(writer.toc);
+	return_buffer(writer.buffer);
+	sceIoClose(writer.fd);
+
+	if (result < 0) {
+		sceIoRemove(archive_path);
+		return result;
+	}
+
+	return writer.count;
+}
+
+int read_archive_toc(const char *archive_path, struct Archive_Toc *toc)
+{
+	SceUID fd;
+	struct Archive_Header header;
+	struct Archive_Toc_Entry toc_entry;
+	unsigned char *raw;
+	int archive_size;
+	int toc_size;
+	int pos;
+	int used;
+	int i;
+
+	toc->count = 0;
+	toc->entries = NULL;
+	toc->data = NULL;
+
+	fd = sceIoOpen(archive_path, SCE_O_RDONLY, 0);
+	if (fd < 0) {
+		return fd;
+	}
+
+	// check header
+	archive_size = (int)sceIoLseek(fd, 0, SCE_SEEK_END);
+	sceIoLseek(fd, 0, SCE_SEEK_SET);
+	if ((sceIoRead(fd, &header, sizeof(struct Archive_Header)) != sizeof(struct Archive_Header))
+	    || (sceClibMemcmp(header.magic, archive_magic, sizeof(header.magic)) != 0)
+	    || (header.version != (ARCHIVE_VERSION))
+	    || (header.toc_offset < sizeof(struct Archive_Header)) || (header.toc_offset > (unsigned int)archive_size)
+	    || (header.toc_count > ((archive_size - header.toc_offset) / sizeof(struct Archive_Toc_Entry)))) {
+		sceIoClose(fd);
+		return -1;
+	}
+
+	// read table of contents in one go, paths fit into its size including terminators
+	toc_size = archive_size - header.toc_offset;
+	raw = (unsigned char *)malloc(toc_size + 1);
+	toc->data = (char *)malloc(toc_size + 1);
+	toc->entries = (struct Archive_Entry *)malloc((header.toc_count + 1) * sizeof(struct Archive_Entry));
+	if ((raw == NULL) || (toc->data == NULL) || (toc->entries == NULL)
+	    || (sceIoLseek(fd, header.toc_offset, SCE_SEEK_SET) < 0)
+	    || (sceIoRead(fd, raw, toc_size) != toc_size)) {
+		free(raw);
+		sceIoClose(fd);
+		free_archive_toc(toc);
+		return -1;
+	}
+	sceIoClose(fd);
+
+	pos = 0;
+	used = 0;
+	for (i = 0; i < (int)(header.toc_count); i++) {
+		if ((pos + (int)sizeof(struct Archive_Toc_Entry)) > toc_size) {
+			break;
+		}
+		sceClibMemcpy(&toc_entry, &(raw[pos]), sizeof(struct Archive_Toc_Entry));
+		pos += sizeof(struct Archive_Toc_Entry);
+		if (((pos + toc_entry.path_size) > toc_size) || (toc_entry.size > header.toc_offset) || (toc_entry.offset > (header.toc_offset - toc_entry.size)) || (toc_entry.offset < sizeof(struct Archive_Header))) {
+			break;
+		}
+
+		toc->entries[i].offset = toc_entry.offset;
+		toc->entries[i].size = toc_entry.size;
+		toc->entries[i].type = toc_entry.type;
+		toc->entries[i].path = &(toc->data[used]);
+		sceClibMemcpy(toc->entries[i].path, &(raw[pos]), toc_entry.path_size);
+		toc->entries[i].path[toc_entry.path_size] = '\0';
+		used += toc_entry.path_size + 1;
+		pos += toc_entry.path_size;
+	}
+	free(raw);
+
+	if (i < (int)(header.toc_count)) {  // damaged table of contents
+		free_archive_toc(toc);
+		return -1;
+	}
+	toc->count = i;
+
+	return toc->count;
+}
+
+void free_archive_toc(struct Archive_Toc *toc)
+{
+	free(toc->entries);
+	free(toc->data);
+	toc->entries = NULL;
+	toc->data = NULL;
+	toc->count = 0;
+
+	return;
+}
+
+static int extract_entry(SceUID fd, const struct Archive_Entry *const entry, const char *target_path, void *buffer)
+{
+	SceUID fddst;
+	int remaining;
+	int read;
+	int result;
+
+	if (sceIoLseek(fd, entry->offset, SCE_SEEK_SET) < 0) {
+		return -1;
+	}
+
+	fddst = sceIoOpen(target_path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+	if (fddst < 0) {
+		return fddst;
+	}
+
+	// copy entry in large sequential chunks
+	result = 0;
+	remaining = entry->size;
+	while (remaining > 0) {
+		read = sceIoRead(fd, buffer, min(remaining, (TRANSFER_SIZE)));
+		if ((read <= 0) || (sceIoWrite(fddst, buffer, read) != read)) {
+			result = -1;
+			break;
+		}
+		remaining -= read;
+	}
+	sceIoClose(fddst);
+
+	if (result < 0) {
+		sceIoRemove(target_path);
+	}
+
+	return result;
+}
+
+static int find_combination(const char *data, int size, const char *username, int size_username)
+{
+	int pos;
+
+	// lines start with username followed by whitespace
+	pos = 0;
+	while (pos < size) {
+		if (((pos + size_username) < size) && (sceClibStrncmp(&(data[pos]), username, size_username) == 0) && ((data[pos + size_username] == ' ') || (data[pos + size_username] == '\t'))) {
+			return 1;
+		}
+		while ((pos < size) && (data[pos] != '\n')) {
+			pos++;
+		}
+		pos++;
+	}
+
+	return 0;
+}
+
+static int merge_combinations(const char *target_path, const char *data, int size, const char *username)
+{
+	char *existing;
+	char *merged;
+	int size_existing;
+	int size_merged;
+	int start;
+	int end;
+	int token;
+	int added;
+
+	// keep existing labels, only add labels of accounts without one
+	existing = NULL;
+	size_existing = borrow_read_file(target_path, (void **)&existing);
+	if (size_existing < 0) {
+		size_existing = 0;
+	}
+	merged = (char *)malloc(size_existing + size + 2);
+	if (merged == NULL) {
+		return_buffer(existing);
+		return -1;
+	}
+	size_merged = 0;
+	if (size_existing > 0) {
+		sceClibMemcpy(merged, existing, size_existing);
+		size_merged = size_existing;
+		if (merged[size_merged - 1] != '\n') {
+			merged[size_merged++] = '\n';
+		}
+	}
+
+	added = 0;
+	for (start = 0; start < size; start = end + 1) {
+		for (end = start; (end < size) && (data[end] != '\n'); end++);
+		for (token = start; (token < end) && (data[token] != ' ') && (data[token] != '\t'); token++);
+		if ((token == start) || (!check_path_component(&(data[start]), token - start))) {
+			continue;
+		}
+		if ((username != NULL) && ((sceClibStrnlen(username, (MAX_PATH_LENGTH)) != (token - start)) || (sceClibStrncmp(&(data[start]), username, token - start) != 0))) {
+			continue;
+		}
+		if (find_combination(merged, size_merged, &(data[start]), token - start)) {
+			continue;
+		}
+
+		sceClibMemcpy(&(merged[size_merged]), &(data[start]), end - start);
+		size_merged += end - start;
+		merged[size_merged++] = '\n';
+		added++;
+	}
+
+	if (added > 0) {
+		write_file(target_path, merged, size_merged);
+	}
+	free(merged);
+	return_buffer(existing);
+
+	return added;
+}
+
+int import_accounts_archive(const char *archive_path, const char *username, int display)
+{
+	struct Archive_Toc toc;
+	struct Archive_Entry *entry;
+	struct Blob_Store blob_store;
+	struct Manifest_Data manifest;
+	SceUID fd;
+	void *buffer;
+	char *data;
+	char *slash;
+	int i;
+	int count;
+	int result;
+	int size;
+	int size_username;
+	int size_accounts_path;
+	int size_manifest_user;
+	unsigned long long hash;
+	unsigned int checksum;
+	char target_path[(MAX_PATH_LENGTH)+1];
+	char temp_path[(MAX_PATH_LENGTH)+1];
+	char manifest_path[(MAX_PATH_LENGTH)+1];
+
+	result = read_archive_toc(archive_path, &toc);
+	if (result < 0) {
+		return result;
+	}
+
+	fd = sceIoOpen(archive_path, SCE_O_RDONLY, 0);
+	buffer = borrow_buffer();
+	if ((fd < 0) || (buffer == NULL)) {
+		if (fd >= 0) {
+			sceIoClose(fd);
+		}
+		return_buffer(buffer);
+		free_archive_toc(&toc);
+		return -1;
+	}
+
+	build_app_path(temp_path, archive_temp_file);
+	build_app_path(target_path, accounts_folder);
+	size_accounts_path = sceClibStrnlen(target_path, (MAX_PATH_LENGTH));
+	manifest_path[(MAX_PATH_LENGTH)] = '\0';
+	size_username = ((username != NULL) ? sceClibStrnlen(username, (MAX_PATH_LENGTH)) : 0);
+
+	open_blob_store(&blob_store);
+	manifest.count = 0;
+	manifest.entries = NULL;
+	size_manifest_user = 0;
+
+	count = 0;
+	for (i = 0; i < toc.count; i++) {
+		entry = &(toc.entries[i]);
+		target_path[size_accounts_path] = '\0';
+
+		// combination labels are merged into existing ones
+		if (sceClibStrncmp(entry->path, combinations_file, (MAX_PATH_LENGTH)) == 0) {
+			sceClibStrncat(target_path, combinations_file, (MAX_PATH_LENGTH));
+			data = (char *)malloc(entry->size + 1);
+			result = -1;
+			if ((data != NULL) && (sceIoLseek(fd, entry->offset, SCE_SEEK_SET) >= 0) && (sceIoRead(fd, data, entry->size) == (int)(entry->size))) {
+				result = merge_combinations(target_path, data, entry->size, username);
+			}
+			free(data);
+			if (result < 0) {
+				printf("\e[1mFailed to merge %s...\e[22m\e[0K\n", combinations_file);
+			}
+			continue;
+		}
+
+		// never write outside of the accounts folder
+		if (!check_entry_path(entry->path)) {
+			printf("\e[1mSkipping unsafe path %s...\e[22m\e[0K\n", entry->path);
+			continue;
+		}
+
+		// entries of other accounts are not read at all
+		slash = sceClibStrchr(entry->path, '/');
+		if ((slash == NULL) || (slash == entry->path)) {
+			continue;
+		}
+		if ((username != NULL) && (((slash - entry->path) != size_username) || (sceClibStrncmp(entry->path, username, size_username) != 0))) {
+			continue;
+		}
+
+		sceClibStrncat(target_path, entry->path, (MAX_PATH_LENGTH));
+		if (display) {
+			printf("\e[2mExtracting %s...\e[22m\e[0K\n", entry->path);
+		}
+
+		if (entry->type == ARCHIVE_ENTRY_PAYLOAD) {
+			// switch manifest when reaching next account
+			if ((size_manifest_user != ((slash - entry->path) + 1)) || (sceClibStrncmp(&(manifest_path[size_accounts_path]), entry->path, size_manifest_user) != 0)) {
+				if (size_manifest_user > 0) {
+					save_manifest(manifest_path, &manifest);
+					free_manifest(&manifest);
+				}
+				size_manifest_user = (slash - entry->path) + 1;
+				sceClibStrncpy(manifest_path, target_path, size_accounts_path + size_manifest_user);
+				manifest_path[size_accounts_path + size_manifest_user] = '\0';
+				create_path(manifest_path, size_accounts_path, 0);
+				load_manifest(manifest_path, &manifest);
+			}
+
+			// store payload into blob store
+			result = extract_entry(fd, entry, temp_path, buffer);
+			if (result >= 0) {
+				result = store_blob(&blob_store, temp_path, &hash, &size, &checksum);
+			}
+			sceIoRemove(temp_path);
+			if (result >= 0) {
+				set_manifest_entry(&blob_store, &manifest, &(slash[1]), hash, size, checksum);
+				if (check_file_exists(target_path)) {  // stale plain copy
+					sceIoRemove(target_path);
+				}
+			}
+		} else {
+			create_path(target_path, size_accounts_path, 0);
+			result = extract_entry(fd, entry, target_path, buffer);
+		}
+
+		if (result < 0) {
+			printf("\e[1mFailed to extract %s (0x%08x)...\e[22m\e[0K\n", entry->path, result);
+			continue;
+		}
+		count++;
+	}
+
+	if (size_manifest_user > 0) {
+		save_manifest(manifest_path, &manifest);
+		free_manifest(&manifest);
+	}
+	close_blob_store(&blob_store);
+
+	return_buffer(buffer);
+	sceIoClose(fd);
+	free_archive_toc(&toc);
+
+	return count;
+}
+
+void export_accounts(char *title)
+{
+	char archive_path[(MAX_PATH_LENGTH)+1];
+	SceUInt64 time_start;
+	int result;
+
+	// draw title line
+	draw_title_line(title);
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
+
+	build_app_path(archive_path, archive_file);
+	printf("Exporting all accounts to %s...\e[0K\n", archive_path);
+
+	time_start = sceKernelGetProcessTimeWide();
+	result = export_accounts_archive(archive_path, 0);
+	if (result < 0) {
+		printf("\e[1mExport failed (0x%08x)!\e[22m\e[0K\n", result);
+	} else {
+		printf("%i files exported in %u ms!\e[0K\n", result, (unsigned int)((sceKernelGetProcessTimeWide() - time_start) / 1000));
+	}
+	wait_for_cancel_button();
+
+	return;
+}
+
+static int get_archive_accounts(const struct Archive_Toc *const toc, struct Dir_Entry **dirs_ptr)
+{
+	struct Dir_Entry *dirs;
+	char *slash;
+	int dir_count;
+	int size;
+	int i;
+
+	// entries are grouped by account, so comparing with the previous one is enough
+	*dirs_ptr = NULL;
+	dirs = (struct Dir_Entry *)malloc((toc->count + 1) * sizeof(struct Dir_Entry));
+	if (dirs == NULL) {
+		return 0;
+	}
+	dir_count = 0;
+	for (i = 0; i < toc->count; i++) {
+		if (!check_entry_path(toc->entries[i].path)) {
+			continue;
+		}
+		slash = sceClibStrchr(toc->entries[i].path, '/');
+		if ((slash == NULL) || (slash == toc->entries[i].path)) {
+			continue;
+		}
+		size = slash - toc->entries[i].path;
+		if ((dir_count > 0) && (dirs[dir_count - 1].size == (size_t)size) && (sceClibStrncmp(dirs[dir_count - 1].name, toc->entries[i].path, size) == 0)) {
+			continue;
+		}
+
+		dirs[dir_count].size = size;
+		dirs[dir_count].name = (char *)malloc(size + 1);
+		sceClibStrncpy(dirs[dir_count].name, toc->entries[i].path, size);
+		dirs[dir_count].name[size] = '\0';
+		dir_count++;
+	}
+	*dirs_ptr = dirs;
+
+	return dir_count;
+}
+
+// accounts shown by import menu, row 0 is cancel, row 1 imports all
+struct Import_List {
+	char archive_path[(MAX_PATH_LENGTH)+1];
+	struct Dir_Entry *dirs;
+};
+
+static void draw_import_row(void *context, int index)
+{
+	struct Import_List *list;
+
+	list = (struct Import_List *)context;
+	if (index == 0) {
+		printf("Cancel.");
+	} else if (index == 1) {
+		printf("Import all accounts.");
+	} else {
+		printf("%s", list->dirs[index - 2].name);
+	}
+
+	return;
+}
+
+static void draw_import_info(struct Menu *menu)
+{
+	struct Import_List *list;
+
+	list = (struct Import_List *)menu->context;
+
+	// draw info
+	printf("The archive %s contains %i accounts: (L/R to page)\e[0K\n", list->archive_path, menu->count - 2);
+
+	return;
+}
+
+static int select_import_row(struct Menu *menu, int index)
+{
+	struct Import_List *list;
+	int i;
+	int result;
+	SceUInt64 time_start;
+
+	if (index == 0) {  // cancel
+		return (MENU_EXIT);
+	}
+
+	// import all or single account
+	list = (struct Import_List *)menu->context;
+
+	// clear data part of screen
+	clear_menu_data(menu);
+
+	i = index - 2;
+	if (i < 0) {
+		printf("Importing all accounts from %s...\e[0K\n", list->archive_path);
+	} else {
+		printf("Importing account %s from %s...\e[0K\n", list->dirs[i].name, list->archive_path);
+	}
+
+	time_start = sceKernelGetProcessTimeWide();
+	result = import_accounts_archive(list->archive_path, ((i < 0) ? NULL : list->dirs[i].name), 0);
+	if (result < 0) {
+		printf("\e[1mImport failed (0x%08x)!\e[22m\e[0K\n", result);
+	} else {
+		printf("%i files imported in %u ms!\e[0K\n", result, (unsigned int)((sceKernelGetProcessTimeWide() - time_start) / 1000));
+	}
+	wait_for_cancel_button();
+
+	return (MENU_EXIT);
+}
+
+void import_accounts(char *title)
+{
+	struct Archive_Toc toc;
+	int dir_count;
+	struct Import_List import_list;
+	struct Menu menu;
+
+	build_app_path(import_list.archive_path, archive_file);
+	if (read_archive_toc(import_list.archive_path, &toc) < 0) {
+		// draw title line
+		draw_title_line(title);
+
+		// draw pixel line
+		draw_pixel_line(NULL, NULL);
+
+		printf("\e[1mNo valid account archive found at %s.\e[22m\e[0K\n", import_list.archive_path);
+		wait_for_cancel_button();
+		return;
+	}
+	dir_count = get_archive_accounts(&toc, &(import_list.dirs));
+	free_archive_toc(&toc);
+
+	// run import menu
+	init_menu(&menu, title, dir_count + 2, draw_import_row, select_import_row, &import_list);
+	menu.draw_info = draw_import_info;
+	run_menu(&menu);
+
+	// free memory
+	free_subdirs(import_list.dirs, dir_count);
+
+	return;
+}
@@ -0,0 +1,279 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>  // for free()
+#include <vitasdk.h>
+
+#include <account.h>
+#include <batch.h>
+#include <bench.h>
+#include <bufpool.h>
+#include <common.h>
+#include <file.h>
+#include <history.h>
+#include <main.h>
+#include <regcache.h>
+#include <wlan.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+const char *const batch_file = "batch.txt";
+const char *const batch_done_file = "batch.done";
+const char *const batch_log_file = "batch.log";
+
+// set while batch runs, so no command waits for a button
+int batch_mode = 0;
+
+
+static int has_current_user(struct Registry_Data *reg_data)
+{
+	if ((reg_data->idx_username < 0) || (sceClibStrnlen((char *)(get_reg_value(reg_data, reg_data->idx_username)), 1) == 0)) {
+		return 0;
+	}
+	if ((reg_data->idx_login_id < 0) || (sceClibStrnlen((char *)(get_reg_value(reg_data, reg_data->idx_login_id)), 1) == 0)) {
+		return 0;
+	}
+
+	return 1;
+}
+
+static int batch_save_account(struct Batch_Data *batch_data, const char *argument)
+{
+	get_current_account_reg_data(batch_data->current_account_reg_data);
+	get_current_account_file_data(batch_data->current_account_file_data);
+	if (!has_current_user(batch_data->current_account_reg_data)) {
+		return -1;
+	}
+
+	save_account_details(batch_data->current_account_reg_data, batch_data->current_account_file_data, "Batch: Saving Current Account");
+
+	return 0;
+}
+
+static int batch_switch(struct Batch_Data *batch_data, const char *argument)
+{
+	if ((argument == NULL) || (argument[0] == '\0')) {
+		return -1;
+	}
+
+	// draw title line
+	draw_title_line("Batch: Switch Account");
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
+
+	get_current_account_reg_data(batch_data->current_account_reg_data);
+	if (!switch_to_account(batch_data->current_account_reg_data, batch_data->initial_account_reg_data, batch_data->initial_account_file_data, argument)) {
+		return -1;
+	}
+	batch_data->reboot = 1;
+
+	return 0;
+}
+
+static int batch_save_wlan_all(struct Batch_Data *batch_data, const char *argument)
+{
+	get_current_wlan_data(batch_data->current_wlan_data);
+	if (batch_data->current_wlan_data->wlan_found <= 0) {
+		return -1;
+	}
+
+	save_all_wlan_details(batch_data->current_wlan_data, "Batch: Save All WLANs");
+
+	return 0;
+}
+
+static int batch_delete_history(struct Batch_Data *batch_data, const char *argument)
+{
+	get_current_execution_history_data(&execution_history_data);
+	delete_execution_history(&execution_history_data, "Batch: Deleting Execution History");
+	batch_data->reboot = 1;
+
+	return 0;
+}
+
+static int batch_bench(struct Batch_Data *batch_data, const char *argument)
+{
+	run_benchmarks("Batch: Storage Benchmarks");
+
+	return 0;
+}
+
+static int batch_reboot(struct Batch_Data *batch_data, const char *argument)
+{
+	batch_data->reboot_now = 1;
+
+	return 0;
+}
+
+struct Batch_Command batch_commands[] = {
+	{ "save-account", batch_save_account, },
+	{ "switch", batch_switch, },
+	{ "save-wlan-all", batch_save_wlan_all, },
+	{ "delete-history", batch_delete_history, },
+	{ "bench", batch_bench, },
+	{ "reboot", batch_reboot, },
+};
+
+
+static void write_batch_log(SceUID fd, const char *log_line)
+{
+	if (fd < 0) {
+		return;
+	}
+
+	sceIoWrite(fd, log_line, sceClibStrnlen(log_line, (BATCH_LOG_SIZE)));
+
+	return;
+}
+
+int run_batch(struct Batch_Data *batch_data)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	char path2[(MAX_PATH_LENGTH)+1];
+	char line[(BATCH_LINE_SIZE)+1];
+	char log_line[(BATCH_LOG_SIZE)+1];
+	char *data;
+	char *pos;
+	char *end;
+	char *argument;
+	int size;
+	int len;
+	int line_number;
+	int count;
+	int failed;
+	int result;
+	int i;
+	SceUID fd;
+	SceUInt64 time_start;
+	SceUInt64 time_command;
+
+	batch_data->reboot = 0;
+	batch_data->reboot_now = 0;
+
+	// build batch path
+	path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, batch_file, (MAX_PATH_LENGTH));
+
+	data = NULL;
+	size = allocate_read_file(path, (void **)(&data));
+	if (size < 0) {
+		return (BATCH_NONE);
+	}
+
+	// only run once, keep file as done
+	path2[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path2, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path2, batch_done_file, (MAX_PATH_LENGTH));
+	sceIoRemove(path2);
+	sceIoRename(path, path2);
+
+	// open log
+	sceClibStrncpy(path2, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path2, batch_log_file, (MAX_PATH_LENGTH));
+	fd = sceIoOpen(path2, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+
+	// run commands without waiting for buttons
+	batch_mode = 1;
+	count = 0;
+	failed = 0;
+	line_number = 0;
+	time_start = sceKernelGetProcessTimeWide();
+	pos = data;
+	end = data + size;
+	while ((pos < end) && !batch_data->reboot_now) {
+		// one command per line, "#" starts a comment line
+		len = 0;
+		while ((pos < end) && (*pos != '\n')) {
+			if ((*pos != '\r') && (len < (BATCH_LINE_SIZE))) {
+				line[len++] = *pos;
+			}
+			pos++;
+		}
+		pos++;
+		line[len] = '\0';
+		line_number++;
+
+		while ((len > 0) && (line[len - 1] == ' ')) {
+			line[--len] = '\0';
+		}
+		if ((len == 0) || (line[0] == '#')) {
+			continue;
+		}
+
+		// split command and argument
+		argument = sceClibStrchr(line, ' ');
+		if (argument != NULL) {
+			*argument++ = '\0';
+			while (*argument == ' ') {
+				argument++;
+			}
+		} else {
+			argument = &(line[len]);
+		}
+
+		count++;
+		time_command = sceKernelGetProcessTimeWide();
+		result = -1;
+		for (i = 0; i < (sizeof(batch_commands) / sizeof(batch_commands[0])); i++) {
+			if (sceClibStrcmp(line, batch_commands[i].name) == 0) {
+				result = batch_commands[i].run(batch_data, argument);
+				break;
+			}
+		}
+		if (result < 0) {
+			failed++;
+		}
+
+		sceClibSnprintf(log_line, sizeof(log_line), "%i: %s%s%s - %s, %u ms\n", line_number, line, ((argument[0] != '\0') ? " " : ""), argument, ((i >= (sizeof(batch_commands) / sizeof(batch_commands[0]))) ? "unknown command" : ((result < 0) ? "failed" : "ok")), (unsigned int)((sceKernelGetProcessTimeWide() - time_command) / 1000));
+		write_batch_log(fd, log_line);
+	}
+	batch_mode = 0;
+	free(data);
+
+	// draw title line
+	draw_title_line("Batch Mode");
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
+
+	time_start = (sceKernelGetProcessTimeWide() - time_start) / 1000;
+	sceClibSnprintf(log_line, sizeof(log_line), "%i commands, %i failed, %u ms\n", count, failed, (unsigned int)time_start);
+	write_batch_log(fd, log_line);
+	sceClibSnprintf(log_line, sizeof(log_line), "registry cache: %i hits, %i misses (%i%%), %i writes\n", reg_cache_stats.hits, reg_cache_stats.misses, get_reg_cache_hit_rate(), reg_cache_stats.writes);
+	write_batch_log(fd, log_line);
+	sceClibSnprintf(log_line, sizeof(log_line), "buffer pool: %i of %i blocks peak, %i borrowed, %i fallbacks\n", buffer_pool_stats.high_water, (BUFFER_POOL_BLOCKS), buffer_pool_stats.borrowed, buffer_pool_stats.fallbacks);
+	write_batch_log(fd, log_line);
+	if (fd >= 0) {
+		sceIoClose(fd);
+	}
+
+	printf("%i batch commands run in %u ms, %i failed.\e[0K\n", count, (unsigned int)time_start, failed);
+	printf("Details are logged to %s.\e[0K\n", path2);
+	if (batch_data->reboot_now) {
+		printf("Rebooting...\e[0K\n");
+		return (BATCH_REBOOT);
+	}
+	wait_for_cancel_button();
+
+	return (BATCH_DONE);
+}
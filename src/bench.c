@@ -0,0 +1,454 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>  // for free()
+#include <malloc.h>  // for memalign()
+#include <vitasdk.h>
+
+#include <bench.h>
+#include <bufpool.h>
+#include <common.h>
+#include <file.h>
+#include <hash.h>
+#include <history.h>
+#include <lz.h>
+#include <main.h>
+#include <snapshot.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+const char *const bench_report_file = "bench.txt";
+const char *const bench_source_file = "bench.src";
+const char *const bench_target_file = "bench.dst";
+
+#define BENCH_FILE_SIZE (4 * 1024 * 1024)
+#define BENCH_MEMORY_SIZE (16 * 1024 * 1024)
+#define BENCH_SMALL_FILE_SIZE (16 * 1024)  // like a manifest or reference list
+#define BENCH_ROUNDS 256
+#define BENCH_LZ_ROUNDS 16
+#define BENCH_MLOG_LINE_SIZE 64
+#define BENCH_MLOG_HOMEBREW_EVERY 8  // every n-th record mentions this app
+
+// account files measured by the compression benchmark
+static const char *const bench_lz_files[] = {
+	"tm0:npdrm/act.dat",
+	"ur0:user/00/np/myprofile.dat",
+};
+
+static volatile unsigned long long bench_sink;  // keeps measured results alive
+
+
+static void build_bench_path(char *path, const char *const name)
+{
+	path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, name, (MAX_PATH_LENGTH));
+
+	return;
+}
+
+static unsigned int get_rate(unsigned long long bytes, SceUInt64 time_us)
+{
+	// KB per second
+	if (time_us == 0) {
+		time_us = 1;
+	}
+
+	return (unsigned int)((bytes * 1000000 / time_us) / 1024);
+}
+
+static void fill_bench_buffer(unsigned char *buffer, int size, unsigned int seed)
+{
+	int i;
+
+	// xorshift, incompressible like encrypted account files
+	for (i = 0; i < size; i++) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		buffer[i] = (unsigned char)seed;
+	}
+
+	return;
+}
+
+static int write_bench_file(const char *path, int size)
+{
+	unsigned char *buffer;
+	SceUID fd;
+	int written;
+	int part;
+
+	fd = sceIoOpen(path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+	if (fd < 0) {
+		return fd;
+	}
+
+	buffer = (unsigned char *)borrow_buffer();
+	written = 0;
+	while (written < size) {
+		part = size - written;
+		if (part > (TRANSFER_SIZE)) {
+			part = (TRANSFER_SIZE);
+		}
+		fill_bench_buffer(buffer, part, 0x9e3779b9 + written);
+		if (sceIoWrite(fd, buffer, part) != part) {
+			break;
+		}
+		written += part;
+	}
+	return_buffer(buffer);
+	sceIoClose(fd);
+
+	return ((written == size) ? written : -1);
+}
+
+// hash speed in memory and checksum overhead of a file copy per MB
+static int bench_hash(char *result, int size)
+{
+	char source_path[(MAX_PATH_LENGTH)+1];
+	char target_path[(MAX_PATH_LENGTH)+1];
+	struct Hash_Xxh32_State state;
+	unsigned long long hash;
+	unsigned int checksum;
+	unsigned char *buffer;
+	SceUInt64 time_start;
+	SceUInt64 time_xxh32;
+	SceUInt64 time_fnv1a64;
+	SceUInt64 time_plain;
+	SceUInt64 time_checked;
+	int done;
+
+	buffer = (unsigned char *)borrow_buffer();
+	fill_bench_buffer(buffer, (TRANSFER_SIZE), 0x12345678);
+
+	time_start = sceKernelGetProcessTimeWide();
+	hash_xxh32_init(&state);
+	for (done = 0; done < (BENCH_MEMORY_SIZE); done += (TRANSFER_SIZE)) {
+		hash_xxh32_update(&state, buffer, (TRANSFER_SIZE));
+	}
+	checksum = hash_xxh32_digest(&state);
+	time_xxh32 = sceKernelGetProcessTimeWide() - time_start;
+
+	time_start = sceKernelGetProcessTimeWide();
+	hash = (HASH_FNV1A64_INIT);
+	for (done = 0; done < (BENCH_MEMORY_SIZE); done += (TRANSFER_SIZE)) {
+		hash = hash_fnv1a64_update(hash, buffer, (TRANSFER_SIZE));
+	}
+	time_fnv1a64 = sceKernelGetProcessTimeWide() - time_start;
+	return_buffer(buffer);
+
+	// same copy with and without checksum, difference is the checksum cost
+	build_bench_path(source_path, bench_source_file);
+	build_bench_path(target_path, bench_target_file);
+	if (write_bench_file(source_path, (BENCH_FILE_SIZE)) < 0) {
+		sceIoRemove(source_path);
+		return -1;
+	}
+	time_start = sceKernelGetProcessTimeWide();
+	done = copy_file(source_path, target_path, NULL);
+	time_plain = sceKernelGetProcessTimeWide() - time_start;
+	if (done >= 0) {
+		time_start = sceKernelGetProcessTimeWide();
+		done = copy_file(source_path, target_path, &checksum);
+		time_checked = sceKernelGetProcessTimeWide() - time_start;
+	}
+	sceIoRemove(target_path);
+	sceIoRemove(source_path);
+	if (done < 0) {
+		return -1;
+	}
+
+	bench_sink = hash ^ checksum;
+	sceClibSnprintf(result, size, "xxh32 %u KB/s, fnv1a64 %u KB/s, 4 MB copy %u ms plain, %u ms checked, %i us per MB",
+	  get_rate((BENCH_MEMORY_SIZE), time_xxh32), get_rate((BENCH_MEMORY_SIZE), time_fnv1a64),
+	  (unsigned int)(time_plain / 1000), (unsigned int)(time_checked / 1000), (int)(((long long)time_checked - (long long)time_plain) / ((BENCH_FILE_SIZE) / (1024 * 1024))));
+
+	return 0;
+}
+
+// pooled blocks against heap allocations, for block borrows and small whole file reads
+static int bench_pool(char *result, int size)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	void *buffer;
+	SceUInt64 time_start;
+	SceUInt64 time_borrow;
+	SceUInt64 time_memalign;
+	SceUInt64 time_read_pool;
+	SceUInt64 time_read_heap;
+	int done;
+	int i;
+
+	time_start = sceKernelGetProcessTimeWide();
+	for (i = 0; i < (BENCH_ROUNDS); i++) {
+		buffer = borrow_buffer();
+		((unsigned char *)buffer)[0] = (unsigned char)i;
+		return_buffer(buffer);
+	}
+	time_borrow = sceKernelGetProcessTimeWide() - time_start;
+
+	time_start = sceKernelGetProcessTimeWide();
+	for (i = 0; i < (BENCH_ROUNDS); i++) {
+		buffer = memalign((BUFFER_POOL_ALIGN), (BUFFER_POOL_BLOCK_SIZE));
+		if (buffer == NULL) {
+			return -1;
+		}
+		((unsigned char *)buffer)[0] = (unsigned char)i;
+		free(buffer);
+	}
+	time_memalign = sceKernelGetProcessTimeWide() - time_start;
+
+	build_bench_path(path, bench_source_file);
+	if (write_bench_file(path, (BENCH_SMALL_FILE_SIZE)) < 0) {
+		sceIoRemove(path);
+		return -1;
+	}
+	done = 0;
+	time_start = sceKernelGetProcessTimeWide();
+	for (i = 0; (i < (BENCH_ROUNDS)) && (done >= 0); i++) {
+		buffer = NULL;
+		done = borrow_read_file(path, &buffer);
+		return_buffer(buffer);
+	}
+	time_read_pool = sceKernelGetProcessTimeWide() - time_start;
+	time_start = sceKernelGetProcessTimeWide();
+	for (i = 0; (i < (BENCH_ROUNDS)) && (done >= 0); i++) {
+		buffer = NULL;
+		done = allocate_read_file(path, &buffer);
+		free(buffer);
+	}
+	time_read_heap = sceKernelGetProcessTimeWide() - time_start;
+	sceIoRemove(path);
+	if (done < 0) {
+		return -1;
+	}
+
+	sceClibSnprintf(result, size, "block %u ns pooled, %u ns memalign, 16 KB read %u us pooled, %u us heap, %i blocks peak",
+	  (unsigned int)(time_borrow * 1000 / (BENCH_ROUNDS)), (unsigned int)(time_memalign * 1000 / (BENCH_ROUNDS)),
+	  (unsigned int)(time_read_pool / (BENCH_ROUNDS)), (unsigned int)(time_read_heap / (BENCH_ROUNDS)), buffer_pool_stats.high_water);
+
+	return 0;
+}
+
+// blob compression ratio and speed on the live account files
+static int bench_lz(char *result, int size)
+{
+	char packed_path[(MAX_PATH_LENGTH)+1];
+	char target_path[(MAX_PATH_LENGTH)+1];
+	const char *name;
+	SceUInt64 time_start;
+	SceUInt64 time_compress;
+	SceUInt64 time_decompress;
+	int size_raw;
+	int size_packed;
+	int length;
+	int done;
+	int i;
+	int j;
+
+	build_bench_path(packed_path, bench_source_file);
+	build_bench_path(target_path, bench_target_file);
+	length = 0;
+	result[0] = '\0';
+	for (i = 0; i < (sizeof(bench_lz_files) / sizeof(bench_lz_files[0])); i++) {
+		name = sceClibStrrchr(bench_lz_files[i], '/') + 1;
+		size_raw = get_file_size(bench_lz_files[i]);
+		if (size_raw < 0) {
+			length += sceClibSnprintf(&(result[length]), size - length, "%s%s missing", ((i > 0) ? ", " : ""), name);
+			if (length >= size) {
+				break;
+			}
+			continue;
+		}
+
+		done = 0;
+		time_start = sceKernelGetProcessTimeWide();
+		for (j = 0; (j < (BENCH_LZ_ROUNDS)) && (done >= 0); j++) {
+			done = copy_file_compress(bench_lz_files[i], packed_path, NULL);
+		}
+		time_compress = sceKernelGetProcessTimeWide() - time_start;
+		size_packed = get_file_size(packed_path);
+		time_start = sceKernelGetProcessTimeWide();
+		for (j = 0; (j < (BENCH_LZ_ROUNDS)) && (done >= 0); j++) {
+			done = copy_file_decompress(packed_path, target_path, NULL);
+		}
+		time_decompress = sceKernelGetProcessTimeWide() - time_start;
+		sceIoRemove(target_path);
+		sceIoRemove(packed_path);
+		if (done < 0) {
+			return -1;
+		}
+
+		length += sceClibSnprintf(&(result[length]), size - length, "%s%s %i to %i bytes (%i%%), %u KB/s packing, %u KB/s unpacking",
+		  ((i > 0) ? ", " : ""), name, size_raw, size_packed, ((size_raw > 0) ? (int)((long long)size_packed * 100 / size_raw) : 100),
+		  get_rate((unsigned long long)size_raw * (BENCH_LZ_ROUNDS), time_compress), get_rate((unsigned long long)size_raw * (BENCH_LZ_ROUNDS), time_decompress));
+		if (length >= size) {
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static int write_mlog_bench_file(const char *path, int size)
+{
+	char *buffer;
+	SceUID fd;
+	int written;
+	int part;
+	int line;
+
+	fd = sceIoOpen(path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+	if (fd < 0) {
+		return fd;
+	}
+
+	// fixed size records, official title IDs mixed with this app
+	buffer = (char *)borrow_buffer();
+	written = 0;
+	line = 0;
+	while (written < size) {
+		for (part = 0; (part + (BENCH_MLOG_LINE_SIZE) <= (TRANSFER_SIZE)) && ((written + part) < size); part += (BENCH_MLOG_LINE_SIZE), line++) {
+			sceClibSnprintf(&(buffer[part]), (BENCH_MLOG_LINE_SIZE), "%08x %s launched by shell, record %-18i",
+			  line, (((line % (BENCH_MLOG_HOMEBREW_EVERY)) == 0) ? VITA_TITLEID : "PCSE00000"), line);
+			buffer[part + (BENCH_MLOG_LINE_SIZE) - 1] = '\n';
+		}
+		if (sceIoWrite(fd, buffer, part) != part) {
+			break;
+		}
+		written += part;
+	}
+	return_buffer(buffer);
+	sceIoClose(fd);
+
+	return ((written >= size) ? written : -1);
+}
+
+// m.log scrub speed on a multi MB log against the homebrew installed on this console
+static int bench_mlog(char *result, int size)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	struct Title_Filter filter;
+	SceUInt64 time_start;
+	SceUInt64 time_scrub;
+	int size_log;
+	int removed;
+	int count;
+
+	build_bench_path(path, bench_source_file);
+	size_log = write_mlog_bench_file(path, (BENCH_FILE_SIZE));
+	if (size_log < 0) {
+		sceIoRemove(path);
+		return -1;
+	}
+	count = load_homebrew_title_filter(&filter);
+	if (count < 0) {
+		sceIoRemove(path);
+		return -1;
+	}
+
+	time_start = sceKernelGetProcessTimeWide();
+	removed = scrub_mlog_file(path, &filter);
+	time_scrub = sceKernelGetProcessTimeWide() - time_start;
+	sceIoRemove(path);
+	free_title_filter(&filter);
+	if (removed < 0) {
+		return -1;
+	}
+
+	sceClibSnprintf(result, size, "%i KB with %i records in %u ms, %u KB/s, %i records removed, %i title IDs filtered",
+	  size_log / 1024, size_log / (BENCH_MLOG_LINE_SIZE), (unsigned int)(time_scrub / 1000), get_rate(size_log, time_scrub), removed, count);
+
+	return 0;
+}
+
+// full registry snapshot taken before every risky operation, target is below 1 s
+static int bench_snapshot(char *result, int size)
+{
+	struct Reg_Snapshot snapshot;
+	SceUInt64 time_start;
+	SceUInt64 time_capture;
+	int keys;
+
+	time_start = sceKernelGetProcessTimeWide();
+	if (capture_full_reg_snapshot(&snapshot) < 0) {
+		return -1;
+	}
+	time_capture = sceKernelGetProcessTimeWide() - time_start;
+	keys = ((struct Reg_Snapshot_Header *)(snapshot.data))->count;
+
+	sceClibSnprintf(result, size, "%i keys, %i bytes captured in %u ms", keys, snapshot.size, (unsigned int)(time_capture / 1000));
+	free_reg_snapshot(&snapshot);
+
+	return 0;
+}
+
+static const struct Bench_Entry bench_entries[] = {
+	{ "hash", bench_hash, },
+	{ "pool", bench_pool, },
+	{ "lz", bench_lz, },
+	{ "mlog", bench_mlog, },
+	{ "snapshot", bench_snapshot, },
+};
+
+
+// runs all benchmarks on this console and writes results to report file
+void run_benchmarks(char *title)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	char line[(BENCH_LINE_SIZE)+1];
+	char result[(BENCH_LINE_SIZE)+1];
+	SceUID fd;
+	int size;
+	int i;
+
+	// draw title line
+	draw_title_line(title);
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
+
+	build_bench_path(path, bench_report_file);
+	fd = sceIoOpen(path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+	for (i = 0; i < (sizeof(bench_entries) / sizeof(bench_entries[0])); i++) {
+		printf("\e[2mRunning %s benchmark...\e[22m\e[0K\n", bench_entries[i].name);
+		result[(BENCH_LINE_SIZE)] = '\0';
+		if (bench_entries[i].run(result, (BENCH_LINE_SIZE)) < 0) {
+			sceClibStrncpy(result, "failed", (BENCH_LINE_SIZE));
+		}
+		size = sceClibSnprintf(line, sizeof(line), "%s: %s\n", bench_entries[i].name, result);
+		if (size > (BENCH_LINE_SIZE)) {
+			size = (BENCH_LINE_SIZE);
+		}
+		printf("%s: %s\e[0K\n", bench_entries[i].name, result);
+		if (fd >= 0) {
+			sceIoWrite(fd, line, size);
+		}
+	}
+	if (fd >= 0) {
+		sceIoClose(fd);
+	}
+	printf("Results written to %s.\e[0K\n", path);
+
+	wait_for_cancel_button();
+
+	return;
+}
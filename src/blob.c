@@ -0,0 +1,497 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>  // for malloc(), realloc(), free(), strtoull()
+#include <vitasdk.h>
+
+#include <blob.h>
+#include <bufpool.h>
+#include <common.h>
+#include <dir.h>
+#include <file.h>
+#include <hash.h>
+#include <lz.h>
+#include <main.h>
+#include <settings.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+const char *const blobs_folder = "blobs/";
+const char *const blob_refs_file = "refs.txt";
+const char *const blob_ext = ".bin";
+const char *const blob_ext_lz = ".lz";
+const char *const blob_ext_temp = ".tmp";
+const char *const manifest_file = "files.txt";
+
+#define MANIFEST_SCRATCH_SIZE 4096
+
+
+static void build_refs_path(char *path)
+{
+	path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, blobs_folder, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, blob_refs_file, (MAX_PATH_LENGTH));
+
+	return;
+}
+
+void open_blob_store(struct Blob_Store *store)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	char line[(STRING_BUFFER_DEFAULT_SIZE)+1];
+	char *data;
+	const char *pos;
+	int size;
+	int alloc;
+	int fields;
+	char hash_hex[17];
+	struct Blob_Ref *ref;
+
+	store->count = 0;
+	store->dirty = 0;
+	store->refs = NULL;
+
+	// create blobs base path
+	build_refs_path(path);
+	create_path(path, 0, 0);
+
+	// read reference counts
+	size = borrow_read_file(path, (void **)(&data));
+	if (size < 0) {
+		return;
+	}
+
+	alloc = 0;
+	pos = data;
+	while (read_text_line(&pos, data + size, line, (STRING_BUFFER_DEFAULT_SIZE)) >= 0) {
+		if (store->count >= alloc) {
+			alloc += 32;
+			store->refs = (struct Blob_Ref *)realloc(store->refs, alloc * sizeof(struct Blob_Ref));
+		}
+		ref = &(store->refs[store->count]);
+		fields = sscanf(line, "%16s %i %i %8x", hash_hex, &(ref->size), &(ref->refs), &(ref->checksum));
+		if (fields < 3) {
+			continue;
+		}
+		ref->hash = strtoull(hash_hex, NULL, 16);
+		ref->has_checksum = (fields == 4);
+		store->count++;
+	}
+	return_buffer(data);
+
+	return;
+}
+
+void close_blob_store(struct Blob_Store *store)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	char line[(STRING_BUFFER_DEFAULT_SIZE)+1];
+	SceUID fd;
+	int i;
+	int size;
+
+	// write reference counts
+	if (store->dirty) {
+		build_refs_path(path);
+		fd = sceIoOpen(path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+		if (fd >= 0) {
+			for (i = 0; i < store->count; i++) {
+				if (store->refs[i].has_checksum) {
+					size = sceClibSnprintf(line, (STRING_BUFFER_DEFAULT_SIZE), "%08x%08x %i %i %08x\n", (unsigned int)(store->refs[i].hash >> 32), (unsigned int)(store->refs[i].hash), store->refs[i].size, store->refs[i].refs, store->refs[i].checksum);
+				} else {
+					size = sceClibSnprintf(line, (STRING_BUFFER_DEFAULT_SIZE), "%08x%08x %i %i\n", (unsigned int)(store->refs[i].hash >> 32), (unsigned int)(store->refs[i].hash), store->refs[i].size, store->refs[i].refs);
+				}
+				sceIoWrite(fd, line, size);
+			}
+			sceIoClose(fd);
+		}
+	}
+
+	free(store->refs);
+	store->refs = NULL;
+	store->count = 0;
+	store->dirty = 0;
+
+	return;
+}
+
+void build_blob_path(char *path, unsigned long long hash, int compressed)
+{
+	char name[32];
+
+	sceClibSnprintf(name, sizeof(name), "%08x%08x", (unsigned int)(hash >> 32), (unsigned int)(hash));
+
+	path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, blobs_folder, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, name, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, (compressed ? blob_ext_lz : blob_ext), (MAX_PATH_LENGTH));
+
+	return;
+}
+
+int check_blob_exists(unsigned long long hash)
+{
+	char blob_path[(MAX_PATH_LENGTH)+1];
+
+	build_blob_path(blob_path, hash, 1);
+	if (check_file_exists(blob_path)) {
+		return 1;
+	}
+	build_blob_path(blob_path, hash, 0);
+	if (check_file_exists(blob_path)) {
+		return 0;
+	}
+
+	return -1;
+}
+
+int restore_blob(unsigned long long hash, const char *target_path, unsigned int *checksum_ptr)
+{
+	char blob_path[(MAX_PATH_LENGTH)+1];
+	int compressed;
+
+	compressed = check_blob_exists(hash);
+	if (compressed < 0) {
+		return -1;
+	}
+
+	build_blob_path(blob_path, hash, compressed);
+	if (compressed) {
+		return copy_file_decompress(blob_path, target_path, checksum_ptr);
+	}
+
+	return copy_file(blob_path, target_path, checksum_ptr);
+}
+
+int restore_checked_blob(const struct Manifest_Entry *const entry, const char *target_path)
+{
+	char temp_path[(MAX_PATH_LENGTH)+1];
+	unsigned int checksum;
+	int result;
+
+	if (!entry->has_checksum) {
+		return restore_blob(entry->hash, target_path, NULL);
+	}
+
+	// restore into temporary file, only replace target when checksum of restored content matches
+	temp_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(temp_path, target_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(temp_path, blob_ext_temp, (MAX_PATH_LENGTH));
+	result = restore_blob(entry->hash, temp_path, &checksum);
+	if (result < 0) {
+		return result;
+	}
+	if (checksum != entry->checksum) {
+		printf("\e[1mChecksum mismatch %08x instead of %08x for %s...\e[22m\e[0K\n", checksum, entry->checksum, entry->save_path);
+		sceIoRemove(temp_path);
+		return -1;
+	}
+
+	sceIoRemove(target_path);
+	result = sceIoRename(temp_path, target_path);
+	if (result < 0) {
+		sceIoRemove(temp_path);
+		return result;
+	}
+
+	return 1;
+}
+
+static struct Blob_Ref *find_blob_ref(struct Blob_Store *store, unsigned long long hash)
+{
+	int i;
+
+	for (i = 0; i < store->count; i++) {
+		if (store->refs[i].hash == hash) {
+			return &(store->refs[i]);
+		}
+	}
+
+	return NULL;
+}
+
+int store_blob(struct Blob_Store *store, const char *source_path, unsigned long long *hash_ptr, int *size_ptr, unsigned int *checksum_ptr)
+{
+	char blob_path[(MAX_PATH_LENGTH)+1];
+	struct Blob_Ref *ref;
+	unsigned long long hash;
+	unsigned int checksum;
+	unsigned int copy_checksum;
+	int size;
+	int result;
+
+	// determine content address and checksum
+	size = hash_file(source_path, &hash, &checksum);
+	if (size < 0) {
+		return size;
+	}
+
+	// a stored blob is only the same content if size and checksum match too, other content moves to next free address
+	while ((ref = find_blob_ref(store, hash)) != NULL) {
+		if ((ref->size == size) && ((!ref->has_checksum) || (ref->checksum == checksum))) {
+			break;
+		}
+		printf("\e[2mHash collision for %s, using next address...\e[22m\e[0K\n", source_path);
+		hash++;
+	}
+
+	if (hash_ptr != NULL) {
+		*hash_ptr = hash;
+	}
+	if (size_ptr != NULL) {
+		*size_ptr = size;
+	}
+	if (checksum_ptr != NULL) {
+		*checksum_ptr = checksum;
+	}
+
+	// only new content has to be written
+	if ((ref != NULL) && (check_blob_exists(hash) >= 0)) {
+		return 0;
+	}
+
+	build_blob_path(blob_path, hash, app_settings.compress_blobs);
+	if (app_settings.compress_blobs) {
+		result = copy_file_compress(source_path, blob_path, &copy_checksum);
+	} else {
+		result = copy_file(source_path, blob_path, &copy_checksum);
+	}
+	if (result < 0) {
+		return result;
+	}
+
+	// copied content must match the hashed content
+	if (copy_checksum != checksum) {
+		printf("\e[1mChecksum mismatch %08x instead of %08x for %s...\e[22m\e[0K\n", copy_checksum, checksum, source_path);
+		sceIoRemove(blob_path);
+		return -1;
+	}
+
+	return 1;
+}
+
+void ref_blob(struct Blob_Store *store, unsigned long long hash, int size, unsigned int checksum)
+{
+	struct Blob_Ref *ref;
+
+	ref = find_blob_ref(store, hash);
+	if (ref == NULL) {
+		store->refs = (struct Blob_Ref *)realloc(store->refs, (store->count + 1) * sizeof(struct Blob_Ref));
+		ref = &(store->refs[store->count++]);
+		ref->hash = hash;
+		ref->size = size;
+		ref->refs = 0;
+	}
+	// refs of older versions gain their checksum
+	ref->checksum = checksum;
+	ref->has_checksum = 1;
+	ref->refs++;
+	store->dirty = 1;
+
+	return;
+}
+
+void unref_blob(struct Blob_Store *store, unsigned long long hash)
+{
+	char blob_path[(MAX_PATH_LENGTH)+1];
+	struct Blob_Ref *ref;
+
+	ref = find_blob_ref(store, hash);
+	if (ref == NULL) {
+		return;
+	}
+
+	ref->refs--;
+	store->dirty = 1;
+	if (ref->refs > 0) {
+		return;
+	}
+
+	// garbage collect unreferenced blob
+	build_blob_path(blob_path, hash, 0);
+	printf("\e[2mDeleting unreferenced %s...\e[22m\e[0K\n", blob_path);
+	sceIoRemove(blob_path);
+	build_blob_path(blob_path, hash, 1);
+	sceIoRemove(blob_path);
+	*ref = store->refs[--(store->count)];
+
+	return;
+}
+
+void load_manifest(const char *const base_path, struct Manifest_Data *manifest)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	char line[(STRING_BUFFER_DEFAULT_SIZE)+1];
+	char scratch[(MANIFEST_SCRATCH_SIZE)];
+	struct Scratch_Arena arena;
+	char *data;
+	const char *pos;
+	int size;
+	int alloc;
+	int allocated;
+	int fields;
+	char hash_hex[17];
+	struct Manifest_Entry *entry;
+
+	manifest->count = 0;
+	manifest->entries = NULL;
+
+	// build manifest path
+	path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path, base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, manifest_file, (MAX_PATH_LENGTH));
+
+	// read into scratch memory, only large manifests need heap memory
+	init_scratch_arena(&arena, scratch, sizeof(scratch));
+	allocated = 0;
+	size = arena_read_file(&arena, path, (void **)(&data));
+	if (size == -1) {
+		size = borrow_read_file(path, (void **)(&data));
+		allocated = 1;
+	}
+	if (size < 0) {
+		return;
+	}
+
+	alloc = 0;
+	pos = data;
+	while (read_text_line(&pos, data + size, line, (STRING_BUFFER_DEFAULT_SIZE)) >= 0) {
+		if (manifest->count >= alloc) {
+			alloc += 8;
+			manifest->entries = (struct Manifest_Entry *)realloc(manifest->entries, alloc * sizeof(struct Manifest_Entry));
+		}
+		entry = &(manifest->entries[manifest->count]);
+		// checksum column is optional, older versions did not write it
+		fields = sscanf(line, "%16s %i %256s %8x", hash_hex, &(entry->size), entry->save_path, &(entry->checksum));
+		if (fields < 3) {
+			continue;
+		}
+		entry->has_checksum = (fields == 4);
+		entry->save_path[(MANIFEST_PATH_SIZE)] = '\0';
+		entry->hash = strtoull(hash_hex, NULL, 16);
+		manifest->count++;
+	}
+	if (allocated) {
+		return_buffer(data);
+	}
+
+	return;
+}
+
+void save_manifest(const char *const base_path, const struct Manifest_Data *const manifest)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	char line[(STRING_BUFFER_DEFAULT_SIZE)+1];
+	SceUID fd;
+	int i;
+	int size;
+
+	// build manifest path
+	path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path, base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, manifest_file, (MAX_PATH_LENGTH));
+
+	printf("\e[2mWriting %s...\e[22m\e[0K\n", manifest_file);
+	fd = sceIoOpen(path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+	if (fd < 0) {
+		return;
+	}
+	for (i = 0; i < manifest->count; i++) {
+		if (manifest->entries[i].has_checksum) {
+			size = sceClibSnprintf(line, (STRING_BUFFER_DEFAULT_SIZE), "%08x%08x %i %s %08x\n", (unsigned int)(manifest->entries[i].hash >> 32), (unsigned int)(manifest->entries[i].hash), manifest->entries[i].size, manifest->entries[i].save_path, manifest->entries[i].checksum);
+		} else {
+			size = sceClibSnprintf(line, (STRING_BUFFER_DEFAULT_SIZE), "%08x%08x %i %s\n", (unsigned int)(manifest->entries[i].hash >> 32), (unsigned int)(manifest->entries[i].hash), manifest->entries[i].size, manifest->entries[i].save_path);
+		}
+		sceIoWrite(fd, line, size);
+	}
+	sceIoClose(fd);
+
+	return;
+}
+
+void free_manifest(struct Manifest_Data *manifest)
+{
+	free(manifest->entries);
+	manifest->entries = NULL;
+	manifest->count = 0;
+
+	return;
+}
+
+struct Manifest_Entry *find_manifest_entry(const struct Manifest_Data *const manifest, const char *save_path)
+{
+	int i;
+
+	for (i = 0; i < manifest->count; i++) {
+		if (sceClibStrncmp(manifest->entries[i].save_path, save_path, (MANIFEST_PATH_SIZE)) == 0) {
+			return &(manifest->entries[i]);
+		}
+	}
+
+	return NULL;
+}
+
+void set_manifest_entry(struct Blob_Store *store, struct Manifest_Data *manifest, const char *save_path, unsigned long long hash, int size, unsigned int checksum)
+{
+	struct Manifest_Entry *entry;
+
+	entry = find_manifest_entry(manifest, save_path);
+	if (entry == NULL) {
+		manifest->entries = (struct Manifest_Entry *)realloc(manifest->entries, (manifest->count + 1) * sizeof(struct Manifest_Entry));
+		entry = &(manifest->entries[manifest->count++]);
+		sceClibStrncpy(entry->save_path, save_path, (MANIFEST_PATH_SIZE));
+		entry->save_path[(MANIFEST_PATH_SIZE)] = '\0';
+	} else if (entry->hash == hash) {  // unchanged, entries of older versions gain their checksum
+		entry->checksum = checksum;
+		entry->has_checksum = 1;
+		return;
+	} else {
+		unref_blob(store, entry->hash);
+	}
+
+	entry->hash = hash;
+	entry->size = size;
+	entry->checksum = checksum;
+	entry->has_checksum = 1;
+	ref_blob(store, hash, size, checksum);
+
+	return;
+}
+
+void remove_manifest_entry(struct Blob_Store *store, struct Manifest_Data *manifest, const char *save_path)
+{
+	struct Manifest_Entry *entry;
+	int i;
+
+	entry = find_manifest_entry(manifest, save_path);
+	if (entry == NULL) {
+		return;
+	}
+
+	unref_blob(store, entry->hash);
+	i = entry - manifest->entries;
+	sceClibMemmove(entry, entry + 1, (manifest->count - i - 1) * sizeof(struct Manifest_Entry));
+	manifest->count--;
+
+	return;
+}
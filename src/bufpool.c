@@ -0,0 +1,124 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <stdlib.h>  // for free()
+#include <malloc.h>  // for memalign()
+#include <vitasdk.h>
+
+#include <bufpool.h>
+
+struct Buffer_Pool_Stats buffer_pool_stats;
+
+static unsigned char *buffer_pool_memory = NULL;
+static unsigned int buffer_pool_free;  // bit per free block
+static SceKernelLwMutexWork buffer_pool_mutex;
+
+
+// one aligned allocation for all blocks, so peak memory is fixed
+void init_buffer_pool(void)
+{
+	if (buffer_pool_memory != NULL) {
+		return;
+	}
+
+	sceClibMemset(&buffer_pool_stats, 0x00, sizeof(buffer_pool_stats));
+	buffer_pool_memory = (unsigned char *)memalign((BUFFER_POOL_ALIGN), (BUFFER_POOL_BLOCKS) * (BUFFER_POOL_BLOCK_SIZE));
+	if (buffer_pool_memory == NULL) {
+		return;
+	}
+	buffer_pool_free = (1U << (BUFFER_POOL_BLOCKS)) - 1;
+	sceKernelCreateLwMutex(&buffer_pool_mutex, "buffer_pool_mutex", 0, 0, NULL);
+
+	return;
+}
+
+void free_buffer_pool(void)
+{
+	if (buffer_pool_memory == NULL) {
+		return;
+	}
+
+	sceKernelDeleteLwMutex(&buffer_pool_mutex);
+	free(buffer_pool_memory);
+	buffer_pool_memory = NULL;
+	buffer_pool_free = 0;
+
+	return;
+}
+
+// returns aligned block of BUFFER_POOL_BLOCK_SIZE bytes
+void *borrow_buffer(void)
+{
+	void *buffer;
+	int i;
+
+	buffer = NULL;
+	if (buffer_pool_memory != NULL) {
+		sceKernelLockLwMutex(&buffer_pool_mutex, 1, NULL);
+		for (i = 0; i < (BUFFER_POOL_BLOCKS); i++) {
+			if (buffer_pool_free & (1U << i)) {
+				buffer_pool_free &= ~(1U << i);
+				buffer = &(buffer_pool_memory[i * (BUFFER_POOL_BLOCK_SIZE)]);
+				break;
+			}
+		}
+		buffer_pool_stats.borrowed++;
+		if (buffer == NULL) {
+			buffer_pool_stats.fallbacks++;
+		} else {
+			buffer_pool_stats.in_use++;
+			if (buffer_pool_stats.in_use > buffer_pool_stats.high_water) {
+				buffer_pool_stats.high_water = buffer_pool_stats.in_use;
+			}
+		}
+		sceKernelUnlockLwMutex(&buffer_pool_mutex, 1);
+	}
+
+	// never fail only because the pool is exhausted
+	if (buffer == NULL) {
+		buffer = memalign((BUFFER_POOL_ALIGN), (BUFFER_POOL_BLOCK_SIZE));
+	}
+
+	return buffer;
+}
+
+void return_buffer(void *buffer)
+{
+	int i;
+
+	if (buffer == NULL) {
+		return;
+	}
+
+	// blocks outside of pool came from fallback
+	if ((buffer_pool_memory == NULL) || ((unsigned char *)buffer < buffer_pool_memory) || ((unsigned char *)buffer >= &(buffer_pool_memory[(BUFFER_POOL_BLOCKS) * (BUFFER_POOL_BLOCK_SIZE)]))) {
+		free(buffer);
+		return;
+	}
+
+	i = ((unsigned char *)buffer - buffer_pool_memory) / (BUFFER_POOL_BLOCK_SIZE);
+	sceKernelLockLwMutex(&buffer_pool_mutex, 1, NULL);
+	buffer_pool_free |= (1U << i);
+	buffer_pool_stats.in_use--;
+	sceKernelUnlockLwMutex(&buffer_pool_mutex, 1);
+
+	return;
+}
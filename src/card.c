@@ -0,0 +1,157 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <vitasdk.h>
+
+#include <account.h>
+#include <blob.h>
+#include <card.h>
+#include <dir.h>
+#include <file.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+const char *const card_folder = "cards/";
+const char *const card_link_file = "id.dat";
+const char *const card_id_file = "data/" VITA_TITLEID "/card.id";
+
+// memory cards whose id.dat links them to an account
+const char *const card_devices[] = {
+	"ux0:",
+	"imc0:",
+	"uma0:",
+};
+
+
+// index of memory card device for an id.dat file entry, -1 for other entries
+int find_card_device(const struct File_Entry *const file_entry)
+{
+	int i;
+
+	if ((file_entry->file_save_path != NULL) || (file_entry->file_path == NULL) || (file_entry->file_name_path == NULL)) {
+		return -1;
+	}
+	if (sceClibStrcmp(file_entry->file_name_path, card_link_file) != 0) {
+		return -1;
+	}
+
+	for (i = 0; i < (sizeof(card_devices) / sizeof(card_devices[0])); i++) {
+		if (sceClibStrcmp(file_entry->file_path, card_devices[i]) == 0) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+// read random id from marker file on card, optionally create it
+int get_card_id(const char *device, char *card_id, int create)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	unsigned long long id;
+	int size;
+	int i;
+
+	path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path, device, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, card_id_file, (MAX_PATH_LENGTH));
+
+	size = read_file(path, card_id, (CARD_ID_SIZE));
+	if (size == (CARD_ID_SIZE)) {
+		card_id[(CARD_ID_SIZE)] = '\0';
+		for (i = 0; i < (CARD_ID_SIZE); i++) {
+			if (!(((card_id[i] >= '0') && (card_id[i] <= '9')) || ((card_id[i] >= 'a') && (card_id[i] <= 'f')))) {
+				break;
+			}
+		}
+		if (i == (CARD_ID_SIZE)) {
+			return 0;
+		}
+	}
+
+	if (!create) {
+		return -1;
+	}
+
+	// new card, mark it with random id
+	sceKernelGetRandomNumber((void *)(&id), sizeof(id));
+	sceClibSnprintf(card_id, (CARD_ID_SIZE)+1, "%016llx", id);
+	create_path(path, sceClibStrnlen(device, (MAX_PATH_LENGTH)), 0);
+	if (write_file(path, card_id, (CARD_ID_SIZE)) != (CARD_ID_SIZE)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+// save path of id.dat in manifest, cards/<card id>/id.dat
+int build_card_save_path(const char *device, char *save_path, int create)
+{
+	char card_id[(CARD_ID_SIZE)+1];
+
+	if (get_card_id(device, card_id, create) < 0) {
+		return -1;
+	}
+
+	save_path[(MANIFEST_PATH_SIZE)] = '\0';
+	sceClibStrncpy(save_path, card_folder, (MANIFEST_PATH_SIZE));
+	sceClibStrncat(save_path, card_id, (MANIFEST_PATH_SIZE));
+	sceClibStrncat(save_path, slash_folder, (MANIFEST_PATH_SIZE));
+	sceClibStrncat(save_path, card_link_file, (MANIFEST_PATH_SIZE));
+
+	return 0;
+}
+
+// store id.dat of each inserted card for current account
+void save_card_links(struct Blob_Store *store, struct Manifest_Data *manifest)
+{
+	char source_path[(MAX_PATH_LENGTH)+1];
+	char save_path[(MANIFEST_PATH_SIZE)+1];
+	unsigned long long hash;
+	unsigned int checksum;
+	int size;
+	int result;
+	int i;
+
+	source_path[(MAX_PATH_LENGTH)] = '\0';
+	for (i = 0; i < (sizeof(card_devices) / sizeof(card_devices[0])); i++) {
+		sceClibStrncpy(source_path, card_devices[i], (MAX_PATH_LENGTH));
+		sceClibStrncat(source_path, card_link_file, (MAX_PATH_LENGTH));
+		if (!check_file_exists(source_path)) {
+			continue;
+		}
+
+		if (build_card_save_path(card_devices[i], save_path, 1) < 0) {
+			printf("\e[1mFailed to mark memory card %s...\e[22m\e[0K\n", card_devices[i]);
+			continue;
+		}
+
+		result = store_blob(store, source_path, &hash, &size, &checksum);
+		if (result < 0) {
+			printf("\e[1mFailed to store %s (0x%08x)...\e[22m\e[0K\n", source_path, result);
+			continue;
+		}
+		printf("\e[2mStored link of memory card %s as %s...\e[22m\e[0K\n", card_devices[i], save_path);
+		set_manifest_entry(store, manifest, save_path, hash, size, checksum);
+	}
+
+	return;
+}
@@ -114,3 +114,131 @@ void free_subdirs(struct Dir_Entry *dirs, int dir_count)
 
 	return;
 }
+
+static int fold_char(int c)
+{
+	if ((c >= 'A') && (c <= 'Z')) {
+		c += 'a' - 'A';
+	}
+
+	return c;
+}
+
+// case-insensitive compare of at most size chars, size < 0 compares complete names
+static int compare_names(const char *name, const char *name2, int size)
+{
+	int c, c2;
+
+	for (; size != 0; size--, name++, name2++) {
+		c = fold_char((unsigned char)*name);
+		c2 = fold_char((unsigned char)*name2);
+		if ((c != c2) || (c == '\0')) {
+			return c - c2;
+		}
+	}
+
+	return 0;
+}
+
+static int compare_dirs(const void *dir, const void *dir2)
+{
+	int result;
+
+	result = compare_names(((const struct Dir_Entry *)dir)->name, ((const struct Dir_Entry *)dir2)->name, -1);
+	if (result == 0) {
+		result = sceClibStrcmp(((const struct Dir_Entry *)dir)->name, ((const struct Dir_Entry *)dir2)->name);
+	}
+
+	return result;
+}
+
+void sort_subdirs(struct Dir_Entry *dirs, int dir_count)
+{
+	if ((dirs == NULL) || (dir_count < 2)) {
+		return;
+	}
+
+	qsort(dirs, dir_count, sizeof(struct Dir_Entry), compare_dirs);
+
+	return;
+}
+
+// binary search in sorted entries for first name starting with prefix (or behind it when after is set)
+int find_subdir_prefix(const struct Dir_Entry *const dirs, int dir_count, const char *prefix, int size_prefix, int after)
+{
+	int low, high, middle;
+	int result;
+
+	low = 0;
+	high = dir_count;
+	while (low < high) {
+		middle = low + ((high - low) / 2);
+		result = compare_names(dirs[middle].name, prefix, size_prefix);
+		if ((result < 0) || (after && (result == 0))) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+// index of first entry of next (direction > 0) or current/previous group, entries are grouped by their first size chars
+int find_subdir_group(const struct Dir_Entry *const dirs, int dir_count, int index, int size, int direction)
+{
+	int first;
+
+	if ((dir_count <= 0) || (index < 0) || (index >= dir_count)) {
+		return index;
+	}
+
+	if (direction > 0) {
+		first = find_subdir_prefix(dirs, dir_count, dirs[index].name, size, 1);
+		if (first >= dir_count) {
+			first = index;
+		}
+	} else {
+		first = find_subdir_prefix(dirs, dir_count, dirs[index].name, size, 0);
+		if ((first == index) && (index > 0)) {
+			first = find_subdir_prefix(dirs, dir_count, dirs[index - 1].name, size, 0);
+		}
+	}
+
+	return first;
+}
+
+void init_dir_filter(struct Dir_Filter *filter, struct Dir_Entry *dirs, int dir_count)
+{
+	filter->dirs = dirs;
+	filter->dir_count = dir_count;
+	set_dir_filter_prefix(filter, NULL, 0);
+
+	return;
+}
+
+void set_dir_filter_prefix(struct Dir_Filter *filter, const char *prefix, int size_prefix)
+{
+	if ((prefix == NULL) || (size_prefix < 0)) {
+		size_prefix = 0;
+	}
+	if (size_prefix > (DIR_PREFIX_SIZE)) {
+		size_prefix = (DIR_PREFIX_SIZE);
+	}
+	if (size_prefix > 0) {
+		sceClibMemmove(filter->prefix, prefix, size_prefix);
+	}
+	filter->prefix[size_prefix] = '\0';
+	filter->size_prefix = size_prefix;
+
+	// matching entries are a contiguous range of the sorted list
+	if (size_prefix == 0) {
+		filter->first = 0;
+		filter->count = filter->dir_count;
+	} else {
+		filter->first = find_subdir_prefix(filter->dirs, filter->dir_count, filter->prefix, size_prefix, 0);
+		filter->count = find_subdir_prefix(filter->dirs, filter->dir_count, filter->prefix, size_prefix, 1) - filter->first;
+	}
+
+	return;
+}
@@ -18,9 +18,44 @@
 
 #include <vitasdk.h>
 #include <stdlib.h> // for malloc(), free()
-#include <malloc.h> // for memalign()
 
+#include <bufpool.h>
 #include <file.h>
+#include <hash.h>
+
+// bytes written by copy loops, for progress display
+volatile unsigned int file_bytes_copied = 0;
+
+void init_scratch_arena(struct Scratch_Arena *arena, void *buffer, int size) {
+  arena->base = (char *)buffer;
+  arena->size = size;
+  arena->used = 0;
+}
+
+// Read a whole file into caller-supplied scratch memory, no heap allocation
+int arena_read_file(struct Scratch_Arena *arena, const char *file, void **buffer_ptr) {
+  SceIoStat stat;
+  int offset;
+
+  memset(&stat, 0, sizeof(SceIoStat));
+  int res = sceIoGetstat(file, &stat);
+  if (res < 0)
+    return res;
+
+  // keep allocations 8-byte aligned
+  offset = (arena->used + 7) & ~7;
+  if ((stat.st_size < 0) || (stat.st_size > (arena->size - offset)))
+    return -1;
+
+  int read = read_file(file, arena->base + offset, (int)stat.st_size);
+  if (read < 0)
+    return read;
+
+  *buffer_ptr = arena->base + offset;
+  arena->used = offset + read;
+
+  return read;
+}
 
 int allocate_read_file(const char *file, void **buffer_ptr) {
   SceUID fd = sceIoOpen(file, SCE_O_RDONLY, 0);
@@ -42,6 +77,34 @@ int allocate_read_file(const char *file, void **buffer_ptr) {
   return read;
 }
 
+// Read a whole file into a pool block when it fits, else into heap memory, release with return_buffer()
+int borrow_read_file(const char *file, void **buffer_ptr) {
+  SceUID fd = sceIoOpen(file, SCE_O_RDONLY, 0);
+  if (fd < 0)
+    return fd;
+
+  int size = sceIoLseek32(fd, 0, SCE_SEEK_END);
+  sceIoLseek32(fd, 0, SCE_SEEK_SET);
+
+  if (size <= BUFFER_POOL_BLOCK_SIZE)
+    *buffer_ptr = borrow_buffer();
+  else
+    *buffer_ptr = malloc(size);
+  if (!*buffer_ptr) {
+    sceIoClose(fd);
+    return -1;
+  }
+
+  int read = sceIoRead(fd, *buffer_ptr, size);
+  sceIoClose(fd);
+  if (read < 0) {
+    return_buffer(*buffer_ptr);
+    *buffer_ptr = NULL;
+  }
+
+  return read;
+}
+
 int read_file(const char *file, void *buf, int size) {
   SceUID fd = sceIoOpen(file, SCE_O_RDONLY, 0);
   if (fd < 0)
@@ -53,6 +116,24 @@ int read_file(const char *file, void *buf, int size) {
   return read;
 }
 
+// Copy next line of text buffer without line break, cut to size chars, -1 at end of buffer
+int read_text_line(const char **pos_ptr, const char *end, char *line, int size) {
+  const char *pos = *pos_ptr;
+  if (pos >= end)
+    return -1;
+
+  int len = 0;
+  while ((pos < end) && (*pos != '\n')) {
+    if ((*pos != '\r') && (len < size))
+      line[len++] = *pos;
+    pos++;
+  }
+  line[len] = '\0';
+  *pos_ptr = pos + 1;
+
+  return len;
+}
+
 int write_file(const char *file, const void *buf, int size) {
   SceUID fd = sceIoOpen(file, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
   if (fd < 0)
@@ -93,7 +174,24 @@ int check_folder_exists(const char *folder) {
   return 1;
 }
 
-int copy_file(const char *src_path, const char *dst_path) {
+static int copy_codec_read(void *context, int fd, void *buf) {
+  return sceIoRead(fd, buf, TRANSFER_SIZE);
+}
+
+static int copy_codec_write(void *context, int fd, const void *buf, int size) {
+  if (size == 0)
+    return 0;
+
+  int written = sceIoWrite(fd, buf, size);
+
+  // A partial write fails the copy as well
+  if (written != size)
+    return (written < 0) ? written : -3;
+
+  return size;
+}
+
+int copy_file_codec(const char *src_path, const char *dst_path, unsigned int *checksum_ptr, const struct Copy_Codec *codec, void *context) {
   // The source and destination paths are identical
   if (strcasecmp(src_path, dst_path) == 0) {
     return -1;
@@ -105,50 +203,83 @@ int copy_file(const char *src_path, const char *dst_path) {
     return -2;
   }
 
+  // Hooks left out copy plain bytes
+  int (*read_start)(void *, int) = NULL;
+  int (*write_start)(void *, int) = NULL;
+  int (*read_hook)(void *, int, void *) = copy_codec_read;
+  int (*write_hook)(void *, int, const void *, int) = copy_codec_write;
+  if (codec != NULL) {
+    read_start = codec->read_start;
+    write_start = codec->write_start;
+    if (codec->read != NULL)
+      read_hook = codec->read;
+    if (codec->write != NULL)
+      write_hook = codec->write;
+  }
+
   SceUID fdsrc = sceIoOpen(src_path, SCE_O_RDONLY, 0);
   if (fdsrc < 0)
     return fdsrc;
 
+  // Check the source format before the destination is touched
+  if (read_start != NULL) {
+    int res = read_start(context, fdsrc);
+    if (res < 0) {
+      sceIoClose(fdsrc);
+      return res;
+    }
+  }
+
   SceUID fddst = sceIoOpen(dst_path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
   if (fddst < 0) {
     sceIoClose(fdsrc);
     return fddst;
   }
 
-  void *buf = memalign(4096, TRANSFER_SIZE);
+  void *buf = borrow_buffer();
 
-  while (1) {
-    int read = sceIoRead(fdsrc, buf, TRANSFER_SIZE);
+  // Checksum of the copied bytes, computed while copying
+  struct Hash_Xxh32_State checksum;
+  hash_xxh32_init(&checksum);
 
-    if (read < 0) {
-      free(buf);
-
-      sceIoClose(fddst);
-      sceIoClose(fdsrc);
+  int res = 0;
+  if (write_start != NULL)
+    res = write_start(context, fddst);
 
-      sceIoRemove(dst_path);
-
-      return read;
+  // The codec reads the next raw bytes into buf and writes them out, 0 bytes are passed once at the end of the source
+  while (res >= 0) {
+    int read = read_hook(context, fdsrc, buf);
+    if (read < 0) {
+      res = read;
+      break;
     }
 
+    res = write_hook(context, fddst, buf, read);
+    if (res < 0)
+      break;
+
     if (read == 0)
       break;
 
-    int written = sceIoWrite(fddst, buf, read);
+    if (checksum_ptr != NULL)
+      hash_xxh32_update(&checksum, buf, read);
+
+    file_bytes_copied += read;
+  }
 
-    if (written < 0) {
-      free(buf);
+  return_buffer(buf);
 
-      sceIoClose(fddst);
-      sceIoClose(fdsrc);
+  if (res < 0) {
+    sceIoClose(fddst);
+    sceIoClose(fdsrc);
 
-      sceIoRemove(dst_path);
+    sceIoRemove(dst_path);
 
-      return written;
-    }
+    return res;
   }
 
-  free(buf);
+  if (checksum_ptr != NULL)
+    *checksum_ptr = hash_xxh32_digest(&checksum);
 
   // Inherit file stat
   SceIoStat stat;
@@ -161,3 +292,7 @@ int copy_file(const char *src_path, const char *dst_path) {
 
   return 1;
 }
+
+int copy_file(const char *src_path, const char *dst_path, unsigned int *checksum_ptr) {
+  return copy_file_codec(src_path, dst_path, checksum_ptr, NULL, NULL);
+}
@@ -0,0 +1,227 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <vitasdk.h>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <bufpool.h>
+#include <file.h>
+#include <hash.h>
+
+#define HASH_FNV1A64_PRIME 0x00000100000001b3ULL
+
+#define HASH_XXH32_PRIME1 2654435761U
+#define HASH_XXH32_PRIME2 2246822519U
+#define HASH_XXH32_PRIME3 3266489917U
+#define HASH_XXH32_PRIME4 668265263U
+#define HASH_XXH32_PRIME5 374761393U
+#define HASH_XXH32_ROTL(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+
+unsigned long long hash_fnv1a64_update(unsigned long long hash, const void *data, int size)
+{
+	const unsigned char *bytes;
+	int i;
+
+	bytes = (const unsigned char *)data;
+	for (i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= (HASH_FNV1A64_PRIME);
+	}
+
+	return hash;
+}
+
+static inline unsigned int read_le32(const unsigned char *data)
+{
+	return (data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)(data[3]) << 24));
+}
+
+#if defined(__ARM_NEON)
+// the four accumulators are independent lanes, one vector round per 16 byte stripe
+static void hash_xxh32_stripes(unsigned int *acc, const unsigned char *data, int count)
+{
+	uint32x4_t vacc;
+	uint32x4_t lanes;
+	const uint32x4_t prime2 = vdupq_n_u32(HASH_XXH32_PRIME2);
+
+	vacc = vld1q_u32(acc);
+	while (count-- > 0) {
+		lanes = vreinterpretq_u32_u8(vld1q_u8(data));
+		vacc = vmlaq_u32(vacc, lanes, prime2);
+		vacc = vsriq_n_u32(vshlq_n_u32(vacc, 13), vacc, 19);
+		vacc = vmulq_n_u32(vacc, HASH_XXH32_PRIME1);
+		data += 16;
+	}
+	vst1q_u32(acc, vacc);
+
+	return;
+}
+#else
+static void hash_xxh32_stripes(unsigned int *acc, const unsigned char *data, int count)
+{
+	int i;
+
+	while (count-- > 0) {
+		for (i = 0; i < 4; i++) {
+			acc[i] += read_le32(&(data[i * 4])) * (HASH_XXH32_PRIME2);
+			acc[i] = HASH_XXH32_ROTL(acc[i], 13) * (HASH_XXH32_PRIME1);
+		}
+		data += 16;
+	}
+
+	return;
+}
+#endif
+
+void hash_xxh32_init(struct Hash_Xxh32_State *state)
+{
+	state->acc[0] = (HASH_XXH32_PRIME1) + (HASH_XXH32_PRIME2);
+	state->acc[1] = (HASH_XXH32_PRIME2);
+	state->acc[2] = 0;
+	state->acc[3] = 0U - (HASH_XXH32_PRIME1);
+	state->total = 0;
+	state->buffered = 0;
+
+	return;
+}
+
+void hash_xxh32_update(struct Hash_Xxh32_State *state, const void *data, int size)
+{
+	const unsigned char *bytes;
+	int count;
+
+	bytes = (const unsigned char *)data;
+	state->total += size;
+
+	// complete buffered stripe first
+	if (state->buffered > 0) {
+		count = 16 - state->buffered;
+		if (count > size) {
+			count = size;
+		}
+		sceClibMemcpy(&(state->buffer[state->buffered]), bytes, count);
+		state->buffered += count;
+		bytes += count;
+		size -= count;
+		if (state->buffered < 16) {
+			return;
+		}
+		hash_xxh32_stripes(state->acc, state->buffer, 1);
+		state->buffered = 0;
+	}
+
+	// full stripes directly from data, keep the rest
+	count = size / 16;
+	if (count > 0) {
+		hash_xxh32_stripes(state->acc, bytes, count);
+		bytes += count * 16;
+		size -= count * 16;
+	}
+	if (size > 0) {
+		sceClibMemcpy(state->buffer, bytes, size);
+		state->buffered = size;
+	}
+
+	return;
+}
+
+unsigned int hash_xxh32_digest(const struct Hash_Xxh32_State *const state)
+{
+	unsigned int hash;
+	int i;
+
+	if (state->total >= 16) {
+		hash = HASH_XXH32_ROTL(state->acc[0], 1) + HASH_XXH32_ROTL(state->acc[1], 7) + HASH_XXH32_ROTL(state->acc[2], 12) + HASH_XXH32_ROTL(state->acc[3], 18);
+	} else {
+		hash = (HASH_XXH32_PRIME5);
+	}
+	hash += (unsigned int)(state->total);
+
+	// buffered tail: words, then bytes
+	for (i = 0; (i + 4) <= state->buffered; i += 4) {
+		hash += read_le32(&(state->buffer[i])) * (HASH_XXH32_PRIME3);
+		hash = HASH_XXH32_ROTL(hash, 17) * (HASH_XXH32_PRIME4);
+	}
+	for (; i < state->buffered; i++) {
+		hash += state->buffer[i] * (HASH_XXH32_PRIME5);
+		hash = HASH_XXH32_ROTL(hash, 11) * (HASH_XXH32_PRIME1);
+	}
+
+	// avalanche
+	hash ^= hash >> 15;
+	hash *= (HASH_XXH32_PRIME2);
+	hash ^= hash >> 13;
+	hash *= (HASH_XXH32_PRIME3);
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+int hash_file(const char *file, unsigned long long *hash_ptr, unsigned int *checksum_ptr)
+{
+	SceUID fd;
+	void *buf;
+	int read;
+	int size;
+	unsigned long long hash;
+	struct Hash_Xxh32_State checksum;
+
+	fd = sceIoOpen(file, SCE_O_RDONLY, 0);
+	if (fd < 0) {
+		return fd;
+	}
+
+	buf = borrow_buffer();
+	if (buf == NULL) {
+		sceIoClose(fd);
+		return -1;
+	}
+
+	// hash file content chunk by chunk, checksum in the same pass
+	hash = (HASH_FNV1A64_INIT);
+	hash_xxh32_init(&checksum);
+	size = 0;
+	while ((read = sceIoRead(fd, buf, (TRANSFER_SIZE))) > 0) {
+		hash = hash_fnv1a64_update(hash, buf, read);
+		if (checksum_ptr != NULL) {
+			hash_xxh32_update(&checksum, buf, read);
+		}
+		size += read;
+	}
+
+	return_buffer(buf);
+	sceIoClose(fd);
+
+	if (read < 0) {
+		return read;
+	}
+
+	if (hash_ptr != NULL) {
+		*hash_ptr = hash;
+	}
+	if (checksum_ptr != NULL) {
+		*checksum_ptr = hash_xxh32_digest(&checksum);
+	}
+
+	return size;
+}
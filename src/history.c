@@ -17,22 +17,27 @@
   along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <stdlib.h>  // for malloc(), free(), qsort()
 #include <vitasdk.h>
 
+#include <bufpool.h>
 #include <main.h>
+#include <dir.h>
 #include <file.h>
 #include <history.h>
+#include <settings.h>
+#include <worker.h>
 
 #include <debugScreen.h>
 #define printf psvDebugScreenPrintf
 
 struct History_Entry execution_history_entries[] = {
-	{ "ur0:ci/file/", "m.log", 0, 0, },
-	{ "ur0:user/00/shell/playlog/", "playlod.dat", 0, 0, },
-	{ "ur0:user/00/shell/playlog/", "playlog.dat", 0, 0, },
-	{ "ur0:user/00/shell/playlog/", "playlog.dat.tmp", 0, 0, },
-	{ "vd0:history/", "data.bak", 0, 0, },
-	{ "vd0:history/", "data.bin", 0, 0, },
+	{ "ur0:ci/file/", "m.log", 1, 0, 0, },
+	{ "ur0:user/00/shell/playlog/", "playlod.dat", 0, 0, 0, },
+	{ "ur0:user/00/shell/playlog/", "playlog.dat", 0, 0, 0, },
+	{ "ur0:user/00/shell/playlog/", "playlog.dat.tmp", 0, 0, 0, },
+	{ "vd0:history/", "data.bak", 0, 0, 0, },
+	{ "vd0:history/", "data.bin", 0, 0, 0, },
 };
 
 struct History_Data execution_history_data = {
@@ -41,6 +46,220 @@ struct History_Data execution_history_data = {
 	.entries = execution_history_entries,
 };
 
+// title ID prefixes of official games/apps and system software
+const char *const official_title_prefixes[] = {
+	"PCS",
+	"NP",
+};
+
+
+static int compare_title_ids(const void *a, const void *b)
+{
+	return sceClibMemcmp(a, b, (TITLE_ID_SIZE));
+}
+
+static int is_official_title_id(const char *title_id)
+{
+	int i;
+	int size;
+
+	for (i = 0; i < (int)(sizeof(official_title_prefixes) / sizeof(official_title_prefixes[0])); i++) {
+		size = sceClibStrnlen(official_title_prefixes[i], (TITLE_ID_SIZE));
+		if (sceClibStrncmp(title_id, official_title_prefixes[i], size) == 0) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void add_title_filter_id(struct Title_Filter *filter, const char *title_id)
+{
+	sceClibMemcpy(filter->ids[filter->count], title_id, (TITLE_ID_SIZE));
+	filter->first_chars[((unsigned char)title_id[0]) >> 3] |= (1 << (((unsigned char)title_id[0]) & 7));
+	filter->count++;
+
+	return;
+}
+
+// build sorted set of title IDs of installed homebrew incl. this app
+int load_homebrew_title_filter(struct Title_Filter *filter)
+{
+	int i;
+	int dir_count;
+	struct Dir_Entry *dirs;
+
+	filter->count = 0;
+	filter->ids = NULL;
+	sceClibMemset(filter->first_chars, 0, sizeof(filter->first_chars));
+
+	dir_count = get_subdirs("ux0:app/", &dirs);
+	if (dir_count < 0) {
+		dir_count = 0;
+		dirs = NULL;
+	}
+
+	filter->ids = malloc((dir_count + 1) * (TITLE_ID_SIZE));
+	if (filter->ids == NULL) {
+		free_subdirs(dirs, dir_count);
+		return -1;
+	}
+
+	add_title_filter_id(filter, VITA_TITLEID);
+	for (i = 0; i < dir_count; i++) {
+		if ((dirs[i].size != (TITLE_ID_SIZE)) || is_official_title_id(dirs[i].name) || (sceClibStrncmp(dirs[i].name, VITA_TITLEID, (TITLE_ID_SIZE)) == 0)) {
+			continue;
+		}
+		add_title_filter_id(filter, dirs[i].name);
+	}
+	free_subdirs(dirs, dir_count);
+
+	qsort(filter->ids, filter->count, (TITLE_ID_SIZE), compare_title_ids);
+
+	return filter->count;
+}
+
+void free_title_filter(struct Title_Filter *filter)
+{
+	free(filter->ids);
+	filter->ids = NULL;
+	filter->count = 0;
+
+	return;
+}
+
+static int find_title_id(const struct Title_Filter *const filter, const char *data)
+{
+	int low;
+	int high;
+	int middle;
+	int result;
+
+	if (!(filter->first_chars[((unsigned char)data[0]) >> 3] & (1 << (((unsigned char)data[0]) & 7)))) {
+		return 0;
+	}
+
+	low = 0;
+	high = filter->count - 1;
+	while (low <= high) {
+		middle = (low + high) / 2;
+		result = sceClibMemcmp(data, filter->ids[middle], (TITLE_ID_SIZE));
+		if (result == 0) {
+			return 1;
+		} else if (result < 0) {
+			high = middle - 1;
+		} else {
+			low = middle + 1;
+		}
+	}
+
+	return 0;
+}
+
+static int check_title_line(const struct Title_Filter *const filter, const char *line, int size)
+{
+	int i;
+
+	for (i = 0; i <= (size - (TITLE_ID_SIZE)); i++) {
+		if (find_title_id(filter, &line[i])) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// remove lines with filtered title IDs, streamed via temporary file which then replaces the file
+int scrub_mlog_file(const char *file, const struct Title_Filter *const filter)
+{
+	SceUID fdsrc;
+	SceUID fddst;
+	char *buf;
+	char temp_path[(MAX_PATH_LENGTH)+1];
+	int read;
+	int size;
+	int start;
+	int end;
+	int removed;
+	int result;
+
+	temp_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(temp_path, file, (MAX_PATH_LENGTH));
+	sceClibStrncat(temp_path, ".tmp", (MAX_PATH_LENGTH));
+
+	fdsrc = sceIoOpen(file, SCE_O_RDONLY, 0);
+	if (fdsrc < 0) {
+		return fdsrc;
+	}
+
+	fddst = sceIoOpen(temp_path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+	if (fddst < 0) {
+		sceIoClose(fdsrc);
+		return fddst;
+	}
+
+	buf = (char *)borrow_buffer();
+
+	// complete lines are kept or dropped, an incomplete line waits for the next chunk
+	size = 0;
+	removed = 0;
+	result = (buf == NULL) ? -1 : 0;
+	while (result >= 0) {
+		read = sceIoRead(fdsrc, &buf[size], (TRANSFER_SIZE) - size);
+		if (read < 0) {
+			result = read;
+			break;
+		}
+		size += read;
+
+		start = 0;
+		while (start < size) {
+			for (end = start; (end < size) && (buf[end] != '\n'); end++);
+			if ((end == size) && (read > 0)) {
+				break;
+			}
+			if (end < size) {  // keep line end, last line may have none
+				end++;
+			}
+			if (check_title_line(filter, &buf[start], end - start)) {
+				removed++;
+			} else if (sceIoWrite(fddst, &buf[start], end - start) != (end - start)) {
+				result = -1;
+				break;
+			}
+			start = end;
+		}
+
+		// a line longer than a chunk cannot be checked
+		if ((start == 0) && (size == (TRANSFER_SIZE))) {
+			result = -1;
+		}
+		size -= start;
+		sceClibMemmove(buf, &buf[start], size);
+		if (read == 0) {
+			break;
+		}
+	}
+
+	return_buffer(buf);
+	sceIoClose(fddst);
+	sceIoClose(fdsrc);
+
+	if ((result < 0) || (removed == 0)) {
+		sceIoRemove(temp_path);
+		return ((result < 0) ? result : 0);
+	}
+
+	sceIoRemove(file);
+	result = sceIoRename(temp_path, file);
+	if (result < 0) {
+		sceIoRemove(temp_path);
+		return result;
+	}
+
+	return removed;
+}
+
 
 void get_current_execution_history_data(struct History_Data *hist_data)
 {
@@ -110,6 +329,10 @@ void display_execution_history_details(struct History_Data *hist_data, char *tit
 void delete_execution_history(struct History_Data *hist_data, char *title)
 {
 	int i;
+	int count;
+	int deleted;
+	int scrubbed;
+	struct Title_Filter filter;
 	char target_path[(MAX_PATH_LENGTH)+1];
 
 	if (title != NULL) {
@@ -122,6 +345,14 @@ void delete_execution_history(struct History_Data *hist_data, char *title)
 
 	target_path[(MAX_PATH_LENGTH)] = '\0';
 
+	// m.log scrub: line based files lose only records mentioning installed homebrew, others are deleted
+	deleted = 0;
+	scrubbed = 0;
+	filter.ids = NULL;
+	if (app_settings.scrub_mlog) {
+		load_homebrew_title_filter(&filter);
+	}
+
 	// execution history data
 	for (i = 0; i < hist_data->count; i++) {
 		if ((hist_data->entries[i].file_path == NULL) || (hist_data->entries[i].file_name_path == NULL)) {
@@ -136,54 +367,84 @@ void delete_execution_history(struct History_Data *hist_data, char *title)
 		} else if (!check_file_exists(target_path)) {
 			printf("\e[2mSkip missing %s...\e[22m\e[0K\n", target_path);
 		} else {
+			if ((filter.ids != NULL) && (hist_data->entries[i].text_records)) {
+				count = scrub_mlog_file(target_path, &filter);
+				if (count >= 0) {
+					printf("\e[2mRemoved %i homebrew records from %s...\e[22m\e[0K\n", count, target_path);
+					scrubbed++;
+					continue;
+				}
+				printf("\e[1mFailed to scrub %s (0x%08x)...\e[22m\e[0K\n", target_path, count);
+			}
 			printf("\e[2mDeleting %s...\e[22m\e[0K\n", target_path);
 			sceIoRemove(target_path);
+			deleted++;
 		}
 	}
+	free_title_filter(&filter);
 
 	if (title != NULL) {
-		printf("Execution history deleted!\nReboot to also clear list in memory!\e[0K\n");
+		if (scrubbed > 0) {
+			printf("Execution history: %i files deleted, %i scrubbed of homebrew records!\nReboot to also clear list in memory!\e[0K\n", deleted, scrubbed);
+		} else {
+			printf("Execution history deleted!\nReboot to also clear list in memory!\e[0K\n");
+		}
 		wait_for_cancel_button();
 	}
 
 	return;
 }
 
-void protect_execution_history_files(struct History_Data *hist_data, char *title)
+static int protect_history_file_step(void *context, int index)
 {
-	int i;
+	struct History_Data *hist_data;
 	char target_path[(MAX_PATH_LENGTH)+1];
 
-	// draw title line
-	draw_title_line(title);
-
-	// draw pixel line
-	draw_pixel_line(NULL, NULL);
+	hist_data = (struct History_Data *)context;
+	if ((hist_data->entries[index].file_path == NULL) || (hist_data->entries[index].file_name_path == NULL)) {
+		return 0;
+	}
 
 	target_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(target_path, hist_data->entries[index].file_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(target_path, hist_data->entries[index].file_name_path, (MAX_PATH_LENGTH));
 
-	// protect execution history files
-	for (i = 0; i < hist_data->count; i++) {
-		if ((hist_data->entries[i].file_path == NULL) || (hist_data->entries[i].file_name_path == NULL)) {
-			continue;
+	if (check_folder_exists(target_path)) {
+		printf("\e[2mSkip protected %s...\e[22m\e[0K\n", target_path);
+	} else {
+		if (check_file_exists(target_path)) {
+			printf("\e[2mDeleting %s...\e[22m\e[0K\n", target_path);
+			sceIoRemove(target_path);
 		}
+		printf("\e[2mCreating directory %s...\e[22m\e[0K\n", target_path);
+		sceIoMkdir(target_path, 0006);
+	}
 
-		sceClibStrncpy(target_path, hist_data->entries[i].file_path, (MAX_PATH_LENGTH));
-		sceClibStrncat(target_path, hist_data->entries[i].file_name_path, (MAX_PATH_LENGTH));
+	return 0;
+}
 
-		if (check_folder_exists(target_path)) {
-			printf("\e[2mSkip protected %s...\e[22m\e[0K\n", target_path);
-		} else {
-			if (check_file_exists(target_path)) {
-				printf("\e[2mDeleting %s...\e[22m\e[0K\n", target_path);
-				sceIoRemove(target_path);
-			}
-			printf("\e[2mCreating directory %s...\e[22m\e[0K\n", target_path);
-			sceIoMkdir(target_path, 0006);
-		}
-	}
+void protect_execution_history_files(struct History_Data *hist_data, char *title)
+{
+	struct Worker_Job job;
 
-	printf("Execution history files deleted and protected!\nReboot to also clear list in memory!\e[0K\n");
+	// draw title line
+	draw_title_line(title);
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
+
+	// protect execution history files on worker thread
+	job.count = hist_data->count;
+	job.total_bytes = 0;
+	job.context = (void *)hist_data;
+	job.run_step = protect_history_file_step;
+	job.commit_step = job.count;
+	run_worker_job(&job);
+	if (job.cancelled > 0) {
+		printf("\e[1mProtecting cancelled, %i files not protected!\e[22m\e[0K\n", job.cancelled);
+	} else {
+		printf("Execution history files deleted and protected!\nReboot to also clear list in memory!\e[0K\n");
+	}
 	wait_for_cancel_button();
 
 	return;
@@ -0,0 +1,173 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <vitasdk.h>
+
+#include <listview.h>
+#include <main.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+
+void init_list_view(struct List_View *view, int x, int y, int count, List_View_Draw_Row draw_row, void *context)
+{
+	view->x = x;
+	view->y = y;
+	view->rows = ((SCREEN_HEIGHT) - y + 1) / psv_font_current->size_h;
+	if (view->rows > (LIST_VIEW_MAX_ROWS)) {
+		view->rows = (LIST_VIEW_MAX_ROWS);
+	}
+	if (view->rows < 1) {
+		view->rows = 1;
+	}
+	view->count = count;
+	view->top = 0;
+	view->cursor = 0;
+	view->draw_row = draw_row;
+	view->context = context;
+	invalidate_list_view(view);
+
+	return;
+}
+
+void invalidate_list_view(struct List_View *view)
+{
+	int row;
+
+	for (row = 0; row < view->rows; row++) {
+		view->drawn_index[row] = -2;
+	}
+	view->drawn_cursor = -1;
+
+	return;
+}
+
+void invalidate_list_row(struct List_View *view, int index)
+{
+	int row;
+
+	row = index - view->top;
+	if ((row >= 0) && (row < view->rows)) {
+		view->drawn_index[row] = -2;
+	}
+
+	return;
+}
+
+static void scroll_to_cursor(struct List_View *view)
+{
+	// keep cursor visible, moving the window as little as possible
+	if (view->cursor < view->top) {
+		view->top = view->cursor;
+	} else if (view->cursor >= (view->top + view->rows)) {
+		view->top = view->cursor - view->rows + 1;
+	}
+	if (view->top > (view->count - view->rows)) {
+		view->top = view->count - view->rows;
+	}
+	if (view->top < 0) {
+		view->top = 0;
+	}
+
+	return;
+}
+
+void set_list_view_count(struct List_View *view, int count)
+{
+	view->count = count;
+	set_list_view_cursor(view, view->cursor);
+
+	return;
+}
+
+void set_list_view_cursor(struct List_View *view, int cursor)
+{
+	if (cursor >= view->count) {
+		cursor = view->count - 1;
+	}
+	if (cursor < 0) {
+		cursor = 0;
+	}
+	view->cursor = cursor;
+	scroll_to_cursor(view);
+
+	return;
+}
+
+int handle_list_view_key(struct List_View *view, int button_pressed)
+{
+	// up/down scroll by one entry, L/R by one page
+	if (button_pressed == SCE_CTRL_DOWN) {
+		set_list_view_cursor(view, view->cursor + 1);
+	} else if (button_pressed == SCE_CTRL_UP) {
+		set_list_view_cursor(view, view->cursor - 1);
+	} else if (button_pressed == SCE_CTRL_RTRIGGER) {
+		view->top += view->rows;
+		set_list_view_cursor(view, view->cursor + view->rows);
+	} else if (button_pressed == SCE_CTRL_LTRIGGER) {
+		view->top -= view->rows;
+		set_list_view_cursor(view, view->cursor - view->rows);
+	} else {
+		return 0;
+	}
+
+	return 1;
+}
+
+void draw_list_view(struct List_View *view)
+{
+	int row;
+	int index;
+	int x, y;
+
+	for (row = 0; row < view->rows; row++) {
+		index = view->top + row;
+		if (index >= view->count) {
+			index = -1;
+		}
+
+		x = view->x;
+		y = view->y + (row * psv_font_current->size_h);
+
+		// repaint row when a different entry is shown there
+		if (view->drawn_index[row] != index) {
+			psvDebugScreenSetCoordsXY(&x, &y);
+			if (index < 0) {
+				printf("\e[0K");
+			} else {
+				printf("%c", ((index == view->cursor) ? '>' : ' '));
+				view->draw_row(view->context, index);
+				printf("\e[0m\e[0K");
+			}
+			view->drawn_index[row] = index;
+			continue;
+		}
+
+		// otherwise only the marker cell may have changed
+		if ((index >= 0) && ((index == view->cursor) != (index == view->drawn_cursor))) {
+			psvDebugScreenSetCoordsXY(&x, &y);
+			printf("%c", ((index == view->cursor) ? '>' : ' '));
+		}
+	}
+	view->drawn_cursor = view->cursor;
+
+	return;
+}
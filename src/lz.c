@@ -0,0 +1,376 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>  // for malloc(), free()
+#include <vitasdk.h>
+
+#include <bufpool.h>
+#include <common.h>
+#include <file.h>
+#include <hash.h>
+#include <lz.h>
+
+#define LZ_MIN_MATCH 4
+#define LZ_LAST_LITERALS 5
+#define LZ_MF_LIMIT 12
+#define LZ_MAX_OFFSET 65535
+
+// input and output blocks are borrowed from buffer pool
+#if (LZ_BLOCK_BOUND(LZ_BLOCK_SIZE)) > (BUFFER_POOL_BLOCK_SIZE)
+#error LZ blocks must fit into buffer pool blocks
+#endif
+
+const char lz_magic[4] = { 'V', 'A', 'M', 'Z', };
+
+struct Lz_Block_Header {
+	unsigned int raw_size;  // 0 = end of stream
+	unsigned int packed_size;  // same as raw size = stored uncompressed
+};
+
+
+static unsigned int lz_hash(const unsigned char *p)
+{
+	unsigned int value;
+
+	value = p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)(p[3]) << 24);
+
+	return (value * 2654435761U) >> (32 - (LZ_HASH_BITS));
+}
+
+static int lz_write_length(unsigned char *dst, int op, int dst_capacity, int length)
+{
+	while (length >= 255) {
+		if (op >= dst_capacity) {
+			return -1;
+		}
+		dst[op++] = 255;
+		length -= 255;
+	}
+	if (op >= dst_capacity) {
+		return -1;
+	}
+	dst[op++] = (unsigned char)length;
+
+	return op;
+}
+
+static int lz_write_sequence(unsigned char *dst, int op, int dst_capacity, const unsigned char *literals, int literal_length, int offset, int match_length)
+{
+	int token;
+
+	if (op >= dst_capacity) {
+		return -1;
+	}
+
+	// token: literal length (high nibble) and match length (low nibble)
+	token = (min(literal_length, 15) << 4);
+	if (match_length > 0) {
+		token |= min(match_length - (LZ_MIN_MATCH), 15);
+	}
+	dst[op++] = (unsigned char)token;
+	if ((literal_length >= 15) && ((op = lz_write_length(dst, op, dst_capacity, literal_length - 15)) < 0)) {
+		return -1;
+	}
+
+	// literals
+	if ((op + literal_length) > dst_capacity) {
+		return -1;
+	}
+	sceClibMemcpy(&(dst[op]), literals, literal_length);
+	op += literal_length;
+
+	// last sequence has no match
+	if (match_length <= 0) {
+		return op;
+	}
+
+	// match offset (little endian) and length
+	if ((op + 2) > dst_capacity) {
+		return -1;
+	}
+	dst[op++] = (unsigned char)(offset);
+	dst[op++] = (unsigned char)(offset >> 8);
+	if ((match_length - (LZ_MIN_MATCH)) >= 15) {
+		op = lz_write_length(dst, op, dst_capacity, match_length - (LZ_MIN_MATCH) - 15);
+	}
+
+	return op;
+}
+
+int lz_compress_block(const unsigned char *src, int src_size, unsigned char *dst, int dst_capacity, unsigned short *hash_table)
+{
+	int ip;
+	int op;
+	int anchor;
+	int ref;
+	int length;
+	int max_length;
+	unsigned int h;
+
+	if ((src_size < 0) || (src_size > (LZ_BLOCK_SIZE))) {
+		return -1;
+	}
+
+	sceClibMemset(hash_table, 0x00, (1 << (LZ_HASH_BITS)) * sizeof(unsigned short));
+
+	ip = 0;
+	op = 0;
+	anchor = 0;
+	while (ip <= (src_size - (LZ_MF_LIMIT))) {
+		h = lz_hash(&(src[ip]));
+		ref = hash_table[h];
+		hash_table[h] = (unsigned short)ip;
+
+		if ((ref >= ip) || ((ip - ref) > (LZ_MAX_OFFSET)) || (sceClibMemcmp(&(src[ref]), &(src[ip]), (LZ_MIN_MATCH)) != 0)) {
+			ip++;
+			continue;
+		}
+
+		// extend match, keep last literals for the end of block
+		length = (LZ_MIN_MATCH);
+		max_length = src_size - (LZ_LAST_LITERALS) - ip;
+		while ((length < max_length) && (src[ref + length] == src[ip + length])) {
+			length++;
+		}
+
+		op = lz_write_sequence(dst, op, dst_capacity, &(src[anchor]), ip - anchor, ip - ref, length);
+		if (op < 0) {
+			return -1;
+		}
+		ip += length;
+		anchor = ip;
+	}
+
+	// last literals
+	op = lz_write_sequence(dst, op, dst_capacity, &(src[anchor]), src_size - anchor, 0, 0);
+
+	return op;
+}
+
+int lz_decompress_block(const unsigned char *src, int src_size, unsigned char *dst, int dst_capacity)
+{
+	int ip;
+	int op;
+	int token;
+	int length;
+	int offset;
+
+	ip = 0;
+	op = 0;
+	while (ip < src_size) {
+		token = src[ip++];
+
+		// literals
+		length = (token >> 4);
+		if (length == 15) {
+			do {
+				if (ip >= src_size) {
+					return -1;
+				}
+				length += src[ip];
+			} while (src[ip++] == 255);
+		}
+		if (((ip + length) > src_size) || ((op + length) > dst_capacity)) {
+			return -1;
+		}
+		sceClibMemcpy(&(dst[op]), &(src[ip]), length);
+		ip += length;
+		op += length;
+
+		// last sequence has no match
+		if (ip >= src_size) {
+			break;
+		}
+
+		// match
+		if ((ip + 2) > src_size) {
+			return -1;
+		}
+		offset = src[ip] | (src[ip + 1] << 8);
+		ip += 2;
+		length = (token & 0x0f);
+		if (length == 15) {
+			do {
+				if (ip >= src_size) {
+					return -1;
+				}
+				length += src[ip];
+			} while (src[ip++] == 255);
+		}
+		length += (LZ_MIN_MATCH);
+		if ((offset <= 0) || (offset > op) || ((op + length) > dst_capacity)) {
+			return -1;
+		}
+		// byte-wise copy, as matches may overlap
+		while (length-- > 0) {
+			dst[op] = dst[op - offset];
+			op++;
+		}
+	}
+
+	return op;
+}
+
+struct Lz_Copy_Context {
+	unsigned char *block_buf;  // compressed block
+	unsigned short *hash_table;
+};
+
+static int lz_check_magic(void *context, int fd)
+{
+	char magic[sizeof(lz_magic)];
+
+	if ((sceIoRead(fd, magic, sizeof(magic)) != sizeof(magic)) || (sceClibMemcmp(magic, lz_magic, sizeof(magic)) != 0)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+static int lz_write_magic(void *context, int fd)
+{
+	return ((sceIoWrite(fd, lz_magic, sizeof(lz_magic)) == sizeof(lz_magic)) ? 0 : -1);
+}
+
+static int lz_read_raw(void *context, int fd, void *buf)
+{
+	return sceIoRead(fd, buf, (LZ_BLOCK_SIZE));
+}
+
+static int lz_write_block(void *context, int fd, const void *buf, int size)
+{
+	struct Lz_Copy_Context *lz_context;
+	struct Lz_Block_Header header;
+	const unsigned char *block;
+	int packed;
+	int result;
+
+	lz_context = (struct Lz_Copy_Context *)context;
+
+	// compress block, store uncompressed if it does not shrink, empty block ends stream
+	header.raw_size = size;
+	header.packed_size = size;
+	block = (const unsigned char *)buf;
+	if (size > 0) {
+		packed = lz_compress_block((const unsigned char *)buf, size, lz_context->block_buf, LZ_BLOCK_BOUND(LZ_BLOCK_SIZE), lz_context->hash_table);
+		if ((packed > 0) && (packed < size)) {
+			header.packed_size = packed;
+			block = lz_context->block_buf;
+		}
+	}
+
+	// a partial write fails the copy as well
+	result = sceIoWrite(fd, &header, sizeof(header));
+	if ((result == sizeof(header)) && (header.packed_size > 0)) {
+		result = sceIoWrite(fd, block, header.packed_size);
+		if (result == (int)(header.packed_size)) {
+			result = sizeof(header);
+		}
+	}
+	if (result != sizeof(header)) {
+		return ((result < 0) ? result : -1);
+	}
+
+	return size;
+}
+
+static int lz_read_block(void *context, int fd, void *buf)
+{
+	struct Lz_Copy_Context *lz_context;
+	struct Lz_Block_Header header;
+	int size;
+
+	lz_context = (struct Lz_Copy_Context *)context;
+
+	if (sceIoRead(fd, &header, sizeof(header)) != sizeof(header)) {
+		return -1;
+	}
+	if (header.raw_size == 0) {  // end of stream
+		return 0;
+	}
+	if ((header.raw_size > (LZ_BLOCK_SIZE)) || (header.packed_size > header.raw_size) || (header.packed_size == 0)) {
+		return -1;
+	}
+
+	// read block, decompress unless stored uncompressed
+	if (header.packed_size == header.raw_size) {
+		if (sceIoRead(fd, buf, header.raw_size) != (int)(header.raw_size)) {
+			return -1;
+		}
+		return header.raw_size;
+	}
+	if (sceIoRead(fd, lz_context->block_buf, header.packed_size) != (int)(header.packed_size)) {
+		return -1;
+	}
+	size = lz_decompress_block(lz_context->block_buf, header.packed_size, (unsigned char *)buf, (LZ_BLOCK_SIZE));
+	if (size != (int)(header.raw_size)) {
+		return -1;
+	}
+
+	return size;
+}
+
+static const struct Copy_Codec lz_compress_codec = {
+	NULL,
+	lz_write_magic,
+	lz_read_raw,
+	lz_write_block,
+};
+
+static const struct Copy_Codec lz_decompress_codec = {
+	lz_check_magic,
+	NULL,
+	lz_read_block,
+	NULL,
+};
+
+int copy_file_compress(const char *src_path, const char *dst_path, unsigned int *checksum_ptr)
+{
+	struct Lz_Copy_Context context;
+	int result;
+
+	// bounded memory: raw block in copy buffer, compressed block in second pool buffer plus hash table
+	context.block_buf = (unsigned char *)borrow_buffer();
+	context.hash_table = (unsigned short *)malloc((1 << (LZ_HASH_BITS)) * sizeof(unsigned short));
+	result = -1;
+	if ((context.block_buf != NULL) && (context.hash_table != NULL)) {
+		result = copy_file_codec(src_path, dst_path, checksum_ptr, &lz_compress_codec, (void *)&context);
+	}
+	free(context.hash_table);
+	return_buffer(context.block_buf);
+
+	return result;
+}
+
+int copy_file_decompress(const char *src_path, const char *dst_path, unsigned int *checksum_ptr)
+{
+	struct Lz_Copy_Context context;
+	int result;
+
+	context.block_buf = (unsigned char *)borrow_buffer();
+	context.hash_table = NULL;
+	result = -1;
+	if (context.block_buf != NULL) {
+		result = copy_file_codec(src_path, dst_path, checksum_ptr, &lz_decompress_codec, (void *)&context);
+	}
+	return_buffer(context.block_buf);
+
+	return result;
+}
@@ -21,9 +21,19 @@
 
 #include <main.h>
 #include <account.h>
+#include <archive.h>
+#include <batch.h>
+#include <bench.h>
+#include <bufpool.h>
 #include <console.h>
 #include <file.h>
 #include <history.h>
+#include <menu.h>
+#include <regcache.h>
+#include <settings.h>
+#include <snapshot.h>
+#include <verify.h>
+#include <worker.h>
 #include <wlan.h>
 
 #include <debugScreen.h>
@@ -157,6 +167,11 @@ void wait_for_cancel_button(void)
 	int menu_run;
 	int button_pressed;
 
+	// batch commands run without user interaction
+	if (batch_mode) {
+		return;
+	}
+
 	menu_run = 1;
 	do {
 		button_pressed = get_key();
@@ -166,27 +181,260 @@ void wait_for_cancel_button(void)
 	} while (menu_run);
 }
 
-int main(void)
-{
+// main menu items in display order, exit is always last
+enum Main_Menu_Item {
+	MAIN_DISPLAY_CURRENT_ACCOUNT,
+	MAIN_DISPLAY_INITIAL_ACCOUNT,
+	MAIN_SAVE_ACCOUNT,
+	MAIN_SWITCH_ACCOUNT,
+	MAIN_REMOVE_ACCOUNT,
+	MAIN_UNLINK_MEMORY_CARDS,
+	MAIN_DISPLAY_HISTORY,
+	MAIN_DELETE_HISTORY,
+	MAIN_PROTECT_HISTORY,
+	MAIN_UNPROTECT_HISTORY,
+	MAIN_SAVE_CONSOLE,
+	MAIN_SAVE_REGISTRY,
+	MAIN_RESTORE_REGISTRY,
+	MAIN_SHOW_REG_CHANGE,
+	MAIN_SAVE_WLAN,
+	MAIN_SAVE_ALL_WLANS,
+	MAIN_LOAD_WLAN,
+	MAIN_RESTORE_ALL_WLANS,
+	MAIN_EXPORT_ACCOUNTS,
+	MAIN_IMPORT_ACCOUNTS,
+	MAIN_VERIFY_ACCOUNTS,
+	MAIN_BENCHMARK,
+	MAIN_EXIT,
+	MAIN_ITEMS
+};
+
+static const char *const main_menu_labels[(MAIN_ITEMS)] = {
+	// account menu points
+	"Display current account details.",
+	"Display initial account details.",
+	"Save current account.",
+	"Switch to a saved account.",
+	"Remove current account.",
+	"Unlink all memory cards.",
+	// execution history menu points
+	"Display current execution history details.",
+	"Delete current execution history.",
+	"Write-protect execution history files.",
+	"Unprotect execution history files.",
+	"Save console details.",
+	// registry snapshot menu points
+	"Save full registry snapshot.",
+	"Restore full registry snapshot.",
+	"Show last registry change.",
+	// wlan menu points
+	"Save WLAN details.",
+	"Save all WLANs.",
+	"Load WLAN details.",
+	"Restore all saved WLANs.",
+	// account archive menu points
+	"Export all accounts to archive.",
+	"Import accounts from archive.",
+	"Verify all saved accounts.",
+	"Run storage benchmarks.",
+	"Exit.",
+};
+
+// state of main menu
+struct Main_Data {
 	int is_safe_mode;
-	int menu_redraw;
-	int menu_run;
-	int menu_items;
-	int menu_item;
 	int no_user;
-	int x, y;
-	int button_pressed;
-	int i;
 	int reboot;
-	//int extra = 0;
-
 	struct Registry_Data *initial_account_reg_data;
 	struct Registry_Data *current_account_reg_data;
 	struct File_Data initial_account_file_data;
 	struct File_Data current_account_file_data;
 	struct Wlan_Data current_wlan_data;
+};
+
+static int get_main_item(struct Main_Data *main_data, int index)
+{
+	// safe mode only offers exit
+	if (main_data->is_safe_mode) {
+		return (MAIN_EXIT);
+	}
+
+	return index;
+}
+
+static int is_main_item_dimmed(struct Main_Data *main_data, int item)
+{
+	if (item == (MAIN_SAVE_ACCOUNT)) {
+		return main_data->no_user;
+	} else if (item == (MAIN_PROTECT_HISTORY)) {
+		return (execution_history_data.count_protected == execution_history_data.count);
+	} else if (item == (MAIN_UNPROTECT_HISTORY)) {
+		return (execution_history_data.count_protected == 0);
+	} else if ((item == (MAIN_SAVE_WLAN)) || (item == (MAIN_SAVE_ALL_WLANS))) {
+		return (main_data->current_wlan_data.wlan_found <= 0);
+	}
+
+	return 0;
+}
+
+static void draw_main_row(void *context, int index)
+{
+	struct Main_Data *main_data;
+	int item;
+
+	main_data = (struct Main_Data *)context;
+	item = get_main_item(main_data, index);
+	if ((item == (MAIN_EXIT)) && main_data->reboot) {
+		printf("Exit and reboot, so changes take effect.");
+		return;
+	}
+
+	if (is_main_item_dimmed(main_data, item)) {
+		printf("\e[2m%s\e[22m", main_menu_labels[item]);
+	} else {
+		printf("%s", main_menu_labels[item]);
+	}
+
+	return;
+}
+
+static void draw_main_info(struct Menu *menu)
+{
+	struct Main_Data *main_data;
+
+	main_data = (struct Main_Data *)menu->context;
+	if (main_data->is_safe_mode) {
+		printf("\e[1mPlease enable unsafe homebrew in Henkaku settings.\e[22m\e[0K\n");
+	} else {
+		get_current_account_reg_data(main_data->current_account_reg_data);
+		get_current_account_file_data(&(main_data->current_account_file_data));
+		get_current_execution_history_data(&execution_history_data);
+		get_current_wlan_data(&(main_data->current_wlan_data));
 
-	reboot = 0;
+		// draw current account data
+		display_account_details_short(main_data->current_account_reg_data, &(main_data->no_user));
+
+		// draw pixel line
+		draw_pixel_line(NULL, NULL);
+	}
+
+	// draw menu
+	printf("Menu:\e[0K\n");
+
+	return;
+}
+
+static int check_main_row(struct Menu *menu, int index)
+{
+	struct Main_Data *main_data;
+
+	// saving needs a signed-in user
+	main_data = (struct Main_Data *)menu->context;
+	if (get_main_item(main_data, index) == (MAIN_SAVE_ACCOUNT)) {
+		return !main_data->no_user;
+	}
+
+	return 1;
+}
+
+static int select_main_row(struct Menu *menu, int index)
+{
+	struct Main_Data *main_data;
+	int item;
+
+	main_data = (struct Main_Data *)menu->context;
+	item = get_main_item(main_data, index);
+	if (item == (MAIN_EXIT)) {  // last menu item is always exit
+		return (MENU_EXIT);
+	} else if (item == (MAIN_DISPLAY_CURRENT_ACCOUNT)) {  // display account details, re-read from registry
+		refresh_reg_cache();
+		get_current_account_reg_data(main_data->current_account_reg_data);
+		display_account_details_full(main_data->current_account_reg_data, &(main_data->current_account_file_data), "Current Account Details");
+	} else if (item == (MAIN_DISPLAY_INITIAL_ACCOUNT)) {  // display initial account details
+		display_account_details_full(main_data->initial_account_reg_data, &(main_data->initial_account_file_data), "Initial Account Details");
+	} else if (item == (MAIN_SAVE_ACCOUNT)) {  // save current account data
+		if (main_data->no_user) {
+			return (MENU_STAY);
+		}
+		refresh_reg_cache();
+		get_current_account_reg_data(main_data->current_account_reg_data);
+		save_account_details(main_data->current_account_reg_data, &(main_data->current_account_file_data), "Saving Current Account");
+	} else if (item == (MAIN_SWITCH_ACCOUNT)) {  // switch account
+		if (switch_account(main_data->current_account_reg_data, main_data->initial_account_reg_data, &(main_data->initial_account_file_data), "Switch Account")) {
+			main_data->reboot = 1;
+		}
+	} else if (item == (MAIN_REMOVE_ACCOUNT)) {  // remove current account
+		if (remove_account(main_data->current_account_reg_data, main_data->initial_account_reg_data, &(main_data->initial_account_file_data), "Removing Current Account")) {
+			main_data->reboot = 1;
+		}
+	} else if (item == (MAIN_UNLINK_MEMORY_CARDS)) {  // unlink all memory cards
+		unlink_all_memory_cards("Unlinking All Memory Cards");
+	} else if (item == (MAIN_DISPLAY_HISTORY)) {  // display execution history details
+		display_execution_history_details(&execution_history_data, "Current Execution History");
+	} else if (item == (MAIN_DELETE_HISTORY)) {  // delete execution history files
+		delete_execution_history(&execution_history_data, "Deleting Execution History");
+		main_data->reboot = 1;
+	} else if (item == (MAIN_PROTECT_HISTORY)) {  // write-protect execution history files
+		if (execution_history_data.count_protected >= execution_history_data.count) {
+			return (MENU_STAY);
+		}
+		protect_execution_history_files(&execution_history_data, "Protecting Execution History");
+	} else if (item == (MAIN_UNPROTECT_HISTORY)) {  // unprotect execution history files
+		if (execution_history_data.count_protected <= 0) {
+			return (MENU_STAY);
+		}
+		unprotect_execution_history_files(&execution_history_data, "Unprotecting Execution History");
+	} else if (item == (MAIN_SAVE_CONSOLE)) {  // save console details
+		save_console_details("Saving Console Details");
+	} else if (item == (MAIN_SAVE_REGISTRY)) {  // save full registry snapshot
+		save_full_registry("Saving Full Registry Snapshot");
+	} else if (item == (MAIN_RESTORE_REGISTRY)) {  // restore full registry snapshot
+		if (restore_full_registry("Restoring Full Registry Snapshot")) {
+			main_data->reboot = 1;
+		}
+	} else if (item == (MAIN_SHOW_REG_CHANGE)) {  // show registry keys changed by last switch/removal or wlan restore
+		refresh_reg_cache();
+		show_last_reg_change("Last Registry Change");
+	} else if (item == (MAIN_SAVE_WLAN)) {  // save wlan details
+		refresh_reg_cache();
+		get_current_wlan_data(&(main_data->current_wlan_data));
+		if (main_data->current_wlan_data.wlan_found > 0) {
+			save_wlan_details(&(main_data->current_wlan_data), "Save WLAN Details");
+		}
+	} else if (item == (MAIN_SAVE_ALL_WLANS)) {  // save all wlans
+		refresh_reg_cache();
+		get_current_wlan_data(&(main_data->current_wlan_data));
+		if (main_data->current_wlan_data.wlan_found > 0) {
+			save_all_wlan_details(&(main_data->current_wlan_data), "Save All WLANs");
+		}
+	} else if (item == (MAIN_LOAD_WLAN)) {  // load wlan details
+		refresh_reg_cache();
+		get_current_wlan_data(&(main_data->current_wlan_data));
+		load_wlan_details(&(main_data->current_wlan_data), "Load WLAN Details");
+	} else if (item == (MAIN_RESTORE_ALL_WLANS)) {  // restore all saved wlans
+		refresh_reg_cache();
+		get_current_wlan_data(&(main_data->current_wlan_data));
+		restore_all_wlan_details(&(main_data->current_wlan_data), "Restore All WLANs");
+	} else if (item == (MAIN_EXPORT_ACCOUNTS)) {  // export all accounts
+		export_accounts("Export Accounts");
+	} else if (item == (MAIN_IMPORT_ACCOUNTS)) {  // import accounts
+		import_accounts("Import Accounts");
+	} else if (item == (MAIN_VERIFY_ACCOUNTS)) {  // verify all saved accounts
+		verify_accounts("Verify Accounts");
+	} else if (item == (MAIN_BENCHMARK)) {  // measure storage operations on this console
+		run_benchmarks("Storage Benchmarks");
+	}
+
+	return (MENU_REDRAW);
+}
+
+int main(void)
+{
+	struct Main_Data main_data;
+	struct Batch_Data batch_data;
+	struct Menu menu;
+
+	main_data.reboot = 0;
 
 	// initialize DebugScreen
 	psvDebugScreenInit();
@@ -213,207 +461,63 @@ int main(void)
 	determine_enter_cancel_button(&button_enter, &button_cancel);
 
 	// Check for homebrew safe mode (adapted from VitaShell)
-	is_safe_mode = 0;
+	main_data.is_safe_mode = 0;
 	if (sceIoDevctl("ux0:", 0x3001, NULL, 0, NULL, 0) == 0x80010030) {
-		is_safe_mode = 1;
+		main_data.is_safe_mode = 1;
 	}
 
 	// initialize account data variables and structures
-	if (!is_safe_mode) {
+	if (!main_data.is_safe_mode) {
+		init_buffer_pool();
+		load_settings();
 		main_account();
 		main_wlan();
+		start_worker();
 
 		// initialize initial account registry data
-		initial_account_reg_data = NULL;
-		init_account_reg_data(&initial_account_reg_data);
-		get_initial_account_reg_data(initial_account_reg_data);
+		main_data.initial_account_reg_data = NULL;
+		init_account_reg_data(&(main_data.initial_account_reg_data));
+		get_initial_account_reg_data(main_data.initial_account_reg_data);
 
 		// initialize current account registry data
-		current_account_reg_data = NULL;
-		init_account_reg_data(&current_account_reg_data);
+		main_data.current_account_reg_data = NULL;
+		init_account_reg_data(&(main_data.current_account_reg_data));
 
 		// initialize initial account file data
-		init_account_file_data(&initial_account_file_data);
+		init_account_file_data(&(main_data.initial_account_file_data));
 
 		// initialize current account file data
-		init_account_file_data(&current_account_file_data);
+		init_account_file_data(&(main_data.current_account_file_data));
 
 		// initialize wlan data
-		init_wlan_data(&current_wlan_data);
+		init_wlan_data(&(main_data.current_wlan_data));
+
+		// run batch file once if present
+		batch_data.initial_account_reg_data = main_data.initial_account_reg_data;
+		batch_data.current_account_reg_data = main_data.current_account_reg_data;
+		batch_data.initial_account_file_data = &(main_data.initial_account_file_data);
+		batch_data.current_account_file_data = &(main_data.current_account_file_data);
+		batch_data.current_wlan_data = &(main_data.current_wlan_data);
+		if (run_batch(&batch_data) == (BATCH_REBOOT)) {
+			delete_app_save_data();
+			scePowerRequestColdReset();  // reboot
+			return 0;
+		}
+		main_data.reboot = batch_data.reboot;
 	}
 
 	// run main menu
-	menu_redraw = 1;
-	menu_run = 1;
-	menu_items = 0;
-	menu_item = 0;
-	no_user = 1;
-	do {
-		// redraw complete screen
-		if (menu_redraw) {
-			// draw title line
-			draw_title_line("Main Menu");
-
-			// draw pixel line
-			draw_pixel_line(NULL, NULL);
-
-			if (is_safe_mode) {
-				printf("\e[1mPlease enable unsafe homebrew in Henkaku settings.\e[22m\e[0K\n");
-			} else {
-				get_current_account_reg_data(current_account_reg_data);
-				get_current_account_file_data(&current_account_file_data);
-				get_current_execution_history_data(&execution_history_data);
-				get_current_wlan_data(&current_wlan_data);
-
-				// draw current account data
-				display_account_details_short(current_account_reg_data, &no_user);
-
-				// draw pixel line
-				draw_pixel_line(NULL, NULL);
-			}
-
-			// draw menu
-			printf("Menu:\e[0K\n");
-			psvDebugScreenGetCoordsXY(NULL, &y);
-			x = 0;
-			menu_items = 0;
-			if (!is_safe_mode) {
-				// account menu points
-				printf(" Display current account details.\e[0K\n"); menu_items++;
-				printf(" Display initial account details.\e[0K\n"); menu_items++;
-				if (no_user) { printf("\e[2m"); }
-				printf(" Save current account.\e[0K\n"); menu_items++;
-				if (no_user) { printf("\e[22m"); }
-				printf(" Switch to a saved account.\e[0K\n"); menu_items++;
-				printf(" Remove current account.\e[0K\n"); menu_items++;
-				printf(" Unlink all memory cards.\e[0K\n"); menu_items++;
-				// execution history menu points
-				printf(" Display current execution history details.\e[0K\n"); menu_items++;
-				printf(" Delete current execution history.\e[0K\n"); menu_items++;
-				if (execution_history_data.count_protected == execution_history_data.count) { printf("\e[2m"); }
-				printf(" Write-protect execution history files.\e[0K\n"); menu_items++;
-				if (execution_history_data.count_protected == execution_history_data.count) { printf("\e[22m"); }
-				if (execution_history_data.count_protected == 0) { printf("\e[2m"); }
-				printf(" Unprotect execution history files.\e[0K\n"); menu_items++;
-				if (execution_history_data.count_protected == 0) { printf("\e[22m"); }
-				printf(" Save console details.\e[0K\n"); menu_items++;
-				if (current_wlan_data.wlan_found <= 0) { printf("\e[2m"); }
-				printf(" Save WLAN details.\e[0K\n"); menu_items++;
-				if (current_wlan_data.wlan_found <= 0) { printf("\e[22m"); }
-				printf(" Load WLAN details.\e[0K\n"); menu_items++;
-			}
-			// last menu item is always exit
-			if (reboot) {
-				printf(" Exit and reboot, so changes take effect.");
-			} else {
-				printf(" Exit.");
-			}
-			printf("\e[0K\n");
-
-			menu_redraw = 0;
-		}
-
-		// draw menu marker
-		psvDebugScreenSetCoordsXY(&x, &y);
-		//
-		if (menu_item < 0) {
-			menu_item = 0;
-		}
-		if (menu_item > menu_items) {
-			menu_item = menu_items;
-		}
-		if ((menu_item == 2) && no_user) {
-			menu_item--;
-		}
-		//
-		for (i = 0; i <= menu_items; i++) {
-			if (menu_item == i) {
-				printf(">\n");
-			} else {
-				printf(" \n");
-			}
-		}
-
-		// process key strokes
-		button_pressed = get_key();
-		if (button_pressed == SCE_CTRL_DOWN) {
-			menu_item++;
-			if ((menu_item == 2) && no_user) {
-				menu_item++;
-			}
-		} else if (button_pressed == SCE_CTRL_UP) {
-			menu_item--;
-			if ((menu_item == 2) && no_user) {
-				menu_item--;
-			}
-		//} else if (button_pressed == button_cancel) {
-		//	extra = !extra;
-		//	menu_redraw = 1;
-		//}
-		} else if (button_pressed == button_enter) {
-			if (menu_item == menu_items) {  // last menu item is always exit
-				menu_run = 0;
-			} else if (menu_item == 0) {  // display account details
-				display_account_details_full(current_account_reg_data, &current_account_file_data, "Current Account Details");
-				menu_redraw = 1;
-			} else if (menu_item == 1) {  // display initial account details
-				display_account_details_full(initial_account_reg_data, &initial_account_file_data, "Initial Account Details");
-				menu_redraw = 1;
-			} else if (menu_item == 2) {  // save current account data
-				if (!no_user) {
-					save_account_details(current_account_reg_data, &current_account_file_data, "Saving Current Account");
-					menu_redraw = 1;
-				}
-			} else if (menu_item == 3) {  // switch account
-				if (switch_account(current_account_reg_data, initial_account_reg_data, &initial_account_file_data, "Switch Account")) {
-					reboot = 1;
-				}
-				menu_redraw = 1;
-			} else if(menu_item == 4) {  // remove current account
-				if (remove_account(current_account_reg_data, initial_account_reg_data, &initial_account_file_data, "Removing Current Account")) {
-					reboot = 1;
-				}
-				menu_redraw = 1;
-			} else if(menu_item == 5) {  // unlink all memory cards
-				unlink_all_memory_cards("Unlinking All Memory Cards");
-				menu_redraw = 1;
-			} else if (menu_item == 6) {  // display execution history details
-				display_execution_history_details(&execution_history_data, "Current Execution History");
-				menu_redraw = 1;
-			} else if (menu_item == 7) {  // delete execution history files
-				delete_execution_history(&execution_history_data, "Deleting Execution History");
-				reboot = 1;
-				menu_redraw = 1;
-			} else if (menu_item == 8) {  // write-protect execution history files
-				if (execution_history_data.count_protected < execution_history_data.count) {
-					protect_execution_history_files(&execution_history_data, "Protecting Execution History");
-					menu_redraw = 1;
-				}
-			} else if (menu_item == 9) {  // unprotect execution history files
-				if (execution_history_data.count_protected > 0) {
-					unprotect_execution_history_files(&execution_history_data, "Unprotecting Execution History");
-					menu_redraw = 1;
-				}
-			} else if (menu_item == 10) {  // save console details
-				save_console_details("Saving Console Details");
-				menu_redraw = 1;
-			} else if (menu_item == 11) {  // save wlan details
-				get_current_wlan_data(&current_wlan_data);
-				if (current_wlan_data.wlan_found > 0) {
-					save_wlan_details(&current_wlan_data, "Save WLAN Details");
-				}
-				menu_redraw = 1;
-			} else if (menu_item == 12) {  // load wlan details
-				get_current_wlan_data(&current_wlan_data);
-				load_wlan_details(&current_wlan_data, "Load WLAN Details");
-				menu_redraw = 1;
-			}
-		}
-	} while (menu_run);
+	main_data.no_user = 1;
+	init_menu(&menu, "Main Menu", (main_data.is_safe_mode ? 1 : (MAIN_ITEMS)), draw_main_row, select_main_row, &main_data);
+	menu.draw_info = draw_main_info;
+	menu.check_row = check_main_row;
+	run_menu(&menu);
+	stop_worker();
+	free_buffer_pool();
 
 	delete_app_save_data();
 
-	if (reboot) {
+	if (main_data.reboot) {
 		scePowerRequestColdReset();  // reboot
 		//scePowerRequestStandby();  // shutdown
 	}
@@ -0,0 +1,205 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <vitasdk.h>
+
+#include <main.h>
+#include <menu.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+
+void init_menu(struct Menu *menu, const char *title, int count, List_View_Draw_Row draw_row, Menu_Select_Row select_row, void *context)
+{
+	menu->title = title;
+	menu->count = count;
+	menu->draw_info = NULL;
+	menu->draw_row = draw_row;
+	menu->check_row = NULL;
+	menu->select_row = select_row;
+	menu->highlight_row = NULL;
+	menu->handle_key = NULL;
+	menu->context = context;
+	menu->data_x = 0;
+	menu->data_y = 0;
+	menu->list_view.cursor = 0;
+
+	return;
+}
+
+void clear_menu_data(struct Menu *menu)
+{
+	int x, y;
+
+	// clear data part of screen
+	x = menu->data_x;
+	y = menu->data_y;
+	psvDebugScreenSetCoordsXY(&x, &y);
+	printf("\e[0J");
+
+	return;
+}
+
+static void skip_unavailable_rows(struct Menu *menu, int direction)
+{
+	struct List_View *view;
+	int cursor;
+	int i;
+
+	if (menu->check_row == NULL) {
+		return;
+	}
+
+	// continue in key direction, turn around at list end
+	view = &(menu->list_view);
+	cursor = view->cursor;
+	for (i = 0; (i < (2 * view->count)) && !menu->check_row(menu, cursor); i++) {
+		if (((cursor + direction) < 0) || ((cursor + direction) >= view->count)) {
+			direction = -direction;
+		}
+		cursor += direction;
+	}
+	set_list_view_cursor(view, cursor);
+
+	return;
+}
+
+void run_menu(struct Menu *menu)
+{
+	int menu_redraw_screen;
+	int menu_run;
+	int x, y;
+	int button_pressed;
+	int cursor;
+	int result;
+
+	menu_redraw_screen = 1;
+	menu_run = 1;
+	do {
+		// redraw screen
+		if (menu_redraw_screen) {
+			// draw title line
+			draw_title_line(menu->title);
+
+			// draw pixel line
+			draw_pixel_line(NULL, NULL);
+			psvDebugScreenGetCoordsXY(NULL, &(menu->data_y));  // start of data
+			menu->data_x = 0;
+
+			// draw info
+			if (menu->draw_info != NULL) {
+				menu->draw_info(menu);
+			}
+
+			// draw menu, keep highlighted row
+			psvDebugScreenGetCoordsXY(NULL, &y);  // start of menu
+			x = 0;
+			cursor = menu->list_view.cursor;
+			init_list_view(&(menu->list_view), x, y, menu->count, menu->draw_row, menu->context);
+			set_list_view_cursor(&(menu->list_view), cursor);
+			skip_unavailable_rows(menu, 1);
+
+			menu_redraw_screen = 0;
+		}
+
+		// redraw changed rows and menu marker
+		draw_list_view(&(menu->list_view));
+
+		if (menu->highlight_row != NULL) {
+			menu->highlight_row(menu, menu->list_view.cursor);
+		}
+
+		// process key strokes
+		button_pressed = get_key();
+		if (handle_list_view_key(&(menu->list_view), button_pressed)) {
+			skip_unavailable_rows(menu, (((button_pressed == SCE_CTRL_UP) || (button_pressed == SCE_CTRL_LTRIGGER)) ? -1 : 1));
+		} else if (button_pressed == button_enter) {
+			result = menu->select_row(menu, menu->list_view.cursor);
+			if (result == (MENU_EXIT)) {
+				menu_run = 0;
+			} else if (result == (MENU_REDRAW)) {
+				menu_redraw_screen = 1;
+			}
+		} else if (menu->handle_key != NULL) {
+			result = menu->handle_key(menu, button_pressed);
+			if (result == (MENU_EXIT)) {
+				menu_run = 0;
+			} else if (result == (MENU_REDRAW)) {
+				menu_redraw_screen = 1;
+			}
+		}
+	} while (menu_run);
+
+	return;
+}
+
+// left/right jump between groups of sorted entries, square/triangle lengthen/shorten the name filter
+int handle_dir_filter_key(struct Menu *menu, struct Dir_Filter *filter, int first_row, int button_pressed)
+{
+	struct List_View *view;
+	int index;
+	int direction;
+
+	view = &(menu->list_view);
+	if (filter->count <= 0) {
+		index = -1;
+	} else if (view->cursor < first_row) {
+		index = filter->first;  // act on first entry when on a fixed row
+	} else {
+		index = filter->first + view->cursor - first_row;
+	}
+
+	if ((button_pressed == SCE_CTRL_RIGHT) || (button_pressed == SCE_CTRL_LEFT)) {
+		if (index < 0) {
+			return (MENU_STAY);
+		}
+		direction = ((button_pressed == SCE_CTRL_RIGHT) ? 1 : -1);
+		if ((view->cursor < first_row) && (direction > 0)) {
+			direction = 0;  // first entry starts first group
+		}
+		if (direction != 0) {
+			// group by next char after filter, all entries in range share the filter prefix
+			index = filter->first + find_subdir_group(&(filter->dirs[filter->first]), filter->count, index - filter->first, filter->size_prefix + 1, direction);
+		}
+		set_list_view_cursor(view, index - filter->first + first_row);
+		return (MENU_STAY);
+	} else if (button_pressed == SCE_CTRL_SQUARE) {
+		if ((index < 0) || (filter->dirs[index].size <= (size_t)filter->size_prefix) || (filter->size_prefix >= (DIR_PREFIX_SIZE))) {
+			return (MENU_STAY);
+		}
+		set_dir_filter_prefix(filter, filter->dirs[index].name, filter->size_prefix + 1);
+	} else if (button_pressed == SCE_CTRL_TRIANGLE) {
+		if (filter->size_prefix <= 0) {
+			return (MENU_STAY);
+		}
+		set_dir_filter_prefix(filter, filter->prefix, filter->size_prefix - 1);
+	} else {
+		return (MENU_STAY);
+	}
+
+	// keep highlighted entry, which is always inside the new range
+	menu->count = filter->count + first_row;
+	if (index >= 0) {
+		view->cursor = index - filter->first + first_row;
+	}
+
+	return (MENU_REDRAW);
+}
@@ -0,0 +1,406 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>  // for malloc(), free()
+#include <vitasdk.h>
+
+#include <account.h>
+#include <blob.h>
+#include <card.h>
+#include <dir.h>
+#include <file.h>
+#include <hash.h>
+#include <history.h>
+#include <main.h>
+#include <plan.h>
+#include <registry.h>
+#include <settings.h>
+#include <snapshot.h>
+#include <trophy.h>
+#include <worker.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+// data of plan steps run on worker thread
+struct Plan_Context {
+	struct Switch_Plan *plan;
+	struct Registry_Data *reg_data;
+	struct Registry_Data *reg_new_data;
+	struct File_Data *file_new_data;
+};
+
+static void add_plan_step(struct Switch_Plan *plan, int type, int file_index)
+{
+	plan->steps[plan->count].type = type;
+	plan->steps[plan->count].file_index = file_index;
+	plan->count++;
+
+	return;
+}
+
+static void build_plan_paths(const struct File_Entry *const file_entry, char *target_path, char *save_path)
+{
+	target_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(target_path, file_entry->file_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(target_path, file_entry->file_name_path, (MAX_PATH_LENGTH));
+
+	if (save_path != NULL) {
+		save_path[(MANIFEST_PATH_SIZE)] = '\0';
+		sceClibStrncpy(save_path, file_entry->file_save_path, (MANIFEST_PATH_SIZE));
+		sceClibStrncat(save_path, file_entry->file_name_path, (MANIFEST_PATH_SIZE));
+	}
+
+	return;
+}
+
+// live file already has the stored content, checked by size first
+static int check_live_file(const char *target_path, const struct Manifest_Entry *const entry)
+{
+	SceIoStat stat;
+	unsigned long long hash;
+
+	if (sceIoGetstat(target_path, &stat) < 0) {
+		return 0;
+	}
+	if (stat.st_size != entry->size) {
+		return 0;
+	}
+	if (hash_file(target_path, &hash, NULL) < 0) {
+		return 0;
+	}
+
+	return (hash == entry->hash);
+}
+
+static int is_same_user(struct Registry_Data *reg_data, struct Registry_Data *reg_new_data)
+{
+	return (sceClibStrncmp((char *)(get_reg_value(reg_data, reg_data->idx_username)), (char *)(get_reg_value(reg_new_data, reg_new_data->idx_username)), reg_data->reg_entries[reg_data->idx_username].key_size) == 0);
+}
+
+static void build_account_base_path(struct Registry_Data *reg_data, char *base_path)
+{
+	base_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(base_path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, accounts_folder, (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, (char *)(get_reg_value(reg_data, reg_data->idx_username)), (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, slash_folder, (MAX_PATH_LENGTH));
+
+	return;
+}
+
+static void print_trophy_stats(const char *action, const struct Trophy_Stats *const stats, SceUInt64 start_time, int restored)
+{
+	printf("%s %i trophy files (%llu KB) in %llu ms", action, stats->files, stats->bytes / 1024, (sceKernelGetProcessTimeWide() - start_time) / 1000);
+	if (stats->failed > 0) {
+		printf(", \e[1m%i failed\e[22m", stats->failed);
+	}
+	// saving is the trophy resync skipped after the switch, which the app cannot see
+	if (restored && (stats->files > 0)) {
+		printf(", time saved by skipped resync is not measured");
+	}
+	printf(".\e[0K\n");
+
+	return;
+}
+
+// fallback when trophy data cannot be replaced, delete trophy files not stored for new account as without archive
+static int delete_trophy_files(struct File_Data *file_new_data)
+{
+	char target_path[(MAX_PATH_LENGTH)+1];
+	struct File_Entry *file_entry;
+	int result;
+	int i;
+
+	result = 0;
+	for (i = 0; i < file_new_data->file_count; i++) {
+		file_entry = &(file_new_data->file_entries[i]);
+		if ((file_entry->file_path == NULL) || (file_entry->file_name_path == NULL) || file_entry->file_available || !is_trophy_file_entry(file_entry)) {
+			continue;
+		}
+		build_plan_paths(file_entry, target_path, NULL);
+		if (!check_file_exists(target_path)) {
+			continue;
+		}
+		printf("\e[2mDeleting %s...\e[22m\e[0K\n", target_path);
+		if (sceIoRemove(target_path) < 0) {
+			result = -1;
+		}
+	}
+
+	return result;
+}
+
+int build_switch_plan(struct Switch_Plan *plan, struct Registry_Data *reg_data, struct Registry_Data *reg_new_data, struct File_Data *file_new_data, int full)
+{
+	int i;
+	int same_user;
+	int keep_trophies;
+	struct File_Entry *file_entry;
+	struct Manifest_Entry *entry;
+	char target_path[(MAX_PATH_LENGTH)+1];
+	char save_path[(MANIFEST_PATH_SIZE)+1];
+
+	plan->count = 0;
+	plan->total = 0;
+	plan->done = 0;
+	plan->cancelled = 0;
+	plan->trophy_archived = 0;
+	plan->total_bytes = 0;
+	plan->reg_diff.changed = NULL;
+	plan->manifest.count = 0;
+	plan->manifest.entries = NULL;
+
+	// registry, each file, history, saves folder and trophy archive/restore
+	plan->steps = (struct Plan_Step *)malloc((file_new_data->file_count + 5) * sizeof(struct Plan_Step));
+	if (plan->steps == NULL) {
+		return -1;
+	}
+
+	// build source base path and load manifest of blob store
+	build_account_base_path(reg_new_data, plan->base_path);
+	plan->size_base_path = sceClibStrnlen(plan->base_path, (MAX_PATH_LENGTH));
+	load_manifest(plan->base_path, &(plan->manifest));
+	same_user = is_same_user(reg_data, reg_new_data);
+
+	// trophy data stays with same user, otherwise it is kept per account when stored for new account
+	// live trophy data is only replaced when it gets archived for the current account first,
+	// otherwise only the trophy files of the account file data are deleted as before
+	keep_trophies = 0;
+	if (app_settings.keep_trophies) {
+		keep_trophies = same_user;
+
+		// archive trophy data of current account if it was saved before
+		if (!same_user) {
+			plan->total++;
+			build_account_base_path(reg_data, target_path);
+			if ((((char *)(get_reg_value(reg_data, reg_data->idx_username)))[0] != '\0') && check_folder_exists(target_path)) {
+				add_plan_step(plan, (PLAN_STEP_ARCHIVE_TROPHIES), -1);
+				keep_trophies = check_trophy_archive(&(plan->manifest));
+			}
+		}
+	}
+
+	// registry keys that differ from current values
+	plan->total++;
+	diff_reg_data(reg_data, reg_new_data, &(plan->reg_diff));
+	if (full || (plan->reg_diff.changed_count > 0)) {
+		add_plan_step(plan, (PLAN_STEP_REGISTRY), -1);
+	}
+
+	// account files that differ from live files
+	for (i = 0; i < file_new_data->file_count; i++) {
+		file_entry = &(file_new_data->file_entries[i]);
+		if ((file_entry->file_path == NULL) || (file_entry->file_name_path == NULL)) {
+			continue;
+		}
+		plan->total++;
+
+		// memory card link known for this account and card
+		if ((find_card_device(file_entry) >= 0) && (build_card_save_path(file_entry->file_path, save_path, 0) == 0) && ((entry = find_manifest_entry(&(plan->manifest), save_path)) != NULL)) {
+			build_plan_paths(file_entry, target_path, NULL);
+			if (!full && check_live_file(target_path, entry)) {
+				continue;
+			}
+			add_plan_step(plan, (PLAN_STEP_RESTORE_CARD), i);
+			plan->total_bytes += entry->size;
+		} else if (file_entry->file_available) {
+			build_plan_paths(file_entry, target_path, save_path);
+			entry = find_manifest_entry(&(plan->manifest), save_path);
+			if (!full && (entry != NULL) && check_live_file(target_path, entry)) {
+				continue;
+			}
+			add_plan_step(plan, (PLAN_STEP_RESTORE_FILE), i);
+			if (entry != NULL) {
+				plan->total_bytes += entry->size;
+			}
+		} else {
+			if (keep_trophies && is_trophy_file_entry(file_entry)) {
+				continue;
+			}
+			build_plan_paths(file_entry, target_path, NULL);
+			if (!full && !check_file_exists(target_path)) {
+				continue;
+			}
+			add_plan_step(plan, (PLAN_STEP_DELETE_FILE), i);
+		}
+	}
+
+	// history and saves folder stay when switching to same user
+	plan->total++;
+	get_current_execution_history_data(&execution_history_data);
+	for (i = 0; i < execution_history_data.count; i++) {
+		if (execution_history_data.entries[i].file_available) {
+			break;
+		}
+	}
+	if (full || (!same_user && (i < execution_history_data.count))) {
+		add_plan_step(plan, (PLAN_STEP_DELETE_HISTORY), -1);
+	}
+
+	plan->total++;
+	if (full || !same_user) {
+		add_plan_step(plan, (PLAN_STEP_SWAP_SAVES), -1);
+	}
+
+	if (keep_trophies && !same_user) {
+		plan->total++;
+		add_plan_step(plan, (PLAN_STEP_RESTORE_TROPHIES), -1);
+	}
+
+	return plan->count;
+}
+
+static int run_switch_plan_step(void *context, int index)
+{
+	struct Plan_Context *plan_context;
+	struct Switch_Plan *plan;
+	struct Registry_Data *reg_data;
+	struct Registry_Data *reg_new_data;
+	int result;
+	struct Plan_Step *step;
+	struct File_Entry *file_entry;
+	struct Trophy_Stats trophy_stats;
+	SceUInt64 start_time;
+	char target_path[(MAX_PATH_LENGTH)+1];
+	char save_path[(MANIFEST_PATH_SIZE)+1];
+
+	plan_context = (struct Plan_Context *)context;
+	plan = plan_context->plan;
+	reg_data = plan_context->reg_data;
+	reg_new_data = plan_context->reg_new_data;
+
+	step = &(plan->steps[index]);
+	result = 0;
+	if (step->type == (PLAN_STEP_REGISTRY)) {
+		// keep image of complete registry and current account registry data, then only write changed keys
+		snapshot_full_registry();
+		clear_reg_section_snapshots();
+		save_reg_data_snapshot(account_snapshot_name, reg_data);
+		printf("%i of %i registry keys changed.\e[0K\n", plan->reg_diff.changed_count, plan->reg_diff.count);
+		set_reg_data_diff(reg_new_data, -1, &(plan->reg_diff));
+	} else if (step->type == (PLAN_STEP_RESTORE_FILE)) {
+		file_entry = &(plan_context->file_new_data->file_entries[step->file_index]);
+		build_plan_paths(file_entry, target_path, save_path);
+		plan->base_path[plan->size_base_path] = '\0';
+		sceClibStrncat(plan->base_path, save_path, (MAX_PATH_LENGTH));
+		result = restore_account_file(plan->base_path, find_manifest_entry(&(plan->manifest), save_path), save_path, target_path);
+		plan->base_path[plan->size_base_path] = '\0';
+	} else if (step->type == (PLAN_STEP_RESTORE_CARD)) {
+		file_entry = &(plan_context->file_new_data->file_entries[step->file_index]);
+		build_plan_paths(file_entry, target_path, NULL);
+		result = build_card_save_path(file_entry->file_path, save_path, 0);
+		if (result >= 0) {
+			result = restore_account_file(plan->base_path, find_manifest_entry(&(plan->manifest), save_path), save_path, target_path);
+		}
+	} else if (step->type == (PLAN_STEP_DELETE_FILE)) {
+		file_entry = &(plan_context->file_new_data->file_entries[step->file_index]);
+		build_plan_paths(file_entry, target_path, NULL);
+		if (!check_file_exists(target_path)) {
+			printf("\e[2mSkip deleting missing %s...\e[22m\e[0K\n", target_path);
+		} else {
+			printf("\e[2mDeleting %s...\e[22m\e[0K\n", target_path);
+			result = sceIoRemove(target_path);
+		}
+	} else if (step->type == (PLAN_STEP_DELETE_HISTORY)) {
+		// delete execution history data
+		delete_execution_history(&execution_history_data, NULL);
+	} else if (step->type == (PLAN_STEP_SWAP_SAVES)) {
+		if (switch_saves_folder("ux0:user", (char*)(get_reg_value(reg_data, reg_data->idx_username)), (char*)(get_reg_value(reg_new_data, reg_new_data->idx_username)))) {
+			printf("Saves folder swapped!\n");
+		} else {
+			printf("Saves folder didn't swap!\n");
+			result = -1;
+		}
+	} else if (step->type == (PLAN_STEP_ARCHIVE_TROPHIES)) {
+		start_time = sceKernelGetProcessTimeWide();
+		build_account_base_path(reg_data, target_path);
+		printf("Archiving trophy data to %s...\e[0K\n", target_path);
+		result = archive_trophy_data(target_path, &trophy_stats);
+		print_trophy_stats("Archived", &trophy_stats, start_time, 0);
+		if ((result < 0) || (trophy_stats.failed > 0)) {
+			result = -1;
+		} else {
+			plan->trophy_archived = 1;
+		}
+	} else if (step->type == (PLAN_STEP_RESTORE_TROPHIES)) {
+		// never overwrite live trophy data that was not archived, but never leave it to new account either
+		if (!plan->trophy_archived) {
+			printf("\e[1mTrophy data was not archived, deleting trophy files instead!\e[22m\e[0K\n");
+			delete_trophy_files(plan_context->file_new_data);
+			return -1;
+		}
+		start_time = sceKernelGetProcessTimeWide();
+		printf("Restoring trophy data from %s...\e[0K\n", plan->base_path);
+		result = restore_trophy_data(&(plan->manifest), &trophy_stats);
+		print_trophy_stats("Restored", &trophy_stats, start_time, 1);
+		if ((result < 0) && (trophy_stats.files == 0)) {  // live data untouched as stored files are missing
+			printf("\e[1mDeleting trophy files instead!\e[22m\e[0K\n");
+			delete_trophy_files(plan_context->file_new_data);
+		}
+		if (trophy_stats.failed > 0) {
+			result = -1;
+		}
+	}
+
+	return result;
+}
+
+int execute_switch_plan(struct Switch_Plan *plan, struct Registry_Data *reg_data, struct Registry_Data *reg_new_data, struct File_Data *file_new_data)
+{
+	struct Plan_Context context;
+	struct Worker_Job job;
+	int i;
+
+	// steps run in order on worker thread, cancel skips all remaining steps
+	context.plan = plan;
+	context.reg_data = reg_data;
+	context.reg_new_data = reg_new_data;
+	context.file_new_data = file_new_data;
+	plan->trophy_archived = 0;
+	job.count = plan->count;
+	job.total_bytes = plan->total_bytes;
+	job.context = (void *)&context;
+	job.run_step = run_switch_plan_step;
+	// only archiving trophies leaves live data untouched, from first other step on the switch must complete
+	job.commit_step = plan->count;
+	for (i = 0; i < plan->count; i++) {
+		if (plan->steps[i].type != (PLAN_STEP_ARCHIVE_TROPHIES)) {
+			job.commit_step = i;
+			break;
+		}
+	}
+	run_worker_job(&job);
+	plan->done = job.done;
+	plan->cancelled = job.cancelled;
+
+	return plan->done;
+}
+
+void free_switch_plan(struct Switch_Plan *plan)
+{
+	free(plan->steps);
+	plan->steps = NULL;
+	plan->count = 0;
+	free_reg_diff(&(plan->reg_diff));
+	free_manifest(&(plan->manifest));
+
+	return;
+}
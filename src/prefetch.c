@@ -0,0 +1,234 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>  // for free()
+#include <vitasdk.h>
+
+#include <account.h>
+#include <prefetch.h>
+#include <registry.h>
+
+static struct Prefetch_Entry prefetch_entries[(PREFETCH_SLOTS)];
+static SceKernelLwMutexWork prefetch_mutex;
+static SceUID prefetch_sema = -1;
+static SceUID prefetch_thread = -1;
+static volatile int prefetch_quit;
+static char prefetch_request_name[(PREFETCH_NAME_SIZE)+1];
+static unsigned int prefetch_clock;
+static struct Registry_Data *prefetch_reg_init_data;
+static struct File_Data *prefetch_file_init_data;
+
+
+static void free_prefetch_entry(struct Prefetch_Entry *entry)
+{
+	if (entry->reg_data != NULL) {
+		free_reg_data(entry->reg_data);
+		free(entry->reg_data);
+		entry->reg_data = NULL;
+	}
+	if (entry->file_data.file_entries != NULL) {
+		free(entry->file_data.file_entries);
+		entry->file_data.file_entries = NULL;
+	}
+	entry->username[0] = '\0';
+	entry->state = PREFETCH_EMPTY;
+
+	return;
+}
+
+static struct Prefetch_Entry *find_prefetch_entry(const char *username)
+{
+	int i;
+
+	for (i = 0; i < (PREFETCH_SLOTS); i++) {
+		if ((prefetch_entries[i].state != PREFETCH_EMPTY) && (sceClibStrncmp(prefetch_entries[i].username, username, (PREFETCH_NAME_SIZE)) == 0)) {
+			return &(prefetch_entries[i]);
+		}
+	}
+
+	return NULL;
+}
+
+static int prefetch_thread_main(SceSize args, void *argp)
+{
+	char username[(PREFETCH_NAME_SIZE)+1];
+	struct Prefetch_Entry *entry;
+	struct Prefetch_Entry *lru;
+	struct Registry_Data *reg_data;
+	struct File_Data file_data;
+	int i;
+
+	username[(PREFETCH_NAME_SIZE)] = '\0';
+
+	while (1) {
+		sceKernelWaitSema(prefetch_sema, 1, NULL);
+		if (prefetch_quit) {
+			break;
+		}
+
+		// take latest request, older ones are obsolete
+		sceKernelLockLwMutex(&prefetch_mutex, 1, NULL);
+		sceClibStrncpy(username, prefetch_request_name, (PREFETCH_NAME_SIZE));
+		prefetch_request_name[0] = '\0';
+		if ((username[0] == '\0') || (find_prefetch_entry(username) != NULL)) {
+			sceKernelUnlockLwMutex(&prefetch_mutex, 1);
+			continue;
+		}
+
+		// use empty or least recently used slot
+		lru = NULL;
+		for (i = 0; i < (PREFETCH_SLOTS); i++) {
+			entry = &(prefetch_entries[i]);
+			if (entry->state == PREFETCH_EMPTY) {
+				lru = entry;
+				break;
+			}
+			if ((lru == NULL) || (entry->last_used < lru->last_used)) {
+				lru = entry;
+			}
+		}
+		free_prefetch_entry(lru);
+		sceClibStrncpy(lru->username, username, (PREFETCH_NAME_SIZE));
+		lru->username[(PREFETCH_NAME_SIZE)] = '\0';
+		lru->state = PREFETCH_LOADING;
+		lru->last_used = ++prefetch_clock;
+		sceKernelUnlockLwMutex(&prefetch_mutex, 1);
+
+		// load account details silently
+		reg_data = NULL;
+		init_account_reg_data(&reg_data);
+		init_account_file_data(&file_data);
+		sceClibStrncpy((char *)(get_reg_value(reg_data, reg_data->idx_username)), username, (reg_data->reg_entries[reg_data->idx_username].key_size - 1));
+		read_account_details(reg_data, &file_data, prefetch_reg_init_data, prefetch_file_init_data, 0);
+
+		sceKernelLockLwMutex(&prefetch_mutex, 1, NULL);
+		lru->reg_data = reg_data;
+		lru->file_data = file_data;
+		lru->state = PREFETCH_READY;
+		sceKernelUnlockLwMutex(&prefetch_mutex, 1);
+	}
+
+	return 0;
+}
+
+void start_prefetch(struct Registry_Data *reg_init_data, struct File_Data *file_init_data)
+{
+	if (prefetch_thread >= 0) {
+		return;
+	}
+
+	sceClibMemset(prefetch_entries, 0x00, sizeof(prefetch_entries));
+	prefetch_request_name[0] = '\0';
+	prefetch_clock = 0;
+	prefetch_quit = 0;
+	prefetch_reg_init_data = reg_init_data;
+	prefetch_file_init_data = file_init_data;
+
+	sceKernelCreateLwMutex(&prefetch_mutex, "prefetch_mutex", 0, 0, NULL);
+	prefetch_sema = sceKernelCreateSema("prefetch_sema", 0, 0, 1, NULL);
+	prefetch_thread = sceKernelCreateThread("prefetch_thread", prefetch_thread_main, 0x10000100, 0x10000, 0, 0, NULL);
+	if (prefetch_thread >= 0) {
+		sceKernelStartThread(prefetch_thread, 0, NULL);
+	}
+
+	return;
+}
+
+void stop_prefetch(void)
+{
+	int i;
+
+	if (prefetch_thread < 0) {
+		return;
+	}
+
+	prefetch_quit = 1;
+	sceKernelSignalSema(prefetch_sema, 1);
+	sceKernelWaitThreadEnd(prefetch_thread, NULL, NULL);
+	sceKernelDeleteThread(prefetch_thread);
+	prefetch_thread = -1;
+
+	sceKernelDeleteSema(prefetch_sema);
+	prefetch_sema = -1;
+	sceKernelDeleteLwMutex(&prefetch_mutex);
+
+	for (i = 0; i < (PREFETCH_SLOTS); i++) {
+		free_prefetch_entry(&(prefetch_entries[i]));
+	}
+
+	return;
+}
+
+void request_prefetch(const char *username)
+{
+	struct Prefetch_Entry *entry;
+
+	if (prefetch_thread < 0) {
+		return;
+	}
+
+	sceKernelLockLwMutex(&prefetch_mutex, 1, NULL);
+	entry = find_prefetch_entry(username);
+	if (entry != NULL) {  // already cached or loading
+		entry->last_used = ++prefetch_clock;
+		sceKernelUnlockLwMutex(&prefetch_mutex, 1);
+		return;
+	}
+	sceClibStrncpy(prefetch_request_name, username, (PREFETCH_NAME_SIZE));
+	prefetch_request_name[(PREFETCH_NAME_SIZE)] = '\0';
+	sceKernelUnlockLwMutex(&prefetch_mutex, 1);
+
+	sceKernelSignalSema(prefetch_sema, 1);
+
+	return;
+}
+
+int take_prefetched(const char *username, struct Registry_Data **reg_data_ptr, struct File_Data *file_data)
+{
+	struct Prefetch_Entry *entry;
+
+	if (prefetch_thread < 0) {
+		return 0;
+	}
+
+	while (1) {
+		sceKernelLockLwMutex(&prefetch_mutex, 1, NULL);
+		entry = find_prefetch_entry(username);
+		if (entry == NULL) {
+			sceKernelUnlockLwMutex(&prefetch_mutex, 1);
+			return 0;
+		}
+
+		// hand over ownership of loaded data
+		if (entry->state == PREFETCH_READY) {
+			*reg_data_ptr = entry->reg_data;
+			*file_data = entry->file_data;
+			entry->reg_data = NULL;
+			entry->file_data.file_entries = NULL;
+			free_prefetch_entry(entry);
+			sceKernelUnlockLwMutex(&prefetch_mutex, 1);
+			return 1;
+		}
+		sceKernelUnlockLwMutex(&prefetch_mutex, 1);
+
+		// still loading, wait for it
+		sceKernelDelayThread(1000);  // 1ms
+	}
+}
@@ -0,0 +1,233 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <stdlib.h>  // for malloc(), free()
+#include <vitasdk.h>
+
+#include <common.h>
+#include <hash.h>
+#include <registry.h>
+#include <regcache.h>
+
+// cached registry key, path, name and value are stored behind the entry
+struct Reg_Cache_Entry {
+	struct Reg_Cache_Entry *next;
+	unsigned long long hash;
+	const char *reg_path;
+	const char *key_name;
+	int key_type;
+	int size;
+	unsigned char *value;
+};
+
+struct Reg_Cache_Stats reg_cache_stats;
+
+static struct Reg_Cache_Entry *reg_cache_buckets[(REG_CACHE_BUCKETS)];
+
+
+static unsigned long long hash_reg_cache_key(const char *const reg_path, const char *const key_name)
+{
+	unsigned long long hash;
+
+	// path terminator separates path and name
+	hash = hash_fnv1a64_update((HASH_FNV1A64_INIT), reg_path, sceClibStrnlen(reg_path, (STRING_BUFFER_DEFAULT_SIZE)) + 1);
+	hash = hash_fnv1a64_update(hash, key_name, sceClibStrnlen(key_name, (STRING_BUFFER_DEFAULT_SIZE)));
+
+	return hash;
+}
+
+// returns link to matching entry, or to end of bucket list
+static struct Reg_Cache_Entry **find_reg_cache_entry(const char *const reg_path, const char *const key_name, unsigned long long hash)
+{
+	struct Reg_Cache_Entry **entry_ptr;
+
+	entry_ptr = &(reg_cache_buckets[hash & ((REG_CACHE_BUCKETS) - 1)]);
+	while (*entry_ptr != NULL) {
+		if (((*entry_ptr)->hash == hash) && (sceClibStrcmp((*entry_ptr)->key_name, key_name) == 0) && (sceClibStrcmp((*entry_ptr)->reg_path, reg_path) == 0)) {
+			break;
+		}
+		entry_ptr = &((*entry_ptr)->next);
+	}
+
+	return entry_ptr;
+}
+
+static void drop_reg_cache_entry(struct Reg_Cache_Entry **entry_ptr)
+{
+	struct Reg_Cache_Entry *entry;
+
+	entry = *entry_ptr;
+	*entry_ptr = entry->next;
+	free(entry);
+
+	return;
+}
+
+static void store_reg_cache_entry(const char *const reg_path, const char *const key_name, unsigned long long hash, int key_type, const void *value, int size)
+{
+	struct Reg_Cache_Entry **entry_ptr;
+	struct Reg_Cache_Entry *entry;
+	int size_path;
+	int size_name;
+
+	entry_ptr = find_reg_cache_entry(reg_path, key_name, hash);
+	if (*entry_ptr != NULL) {
+		drop_reg_cache_entry(entry_ptr);
+	}
+
+	size_path = sceClibStrnlen(reg_path, (STRING_BUFFER_DEFAULT_SIZE)) + 1;
+	size_name = sceClibStrnlen(key_name, (STRING_BUFFER_DEFAULT_SIZE)) + 1;
+	entry = (struct Reg_Cache_Entry *)malloc(sizeof(struct Reg_Cache_Entry) + size_path + size_name + size);
+	if (entry == NULL) {  // key just stays uncached
+		return;
+	}
+	entry->hash = hash;
+	entry->key_type = key_type;
+	entry->size = size;
+	entry->reg_path = (const char *)&(entry[1]);
+	entry->key_name = entry->reg_path + size_path;
+	entry->value = (unsigned char *)(entry->key_name + size_name);
+	sceClibMemcpy((void *)(entry->reg_path), reg_path, size_path - 1);
+	((char *)(entry->reg_path))[size_path - 1] = '\0';
+	sceClibMemcpy((void *)(entry->key_name), key_name, size_name - 1);
+	((char *)(entry->key_name))[size_name - 1] = '\0';
+	sceClibMemcpy(entry->value, value, size);
+
+	entry_ptr = &(reg_cache_buckets[hash & ((REG_CACHE_BUCKETS) - 1)]);
+	entry->next = *entry_ptr;
+	*entry_ptr = entry;
+
+	return;
+}
+
+static int get_reg_cache_key(const char *const reg_path, const char *const key_name, int key_type, void *value, int size)
+{
+	unsigned long long hash;
+	struct Reg_Cache_Entry *entry;
+	int result;
+
+	// serve from cache when type matches and enough data is cached
+	hash = hash_reg_cache_key(reg_path, key_name);
+	entry = *find_reg_cache_entry(reg_path, key_name, hash);
+	if ((entry != NULL) && (entry->key_type == key_type) && (entry->size >= size)) {
+		reg_cache_stats.hits++;
+		sceClibMemcpy(value, entry->value, size);
+		return 0;
+	}
+	reg_cache_stats.misses++;
+
+	if (key_type == (KEY_TYPE_INT)) {
+		result = sceRegMgrGetKeyInt(reg_path, key_name, (int *)value);
+	} else if (key_type == (KEY_TYPE_STR)) {
+		result = sceRegMgrGetKeyStr(reg_path, key_name, (char *)value, size);
+	} else {
+		result = sceRegMgrGetKeyBin(reg_path, key_name, value, size);
+	}
+	if (result >= 0) {
+		store_reg_cache_entry(reg_path, key_name, hash, key_type, value, size);
+	}
+
+	return result;
+}
+
+static int set_reg_cache_key(const char *const reg_path, const char *const key_name, int key_type, const void *value, int size)
+{
+	unsigned long long hash;
+	struct Reg_Cache_Entry **entry_ptr;
+	int result;
+
+	if (key_type == (KEY_TYPE_INT)) {
+		result = sceRegMgrSetKeyInt(reg_path, key_name, *((const int *)value));
+	} else if (key_type == (KEY_TYPE_STR)) {
+		result = sceRegMgrSetKeyStr(reg_path, key_name, (char *)value, size);
+	} else {
+		result = sceRegMgrSetKeyBin(reg_path, key_name, (void *)value, size);
+	}
+
+	// written value becomes the cached value, failed writes leave the key in an unknown state
+	hash = hash_reg_cache_key(reg_path, key_name);
+	if (result >= 0) {
+		reg_cache_stats.writes++;
+		store_reg_cache_entry(reg_path, key_name, hash, key_type, value, size);
+	} else {
+		entry_ptr = find_reg_cache_entry(reg_path, key_name, hash);
+		if (*entry_ptr != NULL) {
+			reg_cache_stats.invalidations++;
+			drop_reg_cache_entry(entry_ptr);
+		}
+	}
+
+	return result;
+}
+
+int reg_cache_get_int(const char *const reg_path, const char *const key_name, int *value)
+{
+	return get_reg_cache_key(reg_path, key_name, (KEY_TYPE_INT), (void *)value, sizeof(int));
+}
+
+int reg_cache_get_str(const char *const reg_path, const char *const key_name, char *value, int size)
+{
+	return get_reg_cache_key(reg_path, key_name, (KEY_TYPE_STR), (void *)value, size);
+}
+
+int reg_cache_get_bin(const char *const reg_path, const char *const key_name, void *value, int size)
+{
+	return get_reg_cache_key(reg_path, key_name, (KEY_TYPE_BIN), value, size);
+}
+
+int reg_cache_set_int(const char *const reg_path, const char *const key_name, int value)
+{
+	return set_reg_cache_key(reg_path, key_name, (KEY_TYPE_INT), (const void *)&value, sizeof(int));
+}
+
+int reg_cache_set_str(const char *const reg_path, const char *const key_name, const char *value, int size)
+{
+	return set_reg_cache_key(reg_path, key_name, (KEY_TYPE_STR), (const void *)value, size);
+}
+
+int reg_cache_set_bin(const char *const reg_path, const char *const key_name, const void *value, int size)
+{
+	return set_reg_cache_key(reg_path, key_name, (KEY_TYPE_BIN), value, size);
+}
+
+// drop all cached keys, next reads go to the registry again
+void refresh_reg_cache(void)
+{
+	int i;
+
+	for (i = 0; i < (REG_CACHE_BUCKETS); i++) {
+		while (reg_cache_buckets[i] != NULL) {
+			drop_reg_cache_entry(&(reg_cache_buckets[i]));
+		}
+	}
+
+	return;
+}
+
+// returns percentage of reads served from cache this session
+int get_reg_cache_hit_rate(void)
+{
+	if ((reg_cache_stats.hits + reg_cache_stats.misses) <= 0) {
+		return 0;
+	}
+
+	return (reg_cache_stats.hits * 100) / (reg_cache_stats.hits + reg_cache_stats.misses);
+}
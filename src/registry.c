@@ -22,6 +22,7 @@
 #include <common.h>
 #include <dir.h>
 #include <file.h>
+#include <regcache.h>
 #include <registry.h>
 
 #include <debugScreen.h>
@@ -31,10 +32,58 @@ const char *const file_ext_bin = ".bin";
 const char *const file_ext_txt = ".txt";
 
 
+static void print_unknown_type(const struct Registry_Entry *const reg_entry, int key_type)
+{
+	printf("\e[1mUnknown type %i of registry key %s%s, skipped...\e[22m\e[0K\n", key_type, reg_entry->key_save_path, reg_entry->key_name);
+
+	return;
+}
+
+static void build_reg_layout(struct Registry_Layout *layout, const struct Registry_Data *const template_reg_data)
+{
+	int i;
+	int size;
+	int offset;
+
+	layout->key_ids = (unsigned short *)malloc(template_reg_data->reg_count * sizeof(unsigned short));
+	layout->key_types = (unsigned char *)malloc(template_reg_data->reg_count * sizeof(unsigned char));
+	layout->key_sizes = (unsigned short *)malloc(template_reg_data->reg_count * sizeof(unsigned short));
+	layout->key_offsets = (int *)malloc(template_reg_data->reg_count * sizeof(int));
+
+	offset = 0;
+	for (i = 0; i < template_reg_data->reg_count; i++) {
+		size = template_reg_data->reg_entries[i].key_size;
+		switch(template_reg_data->reg_entries[i].key_type) {
+			case KEY_TYPE_INT:
+				if (size <= 0) {
+					size = sizeof(int);
+				}
+				break;
+			case KEY_TYPE_STR:
+			case KEY_TYPE_BIN:
+				if (size <= 0) {
+					size = (REG_BUFFER_DEFAULT_SIZE);
+				}
+				break;
+			default:  // unknown type
+				print_unknown_type(&(template_reg_data->reg_entries[i]), template_reg_data->reg_entries[i].key_type);
+				size = 0;
+				break;
+		}
+		layout->key_ids[i] = (unsigned short)(template_reg_data->reg_entries[i].key_id);
+		layout->key_types[i] = (unsigned char)(template_reg_data->reg_entries[i].key_type);
+		layout->key_sizes[i] = (unsigned short)size;
+		layout->key_offsets[i] = offset;
+		offset += (size + 1 + 3) & ~3;  // plus string terminator, keep int values aligned
+	}
+	layout->values_size = offset;
+
+	return;
+}
+
 void init_reg_data(struct Registry_Data **reg_data_ptr, const struct Registry_Data *const template_reg_data)
 {
 	struct Registry_Data *reg_data;
-	int i;
 
 	if (reg_data_ptr == NULL) {
 		return;
@@ -45,36 +94,16 @@ void init_reg_data(struct Registry_Data **reg_data_ptr, const struct Registry_Da
 	}
 	reg_data = *reg_data_ptr;
 
-	// copy template to reg data plus new reg entries array
+	// copy template to reg data, entries and layout are shared, only the values blob is per reg data
 	if (template_reg_data == NULL) {
 		sceClibMemset(reg_data, 0x00, sizeof(struct Registry_Data));
 	} else {
-		sceClibMemcpy((void *)reg_data, (void *)(template_reg_data), sizeof(struct Registry_Data));
-		reg_data->reg_entries = (struct Registry_Entry *)malloc(template_reg_data->reg_size);
-		sceClibMemcpy((void *)(reg_data->reg_entries), (void *)(template_reg_data->reg_entries), template_reg_data->reg_size);
-
-		// alloc memory for each key
-		for (i = 0; i < reg_data->reg_count; i++) {
-			switch(reg_data->reg_entries[i].key_type) {
-				case KEY_TYPE_INT:
-					if (reg_data->reg_entries[i].key_size <= 0) {
-						reg_data->reg_entries[i].key_size = sizeof(int);
-					}
-					break;
-				case KEY_TYPE_STR:
-				case KEY_TYPE_BIN:
-					if (reg_data->reg_entries[i].key_size <= 0) {
-						reg_data->reg_entries[i].key_size = (REG_BUFFER_DEFAULT_SIZE);
-					}
-					break;
-				default:  // unknown type
-					// TODO: error message unknown type
-					continue;  // skip entry
-					break;
-			}
-			reg_data->reg_entries[i].key_value = (void *)malloc(reg_data->reg_entries[i].key_size);
-			sceClibMemset(reg_data->reg_entries[i].key_value, 0x00, reg_data->reg_entries[i].key_size);
+		if (template_reg_data->layout->key_offsets == NULL) {
+			build_reg_layout(template_reg_data->layout, template_reg_data);
 		}
+		sceClibMemcpy((void *)reg_data, (void *)(template_reg_data), sizeof(struct Registry_Data));
+		reg_data->values = (unsigned char *)malloc(reg_data->layout->values_size);
+		sceClibMemset(reg_data->values, 0x00, reg_data->layout->values_size);
 	}
 
 	return;
@@ -82,31 +111,25 @@ void init_reg_data(struct Registry_Data **reg_data_ptr, const struct Registry_Da
 
 void free_reg_data(struct Registry_Data *reg_data)
 {
-	int i;
-
 	if (reg_data == NULL) {
 		return;
 	}
 
-	// free memory of each key value
-	for (i = 0; i < reg_data->reg_count; i++) {
-		if (reg_data->reg_entries[i].key_value != NULL) {
-			free(reg_data->reg_entries[i].key_value);
-		}
-	}
-
-	// free memory of reg_entries array
-	free(reg_data->reg_entries);
-	reg_data->reg_entries = NULL;
+	// free memory of values blob, layout belongs to the template
+	free(reg_data->values);
+	reg_data->values = NULL;
 	reg_data->reg_count = 0;
 
 	return;
 }
 
-void save_reg_data(const char *const base_path, const struct Registry_Data *const reg_data)
+void save_reg_data(const char *const base_path, const struct Registry_Data *const reg_data, int display)
 {
 	int size_base_path;
 	char target_path[(MAX_PATH_LENGTH)+1];
+	char created_path[(MAX_PATH_LENGTH)+1];
+	int size_created;
+	int size_folder;
 	int i;
 	int size;
 	char string[(STRING_BUFFER_DEFAULT_SIZE)+1];
@@ -117,6 +140,8 @@ void save_reg_data(const char *const base_path, const struct Registry_Data *cons
 	}
 
 	string[(STRING_BUFFER_DEFAULT_SIZE)] = '\0';
+	created_path[0] = '\0';
+	size_created = -1;
 
 	// prepare target path
 	size_base_path = sceClibStrnlen(base_path, (MAX_PATH_LENGTH));
@@ -130,107 +155,204 @@ void save_reg_data(const char *const base_path, const struct Registry_Data *cons
 		if ((reg_data->reg_entries[i].key_save_path == NULL) || (reg_data->reg_entries[i].key_name == NULL)) {
 			continue;
 		}
-		if (reg_data->reg_entries[i].key_value == NULL) {
-			continue;
-		}
 
 		// build target path
 		target_path[size_base_path] = '\0';
 		sceClibStrncat(target_path, reg_data->reg_entries[i].key_save_path, (MAX_PATH_LENGTH));
-		if (reg_data->reg_entries[i].key_path_extension != NULL) {
-			sceClibStrncat(target_path, reg_data->reg_entries[i].key_path_extension, (MAX_PATH_LENGTH));
-			sceClibStrncat(target_path, slash_folder, (MAX_PATH_LENGTH));
-		}
 		sceClibStrncat(target_path, reg_data->reg_entries[i].key_name, (MAX_PATH_LENGTH));
 
-		// create target path directories
-		create_path(target_path, size_base_path, 0);
+		// create target path directories, only once per folder as keys are grouped by folder
+		size_folder = sceClibStrrchr(target_path, '/') - target_path;
+		if ((size_folder != size_created) || (sceClibStrncmp(target_path, created_path, size_folder) != 0)) {
+			create_path(target_path, size_base_path, 0);
+			sceClibStrncpy(created_path, target_path, size_folder);
+			created_path[size_folder] = '\0';
+			size_created = size_folder;
+		}
 
 		// save reg entry data as file
-		switch(reg_data->reg_entries[i].key_type) {
+		switch(reg_data->layout->key_types[i]) {
 			case KEY_TYPE_INT:
 				sceClibStrncat(target_path, file_ext_txt, (MAX_PATH_LENGTH));
-				sceClibSnprintf(string, (STRING_BUFFER_DEFAULT_SIZE), "%i", *((int *)(reg_data->reg_entries[i].key_value)));
+				sceClibSnprintf(string, (STRING_BUFFER_DEFAULT_SIZE), "%i", *((int *)(get_reg_value(reg_data, i))));
 				value = string;
-				size = sceClibStrnlen(value, (reg_data->reg_entries[i].key_size));
+				size = sceClibStrnlen(value, (reg_data->layout->key_sizes[i]));
 				break;
 			case KEY_TYPE_STR:
 				sceClibStrncat(target_path, file_ext_txt, (MAX_PATH_LENGTH));
-				value = (char *)(reg_data->reg_entries[i].key_value);
-				size = sceClibStrnlen(value, (reg_data->reg_entries[i].key_size));
+				value = (char *)(get_reg_value(reg_data, i));
+				size = sceClibStrnlen(value, (reg_data->layout->key_sizes[i]));
 				break;
 			case KEY_TYPE_BIN:
 				sceClibStrncat(target_path, file_ext_bin, (MAX_PATH_LENGTH));
-				value = (char *)(reg_data->reg_entries[i].key_value);
-				size = reg_data->reg_entries[i].key_size;
+				value = (char *)(get_reg_value(reg_data, i));
+				size = reg_data->layout->key_sizes[i];
 				break;
 			default:  // unknown type
-				// TODO: error message unknown type
+				print_unknown_type(&(reg_data->reg_entries[i]), reg_data->layout->key_types[i]);
 				continue;  // skip entry
 				break;
 		}
-		printf("\e[2mWriting %s...\e[22m\e[0K\n", &(target_path[size_base_path]));  // reg_data->reg_entries[i].key_path_extension, reg_data->reg_entries[i].key_name  // TODO
+		if (display) {
+			printf("\e[2mWriting %s...\e[22m\e[0K\n", &(target_path[size_base_path]));
+		}
 		write_file(target_path, (void *)value, size);
 	}
 }
 
+static void build_reg_path(char *reg_path, const struct Registry_Entry *const reg_entry, int slot)
+{
+	// build registry category path, slot is filled into numbered paths
+	sceClibSnprintf(reg_path, (STRING_BUFFER_DEFAULT_SIZE), reg_entry->key_path, slot);
+
+	return;
+}
+
+void get_reg_data(struct Registry_Data *reg_data, int slot)
+{
+	int i;
+	char reg_path[(STRING_BUFFER_DEFAULT_SIZE)+1];
+
+	reg_path[(STRING_BUFFER_DEFAULT_SIZE)] = '\0';
+
+	for (i = 0; i < reg_data->reg_count; i++) {
+		sceClibMemset(get_reg_value(reg_data, i), 0x00, reg_data->layout->key_sizes[i]);
+
+		build_reg_path(reg_path, &(reg_data->reg_entries[i]), slot);
+
+		switch(reg_data->layout->key_types[i]) {
+			case KEY_TYPE_INT:
+				reg_cache_get_int(reg_path, reg_data->reg_entries[i].key_name, (int *)(get_reg_value(reg_data, i)));
+				break;
+			case KEY_TYPE_STR:
+				reg_cache_get_str(reg_path, reg_data->reg_entries[i].key_name, (char *)(get_reg_value(reg_data, i)), reg_data->layout->key_sizes[i]);
+				((char *)(get_reg_value(reg_data, i)))[reg_data->layout->key_sizes[i]] = '\0';
+				break;
+			case KEY_TYPE_BIN:
+				reg_cache_get_bin(reg_path, reg_data->reg_entries[i].key_name, get_reg_value(reg_data, i), reg_data->layout->key_sizes[i]);
+				break;
+		}
+	}
+
+	return;
+}
+
 void set_reg_data(struct Registry_Data *reg_data, int slot)
+{
+	set_reg_data_diff(reg_data, slot, NULL);
+
+	return;
+}
+
+void set_reg_data_diff(struct Registry_Data *reg_data, int slot, const struct Registry_Diff *const reg_diff)
 {
 	int i;
 	char reg_path[(STRING_BUFFER_DEFAULT_SIZE)+1];
-	int size;
 
 	reg_path[(STRING_BUFFER_DEFAULT_SIZE)] = '\0';
 
 	for (i = 0; i < reg_data->reg_count; i++) {
-		if (reg_data->reg_entries[i].key_value == NULL) {
+		// only write changed keys
+		if ((reg_diff != NULL) && (i < reg_diff->count) && (!reg_diff->changed[i])) {
 			continue;
 		}
 
 		// build registry path
-		sceClibSnprintf(reg_path, (STRING_BUFFER_DEFAULT_SIZE), reg_data->reg_entries[i].key_path, slot);
-		size = sceClibStrnlen(reg_path, (STRING_BUFFER_DEFAULT_SIZE));
-		sceClibStrncat(reg_path, slash_folder, (STRING_BUFFER_DEFAULT_SIZE));
-		if (reg_data->reg_entries[i].key_path_extension != NULL) {
-			sceClibStrncat(reg_path, reg_data->reg_entries[i].key_path_extension, (STRING_BUFFER_DEFAULT_SIZE));
-			size = sceClibStrnlen(reg_path, (STRING_BUFFER_DEFAULT_SIZE));
-			sceClibStrncat(reg_path, slash_folder, (STRING_BUFFER_DEFAULT_SIZE));
+		build_reg_path(reg_path, &(reg_data->reg_entries[i]), slot);
+		printf("\e[2mSetting registry %s/%s...\e[22m\e[0K\n", reg_path, reg_data->reg_entries[i].key_name);
+
+		switch(reg_data->layout->key_types[i]) {
+			case KEY_TYPE_INT:
+				reg_cache_set_int(reg_path, reg_data->reg_entries[i].key_name, *((int *)(get_reg_value(reg_data, i))));
+				break;
+			case KEY_TYPE_STR:
+				((char *)(get_reg_value(reg_data, i)))[reg_data->layout->key_sizes[i]] = '\0';
+				reg_cache_set_str(reg_path, reg_data->reg_entries[i].key_name, (char *)(get_reg_value(reg_data, i)), reg_data->layout->key_sizes[i]);
+				break;
+			case KEY_TYPE_BIN:
+				reg_cache_set_bin(reg_path, reg_data->reg_entries[i].key_name, get_reg_value(reg_data, i), reg_data->layout->key_sizes[i]);
+				break;
 		}
-		sceClibStrncat(reg_path, reg_data->reg_entries[i].key_name, (MAX_PATH_LENGTH));
-		printf("\e[2mSetting registry %s...\e[22m\e[0K\n", reg_path);
-		reg_path[size] = '\0';
+	}
 
-		switch(reg_data->reg_entries[i].key_type) {
+	return;
+}
+
+int diff_reg_data(const struct Registry_Data *const old_data, const struct Registry_Data *const new_data, struct Registry_Diff *reg_diff)
+{
+	int i;
+	int changed;
+	const struct Registry_Layout *layout;
+	const void *old_value;
+	const void *new_value;
+
+	reg_diff->count = new_data->reg_count;
+	reg_diff->changed_count = 0;
+	reg_diff->changed = (unsigned char *)malloc(reg_diff->count);
+
+	// both data sets must be based on the same template
+	layout = new_data->layout;
+	if ((old_data == NULL) || (old_data->layout != layout) || (old_data->reg_count != new_data->reg_count)) {
+		sceClibMemset(reg_diff->changed, 0x01, reg_diff->count);
+		reg_diff->changed_count = reg_diff->count;
+		return reg_diff->changed_count;
+	}
+
+	// fast path: identical value blobs, nothing changed
+	if (sceClibMemcmp(old_data->values, new_data->values, layout->values_size) == 0) {
+		sceClibMemset(reg_diff->changed, 0x00, reg_diff->count);
+		return 0;
+	}
+
+	for (i = 0; i < new_data->reg_count; i++) {
+		old_value = get_reg_value(old_data, i);
+		new_value = get_reg_value(new_data, i);
+		changed = 1;
+		switch(layout->key_types[i]) {
 			case KEY_TYPE_INT:
-				sceRegMgrSetKeyInt(reg_path, reg_data->reg_entries[i].key_name, *((int *)(reg_data->reg_entries[i].key_value)));
+				changed = (*((const int *)old_value) != *((const int *)new_value));
 				break;
 			case KEY_TYPE_STR:
-				((char *)(reg_data->reg_entries[i].key_value))[reg_data->reg_entries[i].key_size] = '\0';
-				sceRegMgrSetKeyStr(reg_path, reg_data->reg_entries[i].key_name, (char *)(reg_data->reg_entries[i].key_value), reg_data->reg_entries[i].key_size);
+				changed = (sceClibStrncmp((const char *)old_value, (const char *)new_value, layout->key_sizes[i]) != 0);
 				break;
 			case KEY_TYPE_BIN:
-				sceRegMgrSetKeyBin(reg_path, reg_data->reg_entries[i].key_name, reg_data->reg_entries[i].key_value, reg_data->reg_entries[i].key_size);
+				changed = (sceClibMemcmp(old_value, new_value, layout->key_sizes[i]) != 0);
 				break;
 		}
+		reg_diff->changed[i] = (unsigned char)changed;
+		reg_diff->changed_count += changed;
 	}
 
+	return reg_diff->changed_count;
+}
+
+void free_reg_diff(struct Registry_Diff *reg_diff)
+{
+	free(reg_diff->changed);
+	reg_diff->changed = NULL;
+	reg_diff->count = 0;
+	reg_diff->changed_count = 0;
+
 	return;
 }
 
-void load_reg_data(const char *const base_path, struct Registry_Data *reg_data, const struct Registry_Data *const reg_init_data, const int skip_reg_id_1, const int skip_reg_id_2)
+// returns count of saved keys that were missing and got their initial value
+int load_reg_data(const char *const base_path, struct Registry_Data *reg_data, const struct Registry_Data *const reg_init_data, const int skip_reg_id_1, const int skip_reg_id_2, int display)
 {
 	int size_base_path;
 	char source_path[(MAX_PATH_LENGTH)+1];
 	int i;
 	int use_initial;
 	int size;
-	char *value;
+	int missing;
 	char string[(STRING_BUFFER_DEFAULT_SIZE)+1];
 
 	if ((base_path == NULL) || (reg_data == NULL)) {
-		return;
+		return -1;
 	}
 
+	missing = 0;
+
 	string[(STRING_BUFFER_DEFAULT_SIZE)] = '\0';
 
 	// prepare source path
@@ -241,10 +363,10 @@ void load_reg_data(const char *const base_path, struct Registry_Data *reg_data,
 
 	// load all registry data
 	for (i = 0; i < reg_data->reg_count; i++) {
-		if (reg_data->reg_entries[i].key_id == skip_reg_id_1) {  // do not read special id, already stored in reg data from folder name
+		if (reg_data->layout->key_ids[i] == skip_reg_id_1) {  // do not read special id, already stored in reg data from folder name
 			continue;
 		}
-		if (reg_data->reg_entries[i].key_id == skip_reg_id_2) {  // do not read special id, already stored in reg data from folder name
+		if (reg_data->layout->key_ids[i] == skip_reg_id_2) {  // do not read special id, already stored in reg data from folder name
 			continue;
 		}
 
@@ -254,12 +376,8 @@ void load_reg_data(const char *const base_path, struct Registry_Data *reg_data,
 			// build source path
 			source_path[size_base_path] = '\0';
 			sceClibStrncat(source_path, reg_data->reg_entries[i].key_save_path, (MAX_PATH_LENGTH));
-			if (reg_data->reg_entries[i].key_path_extension != NULL) {
-				sceClibStrncat(source_path, reg_data->reg_entries[i].key_path_extension, (MAX_PATH_LENGTH));
-				sceClibStrncat(source_path, slash_folder, (MAX_PATH_LENGTH));
-			}
 			sceClibStrncat(source_path, reg_data->reg_entries[i].key_name, (MAX_PATH_LENGTH));
-			switch(reg_data->reg_entries[i].key_type) {
+			switch(reg_data->layout->key_types[i]) {
 				case KEY_TYPE_INT:
 					sceClibStrncat(source_path, file_ext_txt, (MAX_PATH_LENGTH));
 					break;
@@ -270,60 +388,65 @@ void load_reg_data(const char *const base_path, struct Registry_Data *reg_data,
 					sceClibStrncat(source_path, file_ext_bin, (MAX_PATH_LENGTH));
 					break;
 				default:  // unknown type
-					// TODO: error message unknown type
+					print_unknown_type(&(reg_data->reg_entries[i]), reg_data->layout->key_types[i]);
 					continue;  // skip entry
 					break;
 			}
 		}
 
-		// check and read source path
-		if ((use_initial) || (!check_file_exists(source_path))) {
-			if (use_initial) {
-				printf("\e[2mUse initial %s...\e[22m\e[0K\n", &(source_path[size_base_path]));
-			} else {
-				printf("\e[2mUse initial for missing %s...\e[22m\e[0K\n", &(source_path[size_base_path]));
-			}
-			switch(reg_data->reg_entries[i].key_type) {
+		// read source path directly into key value
+		size = -1;
+		if (!use_initial) {
+			switch(reg_data->layout->key_types[i]) {
 				case KEY_TYPE_INT:
-					*((int *)(reg_data->reg_entries[i].key_value)) = *((int *)(reg_init_data->reg_entries[i].key_value));
+					size = read_file(source_path, (void *)string, (STRING_BUFFER_DEFAULT_SIZE) - 1);
+					if (size >= 0) {
+						string[size] = '\0';
+						*((int *)(get_reg_value(reg_data, i))) = atoi(string);
+					}
 					break;
 				case KEY_TYPE_STR:
-					sceClibStrncpy((char *)(reg_data->reg_entries[i].key_value), (char *)(reg_init_data->reg_entries[i].key_value), (reg_data->reg_entries[i].key_size) - 1);
-					((char *)(reg_data->reg_entries[i].key_value))[reg_data->reg_entries[i].key_size] = '\0';
+					size = read_file(source_path, get_reg_value(reg_data, i), (reg_data->layout->key_sizes[i]) - 1);
+					if (size >= 0) {
+						((char *)(get_reg_value(reg_data, i)))[size] = '\0';
+					}
 					break;
 				case KEY_TYPE_BIN:
-					sceClibMemcpy(reg_data->reg_entries[i].key_value, reg_init_data->reg_entries[i].key_value, reg_data->reg_entries[i].key_size);
-					break;
-				default:  // unknown type
-					// TODO: error message unknown type
-					continue;  // skip entry
+					size = read_file(source_path, get_reg_value(reg_data, i), reg_data->layout->key_sizes[i]);
 					break;
 			}
-		} else {
-			size = allocate_read_file(source_path, ((void **)(&value)));
-			printf("\e[2mReading %s... (%i)\e[22m\e[0K\n", &(source_path[size_base_path]), size);
-			switch(reg_data->reg_entries[i].key_type) {
-				case KEY_TYPE_INT:
-					size = min(size, (STRING_BUFFER_DEFAULT_SIZE) - 1);
-					sceClibMemcpy((void *)string, (void *)value, size);
-					string[size] = '\0';
-					*((int *)(reg_data->reg_entries[i].key_value)) = atoi(string);
-					break;
-				case KEY_TYPE_STR:
-					size = min(size, (reg_data->reg_entries[i].key_size) - 1);
-					sceClibStrncpy((char *)(reg_data->reg_entries[i].key_value), value, size);
-					((char *)(reg_data->reg_entries[i].key_value))[size] = '\0';
-					break;
-				case KEY_TYPE_BIN:
-					size = min(size, reg_data->reg_entries[i].key_size);
-					sceClibMemcpy(reg_data->reg_entries[i].key_value, (void *)value, size);
-					break;
-				default:  // unknown type
-					// TODO: error message unknown type
-					continue;  // skip entry
-					break;
+			if (size >= 0) {
+				if (display) {
+					printf("\e[2mReading %s... (%i)\e[22m\e[0K\n", &(source_path[size_base_path]), size);
+				}
+				continue;
+			}
+		}
+
+		// use initial value for unsaved or missing keys
+		if (!use_initial) {
+			missing++;
+		}
+		if (display) {
+			if (use_initial) {
+				printf("\e[2mUse initial %s...\e[22m\e[0K\n", &(source_path[size_base_path]));
+			} else {
+				printf("\e[2mUse initial for missing %s...\e[22m\e[0K\n", &(source_path[size_base_path]));
 			}
-			free(value);
+		}
+		switch(reg_data->layout->key_types[i]) {
+			case KEY_TYPE_INT:
+				*((int *)(get_reg_value(reg_data, i))) = *((int *)(get_reg_value(reg_init_data, i)));
+				break;
+			case KEY_TYPE_STR:
+				sceClibStrncpy((char *)(get_reg_value(reg_data, i)), (char *)(get_reg_value(reg_init_data, i)), (reg_data->layout->key_sizes[i]) - 1);
+				((char *)(get_reg_value(reg_data, i)))[reg_data->layout->key_sizes[i]] = '\0';
+				break;
+			case KEY_TYPE_BIN:
+				sceClibMemcpy(get_reg_value(reg_data, i), get_reg_value(reg_init_data, i), reg_data->layout->key_sizes[i]);
+				break;
 		}
 	}
+
+	return missing;
 }
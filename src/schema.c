@@ -0,0 +1,56 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <vitasdk.h>
+
+#include <common.h>
+#include <schema.h>
+
+#include <reg_schema_tables.h>  // generated key table and id index
+
+
+// direct lookup, the key id indexes the generated table
+const struct Schema_Key *get_schema_key(int key_id)
+{
+	if ((key_id < 0) || (key_id > (REG_SCHEMA_MAX_ID)) || (reg_schema_index_by_id[key_id] < 0)) {
+		return NULL;
+	}
+
+	return &(reg_schema_keys[reg_schema_index_by_id[key_id]]);
+}
+
+const char *get_schema_key_name(const struct Schema_Key *const schema_key)
+{
+	return &(schema_key->key[schema_key->size_path + 1]);
+}
+
+// build registry category path, slot is filled into numbered folders
+void build_schema_key_path(char *reg_path, const struct Schema_Key *const schema_key, int slot)
+{
+	char path[(STRING_BUFFER_DEFAULT_SIZE)+1];
+	int size;
+
+	size = min(schema_key->size_path, (STRING_BUFFER_DEFAULT_SIZE));
+	sceClibMemcpy(path, schema_key->key, size);
+	path[size] = '\0';
+	sceClibSnprintf(reg_path, (STRING_BUFFER_DEFAULT_SIZE), path, slot);
+
+	return;
+}
@@ -0,0 +1,100 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>  // for atoi(), free()
+#include <vitasdk.h>
+
+#include <common.h>
+#include <file.h>
+#include <main.h>
+#include <settings.h>
+
+const char *const settings_file = "settings.txt";
+
+#define SETTINGS_SCRATCH_SIZE 4096
+
+struct Settings app_settings = {
+	.compress_blobs = 0,
+	.fast_switch = 1,
+	.full_snapshot = 1,
+	.keep_trophies = 0,
+	.scrub_mlog = 0,
+};
+
+struct Setting_Entry settings_entries[] = {
+	{ "compress_blobs", &app_settings.compress_blobs, },
+	{ "fast_switch", &app_settings.fast_switch, },
+	{ "full_snapshot", &app_settings.full_snapshot, },
+	{ "keep_trophies", &app_settings.keep_trophies, },
+	{ "scrub_mlog", &app_settings.scrub_mlog, },
+};
+
+
+void load_settings(void)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	char line[(STRING_BUFFER_DEFAULT_SIZE)+1];
+	char scratch[(SETTINGS_SCRATCH_SIZE)];
+	struct Scratch_Arena arena;
+	char *data;
+	const char *pos;
+	char *value;
+	int size;
+	int allocated;
+	int i;
+
+	// build settings path
+	path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, settings_file, (MAX_PATH_LENGTH));
+
+	// read into scratch memory, only large settings need heap memory
+	init_scratch_arena(&arena, scratch, sizeof(scratch));
+	allocated = 0;
+	size = arena_read_file(&arena, path, (void **)(&data));
+	if (size == -1) {
+		size = allocate_read_file(path, (void **)(&data));
+		allocated = 1;
+	}
+	if (size < 0) {
+		return;
+	}
+
+	// parse "name=value" lines, "#" starts a comment line
+	pos = data;
+	while (read_text_line(&pos, data + size, line, (STRING_BUFFER_DEFAULT_SIZE)) >= 0) {
+		if ((line[0] == '#') || ((value = sceClibStrchr(line, '=')) == NULL)) {
+			continue;
+		}
+		*value++ = '\0';
+
+		for (i = 0; i < (sizeof(settings_entries) / sizeof(settings_entries[0])); i++) {
+			if (sceClibStrcmp(line, settings_entries[i].name) == 0) {
+				*(settings_entries[i].value) = atoi(value);
+				break;
+			}
+		}
+	}
+	if (allocated) {
+		free(data);
+	}
+
+	return;
+}
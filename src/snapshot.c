@@ -0,0 +1,587 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>  // for malloc(), free()
+#include <vitasdk.h>
+
+#include <account.h>
+#include <common.h>
+#include <dir.h>
+#include <file.h>
+#include <main.h>
+#include <regcache.h>
+#include <registry.h>
+#include <schema.h>
+#include <settings.h>
+#include <snapshot.h>
+#include <wlan.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+const char *const snapshots_folder = "snapshots/";
+const char *const file_ext_snap = ".snap";
+const char *const full_snapshot_name = "registry";
+const char *const account_snapshot_name = "account";
+const char *const wlan_snapshot_name = "wlan_%02i";  // slot number
+const char reg_snapshot_magic[4] = { 'V', 'A', 'M', 'S', };
+const char reg_full_snapshot_magic[4] = { 'V', 'A', 'M', 'R', };
+
+#define REG_SNAPSHOT_VERSION 1
+#define REG_FULL_VALUE_SIZE 2048  // largest binary key of schema is below
+
+
+static int get_snapshot_value_size(const struct Registry_Data *const reg_data, int i)
+{
+	switch(reg_data->layout->key_types[i]) {
+		case KEY_TYPE_INT:
+			return sizeof(int);
+		case KEY_TYPE_STR:  // only used part of string
+			return sceClibStrnlen((char *)get_reg_value(reg_data, i), reg_data->layout->key_sizes[i]);
+		case KEY_TYPE_BIN:
+			return reg_data->layout->key_sizes[i];
+	}
+
+	return -1;
+}
+
+int capture_reg_snapshot(const struct Registry_Data *const reg_data, struct Reg_Snapshot *snapshot)
+{
+	struct Reg_Snapshot_Header header;
+	struct Reg_Snapshot_Key key;
+	int i;
+	int size;
+	int offset;
+
+	// determine image size
+	size = sizeof(header);
+	for (i = 0; i < reg_data->reg_count; i++) {
+		size += sizeof(key) + get_snapshot_value_size(reg_data, i);
+	}
+
+	snapshot->data = (unsigned char *)malloc(size);
+	if (snapshot->data == NULL) {
+		snapshot->size = 0;
+		return -1;
+	}
+	snapshot->size = size;
+
+	// serialize keys
+	offset = sizeof(header);
+	header.count = 0;
+	for (i = 0; i < reg_data->reg_count; i++) {
+		key.key_id = reg_data->layout->key_ids[i];
+		key.key_type = (unsigned short)(reg_data->layout->key_types[i]);
+		key.size = (unsigned short)get_snapshot_value_size(reg_data, i);
+		sceClibMemcpy(&(snapshot->data[offset]), &key, sizeof(key));
+		offset += sizeof(key);
+		sceClibMemcpy(&(snapshot->data[offset]), get_reg_value(reg_data, i), key.size);
+		offset += key.size;
+		header.count++;
+	}
+	sceClibMemcpy(header.magic, reg_snapshot_magic, sizeof(header.magic));
+	header.version = (REG_SNAPSHOT_VERSION);
+	sceClibMemcpy(snapshot->data, &header, sizeof(header));
+
+	return snapshot->size;
+}
+
+int restore_reg_snapshot(const struct Reg_Snapshot *const snapshot, struct Registry_Data *reg_data)
+{
+	struct Reg_Snapshot_Header header;
+	struct Reg_Snapshot_Key key;
+	int i, j, n;
+	int found;
+	int offset;
+	int size;
+	int restored;
+
+	if ((snapshot->data == NULL) || (snapshot->size < (int)sizeof(header))) {
+		return -1;
+	}
+	sceClibMemcpy(&header, snapshot->data, sizeof(header));
+	if ((sceClibMemcmp(header.magic, reg_snapshot_magic, sizeof(header.magic)) != 0) || (header.version != (REG_SNAPSHOT_VERSION))) {
+		return -1;
+	}
+
+	// deserialize keys into matching entries, keys are stored in template order
+	restored = 0;
+	offset = sizeof(header);
+	j = 0;
+	for (i = 0; i < header.count; i++) {
+		if ((offset + (int)sizeof(key)) > snapshot->size) {
+			return -1;
+		}
+		sceClibMemcpy(&key, &(snapshot->data[offset]), sizeof(key));
+		offset += sizeof(key);
+		if ((offset + key.size) > snapshot->size) {
+			return -1;
+		}
+
+		// find matching entry, search continues after last match
+		found = -1;
+		for (n = 0; n < reg_data->reg_count; n++) {
+			if (reg_data->layout->key_ids[j] == key.key_id) {
+				found = j;
+				break;
+			}
+			j = (j + 1) % reg_data->reg_count;
+		}
+		if ((found >= 0) && (reg_data->layout->key_types[j] == key.key_type)) {
+			size = min(key.size, reg_data->layout->key_sizes[j]);
+			sceClibMemset(get_reg_value(reg_data, j), 0x00, reg_data->layout->key_sizes[j]);
+			sceClibMemcpy(get_reg_value(reg_data, j), &(snapshot->data[offset]), size);
+			restored++;
+		}
+		offset += key.size;
+	}
+
+	return restored;
+}
+
+void free_reg_snapshot(struct Reg_Snapshot *snapshot)
+{
+	free(snapshot->data);
+	snapshot->data = NULL;
+	snapshot->size = 0;
+
+	return;
+}
+
+static void build_snapshot_path(char *path, const char *const name)
+{
+	path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, snapshots_folder, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, name, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, file_ext_snap, (MAX_PATH_LENGTH));
+
+	return;
+}
+
+int save_reg_snapshot(const char *const name, const struct Reg_Snapshot *const snapshot)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+
+	build_snapshot_path(path, name);
+	create_path(path, 0, 0);
+
+	return write_file(path, snapshot->data, snapshot->size);
+}
+
+int load_reg_snapshot(const char *const name, struct Reg_Snapshot *snapshot)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+
+	build_snapshot_path(path, name);
+	snapshot->size = allocate_read_file(path, (void **)(&(snapshot->data)));
+	if (snapshot->size < 0) {
+		snapshot->data = NULL;
+		return -1;
+	}
+
+	return snapshot->size;
+}
+
+int save_reg_data_snapshot(const char *const name, const struct Registry_Data *const reg_data)
+{
+	struct Reg_Snapshot snapshot;
+	int result;
+
+	result = capture_reg_snapshot(reg_data, &snapshot);
+	if (result >= 0) {
+		result = save_reg_snapshot(name, &snapshot);
+		free_reg_snapshot(&snapshot);
+	}
+
+	return result;
+}
+
+// section images only describe the last registry change, older ones are removed before the next change
+void clear_reg_section_snapshots(void)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	char name[16];
+	int slot;
+
+	build_snapshot_path(path, account_snapshot_name);
+	sceIoRemove(path);
+	for (slot = 1; slot <= (MAX_WLAN); slot++) {
+		sceClibSnprintf(name, sizeof(name), wlan_snapshot_name, slot);
+		build_snapshot_path(path, name);
+		sceIoRemove(path);
+	}
+
+	return;
+}
+
+int snapshot_reg_section(const char *const name, const struct Registry_Data *const template_reg_data, int slot)
+{
+	struct Registry_Data *reg_data;
+	int result;
+
+	// read section from registry and store its image
+	reg_data = NULL;
+	init_reg_data(&reg_data, template_reg_data);
+	get_reg_data(reg_data, slot);
+
+	result = save_reg_data_snapshot(name, reg_data);
+
+	free_reg_data(reg_data);
+	free(reg_data);
+
+	return result;
+}
+
+// read key value directly into buffer of at least key size plus terminator, returns used size
+static int read_schema_key(const struct Schema_Key *const schema_key, int slot, unsigned char *value)
+{
+	char reg_path[(STRING_BUFFER_DEFAULT_SIZE)+1];
+	const char *key_name;
+	int int_value;
+	int result;
+
+	reg_path[(STRING_BUFFER_DEFAULT_SIZE)] = '\0';
+	build_schema_key_path(reg_path, schema_key, slot);
+	key_name = get_schema_key_name(schema_key);
+
+	// snapshot reads bypass the registry cache, values in the image are unaligned
+	if (schema_key->key_type == (KEY_TYPE_INT)) {
+		result = sceRegMgrGetKeyInt(reg_path, key_name, &int_value);
+		if (result >= 0) {
+			sceClibMemcpy(value, &int_value, sizeof(int));
+			result = sizeof(int);
+		}
+	} else if (schema_key->key_type == (KEY_TYPE_STR)) {
+		sceClibMemset(value, 0x00, schema_key->key_size + 1);
+		result = sceRegMgrGetKeyStr(reg_path, key_name, (char *)value, schema_key->key_size);
+		if (result >= 0) {  // only used part of string
+			result = sceClibStrnlen((char *)value, schema_key->key_size);
+		}
+	} else {
+		result = sceRegMgrGetKeyBin(reg_path, key_name, value, schema_key->key_size);
+		if (result >= 0) {
+			result = schema_key->key_size;
+		}
+	}
+
+	return result;
+}
+
+static int write_schema_key(const struct Schema_Key *const schema_key, int slot, unsigned char *value)
+{
+	char reg_path[(STRING_BUFFER_DEFAULT_SIZE)+1];
+	const char *key_name;
+	int int_value;
+
+	reg_path[(STRING_BUFFER_DEFAULT_SIZE)] = '\0';
+	build_schema_key_path(reg_path, schema_key, slot);
+	key_name = get_schema_key_name(schema_key);
+
+	if (schema_key->key_type == (KEY_TYPE_INT)) {
+		sceClibMemcpy(&int_value, value, sizeof(int));
+		return reg_cache_set_int(reg_path, key_name, int_value);
+	} else if (schema_key->key_type == (KEY_TYPE_STR)) {
+		return reg_cache_set_str(reg_path, key_name, (char *)value, schema_key->key_size);
+	}
+
+	return reg_cache_set_bin(reg_path, key_name, value, schema_key->key_size);
+}
+
+int capture_full_reg_snapshot(struct Reg_Snapshot *snapshot)
+{
+	struct Reg_Snapshot_Header header;
+	struct Reg_Full_Snapshot_Key key;
+	const struct Schema_Key *schema_key;
+	int i;
+	int slot;
+	int size;
+	int offset;
+
+	// upper bound of image size, values are read straight into the image
+	size = sizeof(header);
+	for (i = 0; i < (REG_SCHEMA_KEY_COUNT); i++) {
+		schema_key = &(reg_schema_keys[i]);
+		size += (schema_key->slot_max - schema_key->slot_min + 1) * (sizeof(key) + max(schema_key->key_size, (int)sizeof(int)) + 1);
+	}
+
+	snapshot->data = (unsigned char *)malloc(size);
+	if (snapshot->data == NULL) {
+		snapshot->size = 0;
+		return -1;
+	}
+
+	// serialize all keys of all slots, keys that cannot be read are skipped
+	offset = sizeof(header);
+	header.count = 0;
+	for (i = 0; i < (REG_SCHEMA_KEY_COUNT); i++) {
+		schema_key = &(reg_schema_keys[i]);
+		for (slot = schema_key->slot_min; slot <= schema_key->slot_max; slot++) {
+			size = read_schema_key(schema_key, slot, &(snapshot->data[offset + sizeof(key)]));
+			if (size < 0) {
+				continue;
+			}
+			key.key_id = (unsigned short)(schema_key->key_id);
+			key.slot = (unsigned char)slot;
+			key.key_type = (unsigned char)(schema_key->key_type);
+			key.size = (unsigned short)size;
+			sceClibMemcpy(&(snapshot->data[offset]), &key, sizeof(key));
+			offset += sizeof(key) + size;
+			header.count++;
+		}
+	}
+	sceClibMemcpy(header.magic, reg_full_snapshot_magic, sizeof(header.magic));
+	header.version = (REG_SNAPSHOT_VERSION);
+	sceClibMemcpy(snapshot->data, &header, sizeof(header));
+	snapshot->size = offset;
+
+	return snapshot->size;
+}
+
+// only keys whose current value differs from the image are written
+int restore_full_reg_snapshot(const struct Reg_Snapshot *const snapshot, struct Reg_Full_Stats *stats)
+{
+	struct Reg_Snapshot_Header header;
+	struct Reg_Full_Snapshot_Key key;
+	const struct Schema_Key *schema_key;
+	unsigned char current[(REG_FULL_VALUE_SIZE)+1];
+	unsigned char value[(REG_FULL_VALUE_SIZE)+1];
+	int i;
+	int offset;
+	int size;
+
+	sceClibMemset(stats, 0, sizeof(struct Reg_Full_Stats));
+	if ((snapshot->data == NULL) || (snapshot->size < (int)sizeof(header))) {
+		return -1;
+	}
+	sceClibMemcpy(&header, snapshot->data, sizeof(header));
+	if ((sceClibMemcmp(header.magic, reg_full_snapshot_magic, sizeof(header.magic)) != 0) || (header.version != (REG_SNAPSHOT_VERSION))) {
+		return -1;
+	}
+
+	offset = sizeof(header);
+	for (i = 0; i < header.count; i++) {
+		if ((offset + (int)sizeof(key)) > snapshot->size) {
+			return -1;
+		}
+		sceClibMemcpy(&key, &(snapshot->data[offset]), sizeof(key));
+		offset += sizeof(key);
+		if ((offset + key.size) > snapshot->size) {
+			return -1;
+		}
+		stats->keys++;
+
+		// key must still match the schema of this build
+		schema_key = get_schema_key(key.key_id);
+		if ((schema_key == NULL) || (schema_key->key_type != key.key_type) || (key.slot < schema_key->slot_min) || (key.slot > schema_key->slot_max) || (key.size > schema_key->key_size) || (schema_key->key_size > (REG_FULL_VALUE_SIZE))) {
+			stats->failed++;
+			offset += key.size;
+			continue;
+		}
+
+		sceClibMemset(value, 0x00, schema_key->key_size + 1);
+		sceClibMemcpy(value, &(snapshot->data[offset]), key.size);
+		offset += key.size;
+
+		size = read_schema_key(schema_key, key.slot, current);
+		if ((size == key.size) && (sceClibMemcmp(current, value, size) == 0)) {
+			continue;
+		}
+		if (write_schema_key(schema_key, key.slot, value) < 0) {
+			stats->failed++;
+		} else {
+			stats->changed++;
+		}
+	}
+
+	return stats->changed;
+}
+
+// safety image of the complete registry before risky operations
+int snapshot_full_registry(void)
+{
+	struct Reg_Snapshot snapshot;
+	SceUInt64 time_start;
+	int result;
+
+	if (!app_settings.full_snapshot) {
+		return 0;
+	}
+
+	time_start = sceKernelGetProcessTimeWide();
+	result = capture_full_reg_snapshot(&snapshot);
+	if (result >= 0) {
+		result = save_reg_snapshot(full_snapshot_name, &snapshot);
+		printf("\e[2mFull registry snapshot: %i bytes in %u ms.\e[22m\e[0K\n", snapshot.size, (unsigned int)((sceKernelGetProcessTimeWide() - time_start) / 1000));
+		free_reg_snapshot(&snapshot);
+	}
+	if (result < 0) {
+		printf("\e[1mFull registry snapshot failed (0x%08x)!\e[22m\e[0K\n", result);
+	}
+
+	return result;
+}
+
+// list keys of a section that differ from its image, returns number of changed keys or -1 without valid image
+static int show_reg_section_change(const char *const name, const char *const label, const struct Registry_Data *const template_reg_data, int slot)
+{
+	struct Reg_Snapshot snapshot;
+	struct Registry_Data *old_data;
+	struct Registry_Data *live_data;
+	struct Registry_Diff reg_diff;
+	char reg_path[(STRING_BUFFER_DEFAULT_SIZE)+1];
+	int result;
+	int i;
+
+	if (load_reg_snapshot(name, &snapshot) < 0) {
+		return -1;
+	}
+
+	// keys missing in image keep their live value
+	live_data = NULL;
+	init_reg_data(&live_data, template_reg_data);
+	get_reg_data(live_data, slot);
+	old_data = NULL;
+	init_reg_data(&old_data, template_reg_data);
+	sceClibMemcpy(old_data->values, live_data->values, live_data->layout->values_size);
+	result = restore_reg_snapshot(&snapshot, old_data);
+	free_reg_snapshot(&snapshot);
+
+	if (result < 0) {
+		printf("\e[1m%s: invalid snapshot!\e[22m\e[0K\n", label);
+	} else {
+		result = diff_reg_data(old_data, live_data, &reg_diff);
+		printf("%s: %i of %i registry keys changed.\e[0K\n", label, reg_diff.changed_count, reg_diff.count);
+		reg_path[(STRING_BUFFER_DEFAULT_SIZE)] = '\0';
+		for (i = 0; i < reg_diff.count; i++) {
+			if (!reg_diff.changed[i]) {
+				continue;
+			}
+			sceClibSnprintf(reg_path, (STRING_BUFFER_DEFAULT_SIZE), live_data->reg_entries[i].key_path, slot);
+			printf("\e[2m  %s/%s\e[22m\e[0K\n", reg_path, live_data->reg_entries[i].key_name);
+		}
+		free_reg_diff(&reg_diff);
+	}
+
+	free_reg_data(old_data);
+	free(old_data);
+	free_reg_data(live_data);
+	free(live_data);
+
+	return result;
+}
+
+// dry run of undoing the last switch/removal or WLAN restore, nothing is written
+void show_last_reg_change(char *title)
+{
+	char name[16];
+	char label[16];
+	int sections;
+	int slot;
+
+	// draw title line
+	draw_title_line(title);
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
+
+	sections = 0;
+	if (show_reg_section_change(account_snapshot_name, "Account", &template_account_reg_data, -1) >= 0) {
+		sections++;
+	}
+	for (slot = 1; slot <= (MAX_WLAN); slot++) {
+		sceClibSnprintf(name, sizeof(name), wlan_snapshot_name, slot);
+		sceClibSnprintf(label, sizeof(label), "WLAN #%02i", slot);
+		if (show_reg_section_change(name, label, &template_wlan_reg_data, slot) >= 0) {
+			sections++;
+		}
+	}
+	if (sections == 0) {
+		printf("No registry snapshot of a previous change found!\e[0K\n");
+	} else {
+		printf("Restore the full registry snapshot to undo these changes.\e[0K\n");
+	}
+	wait_for_cancel_button();
+
+	return;
+}
+
+void save_full_registry(char *title)
+{
+	struct Reg_Snapshot snapshot;
+	SceUInt64 time_start;
+	int result;
+
+	// draw title line
+	draw_title_line(title);
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
+
+	time_start = sceKernelGetProcessTimeWide();
+	result = capture_full_reg_snapshot(&snapshot);
+	if (result >= 0) {
+		printf("%i registry keys read.\e[0K\n", ((struct Reg_Snapshot_Header *)(snapshot.data))->count);
+		result = save_reg_snapshot(full_snapshot_name, &snapshot);
+		free_reg_snapshot(&snapshot);
+	}
+	if (result < 0) {
+		printf("\e[1mFailed to save full registry snapshot (0x%08x)!\e[22m\e[0K\n", result);
+	} else {
+		printf("Full registry snapshot saved in %u ms!\e[0K\n", (unsigned int)((sceKernelGetProcessTimeWide() - time_start) / 1000));
+	}
+	wait_for_cancel_button();
+
+	return;
+}
+
+int restore_full_registry(char *title)
+{
+	struct Reg_Snapshot snapshot;
+	struct Reg_Full_Stats stats;
+	SceUInt64 time_start;
+	int result;
+
+	// draw title line
+	draw_title_line(title);
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
+
+	time_start = sceKernelGetProcessTimeWide();
+	result = load_reg_snapshot(full_snapshot_name, &snapshot);
+	if (result >= 0) {
+		result = restore_full_reg_snapshot(&snapshot, &stats);
+		free_reg_snapshot(&snapshot);
+	}
+	if (result < 0) {
+		printf("\e[1mNo valid full registry snapshot found!\e[22m\e[0K\n");
+	} else {
+		printf("%i of %i registry keys changed", stats.changed, stats.keys);
+		if (stats.failed > 0) {
+			printf(", \e[1m%i failed\e[22m", stats.failed);
+		}
+		printf(" in %u ms.\e[0K\n", (unsigned int)((sceKernelGetProcessTimeWide() - time_start) / 1000));
+		printf("Full registry snapshot restored!\nReboot so changes take effect!\e[0K\n");
+	}
+	wait_for_cancel_button();
+
+	return (result > 0);
+}
@@ -0,0 +1,266 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>  // for malloc(), free()
+#include <vitasdk.h>
+
+#include <account.h>
+#include <blob.h>
+#include <dir.h>
+#include <file.h>
+#include <trophy.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+// complete trophy data incl. sce_trop/TRPUSER.DAT, sce_trop/sce_pfs/files.db and per-title folders
+const char *const trophy_data_path = "ur0:user/00/trophy/data/";
+const char *const trophy_folder = "trophy/";
+
+// state while archiving trophy folder into account manifest
+struct Trophy_Archive {
+	struct Blob_Store *store;
+	struct Manifest_Data *manifest;
+	unsigned char *seen;  // trophy entries of manifest still present
+	int count_seen;
+	struct Trophy_Stats *stats;
+};
+
+
+static int is_trophy_save_path(const char *save_path)
+{
+	return (sceClibStrncmp(save_path, trophy_folder, sceClibStrnlen(trophy_folder, (MANIFEST_PATH_SIZE))) == 0);
+}
+
+int is_trophy_file_entry(const struct File_Entry *const file_entry)
+{
+	if (file_entry->file_path == NULL) {
+		return 0;
+	}
+
+	return (sceClibStrncmp(file_entry->file_path, trophy_data_path, sceClibStrnlen(trophy_data_path, (MAX_PATH_LENGTH))) == 0);
+}
+
+int check_trophy_archive(const struct Manifest_Data *const manifest)
+{
+	int i;
+
+	for (i = 0; i < manifest->count; i++) {
+		if (is_trophy_save_path(manifest->entries[i].save_path)) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void archive_trophy_file(struct Trophy_Archive *archive, const char *source_path, const char *save_path)
+{
+	struct Manifest_Entry *entry;
+	unsigned long long hash;
+	unsigned int checksum;
+	int size;
+	int i;
+
+	// store file, only new content is written
+	if (store_blob(archive->store, source_path, &hash, &size, &checksum) < 0) {
+		printf("\e[1mFailed to store %s...\e[22m\e[0K\n", source_path);
+		archive->stats->failed++;
+		return;
+	}
+	set_manifest_entry(archive->store, archive->manifest, save_path, hash, size, checksum);
+	archive->stats->files++;
+	archive->stats->bytes += size;
+
+	entry = find_manifest_entry(archive->manifest, save_path);
+	i = entry - archive->manifest->entries;
+	if (i < archive->count_seen) {
+		archive->seen[i] = 1;
+	}
+
+	return;
+}
+
+static void archive_trophy_folder(struct Trophy_Archive *archive, char *source_path, char *save_path)
+{
+	SceUID dfd;
+	SceIoDirent entry;
+	int size_path;
+	int size_save_path;
+
+	dfd = sceIoDopen(source_path);
+	if (dfd < 0) {
+		return;
+	}
+
+	size_path = sceClibStrnlen(source_path, (MAX_PATH_LENGTH));
+	size_save_path = sceClibStrnlen(save_path, (MANIFEST_PATH_SIZE));
+	sceClibMemset(&entry, 0, sizeof(SceIoDirent));
+	while (sceIoDread(dfd, &entry) > 0) {
+		source_path[size_path] = '\0';
+		sceClibStrncat(source_path, entry.d_name, (MAX_PATH_LENGTH));
+		save_path[size_save_path] = '\0';
+		sceClibStrncat(save_path, entry.d_name, (MANIFEST_PATH_SIZE));
+
+		if (SCE_S_ISDIR(entry.d_stat.st_mode)) {
+			sceClibStrncat(source_path, slash_folder, (MAX_PATH_LENGTH));
+			sceClibStrncat(save_path, slash_folder, (MANIFEST_PATH_SIZE));
+			archive_trophy_folder(archive, source_path, save_path);
+		} else {
+			archive_trophy_file(archive, source_path, save_path);
+		}
+	}
+	source_path[size_path] = '\0';
+	save_path[size_save_path] = '\0';
+	sceIoDclose(dfd);
+
+	return;
+}
+
+// store live trophy data into account at base path, drops stored files that are gone
+int archive_trophy_data(const char *base_path, struct Trophy_Stats *stats)
+{
+	struct Blob_Store blob_store;
+	struct Manifest_Data manifest;
+	struct Trophy_Archive archive;
+	char source_path[(MAX_PATH_LENGTH)+1];
+	char save_path[(MANIFEST_PATH_SIZE)+1];
+	int i;
+
+	sceClibMemset(stats, 0, sizeof(struct Trophy_Stats));
+	open_blob_store(&blob_store);
+	load_manifest(base_path, &manifest);
+
+	archive.store = &blob_store;
+	archive.manifest = &manifest;
+	archive.count_seen = manifest.count;
+	archive.seen = (unsigned char *)malloc(manifest.count + 1);
+	archive.stats = stats;
+	if (archive.seen == NULL) {
+		free_manifest(&manifest);
+		close_blob_store(&blob_store);
+		return -1;
+	}
+	sceClibMemset(archive.seen, 0, manifest.count + 1);
+
+	source_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(source_path, trophy_data_path, (MAX_PATH_LENGTH));
+	save_path[(MANIFEST_PATH_SIZE)] = '\0';
+	sceClibStrncpy(save_path, trophy_folder, (MANIFEST_PATH_SIZE));
+	archive_trophy_folder(&archive, source_path, save_path);
+
+	// remove stored trophy files that no longer exist, from the end to keep indexes valid
+	for (i = archive.count_seen - 1; i >= 0; i--) {
+		if (!archive.seen[i] && is_trophy_save_path(manifest.entries[i].save_path)) {
+			sceClibStrncpy(save_path, manifest.entries[i].save_path, (MANIFEST_PATH_SIZE));
+			remove_manifest_entry(&blob_store, &manifest, save_path);
+		}
+	}
+
+	free(archive.seen);
+	save_manifest(base_path, &manifest);
+	free_manifest(&manifest);
+	close_blob_store(&blob_store);
+
+	return stats->files;
+}
+
+static void delete_trophy_folder(char *path, int depth)
+{
+	SceUID dfd;
+	SceIoDirent entry;
+	int size_path;
+
+	dfd = sceIoDopen(path);
+	if (dfd < 0) {
+		return;
+	}
+
+	size_path = sceClibStrnlen(path, (MAX_PATH_LENGTH));
+	sceClibMemset(&entry, 0, sizeof(SceIoDirent));
+	while (sceIoDread(dfd, &entry) > 0) {
+		path[size_path] = '\0';
+		sceClibStrncat(path, entry.d_name, (MAX_PATH_LENGTH));
+		if (SCE_S_ISDIR(entry.d_stat.st_mode)) {
+			sceClibStrncat(path, slash_folder, (MAX_PATH_LENGTH));
+			delete_trophy_folder(path, depth + 1);
+		} else {
+			sceIoRemove(path);
+		}
+	}
+	sceIoDclose(dfd);
+
+	// keep trophy data folder itself
+	path[size_path] = '\0';
+	if (depth > 0) {
+		path[size_path - 1] = '\0';
+		sceIoRmdir(path);
+		path[size_path - 1] = '/';
+	}
+
+	return;
+}
+
+// replace live trophy data by the one stored in account manifest
+int restore_trophy_data(const struct Manifest_Data *const manifest, struct Trophy_Stats *stats)
+{
+	char target_path[(MAX_PATH_LENGTH)+1];
+	int size_trophy_data_path;
+	int size_trophy_folder;
+	int i;
+
+	sceClibMemset(stats, 0, sizeof(struct Trophy_Stats));
+
+	// only delete live trophy data when all stored files are available
+	for (i = 0; i < manifest->count; i++) {
+		if (is_trophy_save_path(manifest->entries[i].save_path) && (check_blob_exists(manifest->entries[i].hash) < 0)) {
+			printf("\e[1mMissing stored %s...\e[22m\e[0K\n", manifest->entries[i].save_path);
+			stats->failed++;
+		}
+	}
+	if (stats->failed > 0) {
+		return -1;
+	}
+
+	target_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(target_path, trophy_data_path, (MAX_PATH_LENGTH));
+	size_trophy_data_path = sceClibStrnlen(target_path, (MAX_PATH_LENGTH));
+	size_trophy_folder = sceClibStrnlen(trophy_folder, (MANIFEST_PATH_SIZE));
+	delete_trophy_folder(target_path, 0);
+
+	for (i = 0; i < manifest->count; i++) {
+		if (!is_trophy_save_path(manifest->entries[i].save_path)) {
+			continue;
+		}
+
+		target_path[size_trophy_data_path] = '\0';
+		sceClibStrncat(target_path, &(manifest->entries[i].save_path[size_trophy_folder]), (MAX_PATH_LENGTH));
+		create_path(target_path, 0, 0);
+		if (restore_checked_blob(&(manifest->entries[i]), target_path) < 0) {
+			printf("\e[1mFailed to restore %s...\e[22m\e[0K\n", target_path);
+			stats->failed++;
+			continue;
+		}
+		stats->files++;
+		stats->bytes += manifest->entries[i].size;
+	}
+
+	return stats->files;
+}
@@ -0,0 +1,559 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>  // for malloc(), free(), strtoull()
+#include <vitasdk.h>
+
+#include <account.h>
+#include <blob.h>
+#include <bufpool.h>
+#include <common.h>
+#include <dir.h>
+#include <file.h>
+#include <hash.h>
+#include <main.h>
+#include <registry.h>
+#include <verify.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+const char *const verify_report_file = "verify.txt";
+const char *const verify_cache_file = "verify.cache";
+
+static struct Verify_Data *verify_jobs;
+static struct Verify_Data verify_cache;
+static SceKernelLwMutexWork verify_mutex;
+static volatile int verify_next;
+static volatile int verify_done;
+
+
+static unsigned long long hash_stat(unsigned long long hash, const SceIoStat *const stat)
+{
+	hash = hash_fnv1a64_update(hash, &(stat->st_size), sizeof(stat->st_size));
+	hash = hash_fnv1a64_update(hash, &(stat->st_mtime), sizeof(stat->st_mtime));
+
+	return hash;
+}
+
+static void verify_registry(char *base_path, int size_base_path, struct Verify_Result *result)
+{
+	const struct Registry_Entry *reg_entry;
+	SceIoStat stat;
+	int size;
+	int bad;
+	int i;
+
+	// only stat saved registry values, checking presence and plausible size
+	for (i = 0; i < template_account_reg_data.reg_count; i++) {
+		reg_entry = &(template_account_reg_data.reg_entries[i]);
+		if ((reg_entry->key_save_path == NULL) || (reg_entry->key_name == NULL)) {
+			continue;
+		}
+
+		base_path[size_base_path] = '\0';
+		sceClibStrncat(base_path, reg_entry->key_save_path, (MAX_PATH_LENGTH));
+		sceClibStrncat(base_path, reg_entry->key_name, (MAX_PATH_LENGTH));
+		sceClibStrncat(base_path, ((reg_entry->key_type == KEY_TYPE_BIN) ? file_ext_bin : file_ext_txt), (MAX_PATH_LENGTH));
+
+		if (sceIoGetstat(base_path, &stat) < 0) {
+			result->keys_missing++;
+			if (i == template_account_reg_data.idx_login_id) {
+				result->status |= (VERIFY_NO_LOGIN_ID);
+			}
+			continue;
+		}
+		result->signature = hash_stat(result->signature, &stat);
+
+		size = (int)(stat.st_size);
+		switch(reg_entry->key_type) {
+			case KEY_TYPE_INT:
+				bad = ((size <= 0) || (size > 11));
+				break;
+			case KEY_TYPE_STR:
+				bad = (size > (reg_entry->key_size - 1));
+				break;
+			case KEY_TYPE_BIN:
+				bad = (size != reg_entry->key_size);
+				break;
+			default:
+				bad = 0;
+				break;
+		}
+		if (bad) {
+			result->keys_bad++;
+		}
+		if ((i == template_account_reg_data.idx_login_id) && (size <= 0)) {
+			result->status |= (VERIFY_NO_LOGIN_ID);
+		}
+	}
+	base_path[size_base_path] = '\0';
+
+	return;
+}
+
+static int verify_blob(const struct Manifest_Entry *const entry, int worker)
+{
+	char blob_path[(MAX_PATH_LENGTH)+1];
+	char temp_path[(MAX_PATH_LENGTH)+1];
+	char name[32];
+	SceIoStat stat;
+	unsigned long long hash;
+	unsigned int checksum;
+	int compressed;
+	int size;
+
+	compressed = check_blob_exists(entry->hash);
+	if (compressed < 0) {
+		return 0;
+	}
+
+	// plain blobs are checked in place, compressed ones via a temporary copy per worker
+	if (compressed) {
+		sceClibSnprintf(name, sizeof(name), "verify_%i.tmp", worker);
+		temp_path[(MAX_PATH_LENGTH)] = '\0';
+		sceClibStrncpy(temp_path, app_base_path, (MAX_PATH_LENGTH));
+		sceClibStrncat(temp_path, name, (MAX_PATH_LENGTH));
+		size = -1;
+		if (restore_blob(entry->hash, temp_path, &checksum) >= 0) {
+			if (entry->has_checksum) {  // checksum computed while decompressing, no extra read pass
+				if ((sceIoGetstat(temp_path, &stat) >= 0) && (checksum == entry->checksum)) {
+					size = (int)(stat.st_size);
+				}
+				hash = entry->hash;
+			} else {
+				size = hash_file(temp_path, &hash, NULL);
+			}
+		}
+		sceIoRemove(temp_path);
+	} else {
+		build_blob_path(blob_path, entry->hash, 0);
+		if ((sceIoGetstat(blob_path, &stat) < 0) || ((int)(stat.st_size) != entry->size)) {
+			return 0;
+		}
+		size = hash_file(blob_path, &hash, &checksum);
+		if ((entry->has_checksum) && (checksum != entry->checksum)) {
+			return 0;
+		}
+	}
+
+	return ((size == entry->size) && (hash == entry->hash));
+}
+
+static void verify_files(char *base_path, int size_base_path, const struct Manifest_Data *const manifest, struct Verify_Result *result, int worker)
+{
+	struct File_Entry *file_entry;
+	int i;
+
+	// stored files must match their checksum
+	for (i = 0; i < manifest->count; i++) {
+		if (verify_blob(&(manifest->entries[i]), worker)) {
+			result->files_ok++;
+		} else {
+			result->files_bad++;
+		}
+	}
+
+	// plain copies of older versions have no checksum, only count them
+	for (i = 0; i < template_account_file_data.file_count; i++) {
+		file_entry = &(template_account_file_data.file_entries[i]);
+		if ((file_entry->file_save_path == NULL) || (file_entry->file_name_path == NULL)) {
+			continue;
+		}
+		base_path[size_base_path] = '\0';
+		sceClibStrncat(base_path, file_entry->file_save_path, (MAX_PATH_LENGTH));
+		sceClibStrncat(base_path, file_entry->file_name_path, (MAX_PATH_LENGTH));
+		if ((find_manifest_entry(manifest, &(base_path[size_base_path])) == NULL) && check_file_exists(base_path)) {
+			result->files_ok++;
+		}
+	}
+	base_path[size_base_path] = '\0';
+
+	return;
+}
+
+static struct Verify_Result *find_cached_result(const char *username, unsigned long long signature)
+{
+	int i;
+
+	for (i = 0; i < verify_cache.count; i++) {
+		if ((verify_cache.results[i].signature == signature) && (sceClibStrncmp(verify_cache.results[i].username, username, (VERIFY_NAME_SIZE)) == 0)) {
+			return &(verify_cache.results[i]);
+		}
+	}
+
+	return NULL;
+}
+
+int verify_account(const char *username, struct Verify_Result *result, int worker)
+{
+	char base_path[(MAX_PATH_LENGTH)+1];
+	int size_base_path;
+	char blob_path[(MAX_PATH_LENGTH)+1];
+	SceIoStat stat;
+	struct Manifest_Data manifest;
+	struct Verify_Result *cached;
+	int compressed;
+	int i;
+
+	sceClibMemset(result, 0x00, sizeof(struct Verify_Result));
+	sceClibStrncpy(result->username, username, (VERIFY_NAME_SIZE));
+	result->signature = (HASH_FNV1A64_INIT);
+
+	// build account base path
+	base_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(base_path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, accounts_folder, (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, username, (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, slash_folder, (MAX_PATH_LENGTH));
+	size_base_path = sceClibStrnlen(base_path, (MAX_PATH_LENGTH));
+
+	verify_registry(base_path, size_base_path, result);
+
+	// manifest is rewritten on every save, so it changes the signature too
+	sceClibStrncat(base_path, manifest_file, (MAX_PATH_LENGTH));
+	if (sceIoGetstat(base_path, &stat) >= 0) {
+		result->signature = hash_stat(result->signature, &stat);
+	}
+	base_path[size_base_path] = '\0';
+
+	// so do the stored files themselves
+	load_manifest(base_path, &manifest);
+	for (i = 0; i < manifest.count; i++) {
+		compressed = check_blob_exists(manifest.entries[i].hash);
+		if (compressed < 0) {
+			continue;
+		}
+		build_blob_path(blob_path, manifest.entries[i].hash, compressed);
+		if (sceIoGetstat(blob_path, &stat) >= 0) {
+			result->signature = hash_stat(result->signature, &stat);
+		}
+	}
+
+	// checksums of unchanged accounts are taken from cache
+	cached = find_cached_result(username, result->signature);
+	if (cached != NULL) {
+		result->files_ok = cached->files_ok;
+		result->files_bad = cached->files_bad;
+		result->cached = 1;
+	} else {
+		verify_files(base_path, size_base_path, &manifest, result, worker);
+	}
+	free_manifest(&manifest);
+
+	if (result->keys_missing > 0) {
+		result->status |= (VERIFY_MISSING_KEYS);
+	}
+	if (result->keys_bad > 0) {
+		result->status |= (VERIFY_BAD_KEYS);
+	}
+	if (result->files_bad > 0) {
+		result->status |= (VERIFY_BAD_FILES);
+	}
+
+	return result->status;
+}
+
+static int verify_thread_main(SceSize args, void *argp)
+{
+	char username[(VERIFY_NAME_SIZE)+1];
+	int worker;
+	int job;
+
+	worker = *((int *)argp);
+	username[(VERIFY_NAME_SIZE)] = '\0';
+
+	while (1) {
+		sceKernelLockLwMutex(&verify_mutex, 1, NULL);
+		job = verify_next++;
+		sceKernelUnlockLwMutex(&verify_mutex, 1);
+		if (job >= verify_jobs->count) {
+			break;
+		}
+
+		sceClibStrncpy(username, verify_jobs->results[job].username, (VERIFY_NAME_SIZE));
+		verify_account(username, &(verify_jobs->results[job]), worker);
+
+		sceKernelLockLwMutex(&verify_mutex, 1, NULL);
+		verify_done++;
+		sceKernelUnlockLwMutex(&verify_mutex, 1);
+	}
+
+	return 0;
+}
+
+static void build_app_file_path(char *path, const char *const name)
+{
+	path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(path, name, (MAX_PATH_LENGTH));
+
+	return;
+}
+
+static void load_verify_cache(void)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	char signature_hex[17];
+	char *data;
+	char *line;
+	char *end;
+	struct Verify_Result *result;
+	int size;
+	int alloc;
+
+	verify_cache.count = 0;
+	verify_cache.results = NULL;
+
+	build_app_file_path(path, verify_cache_file);
+	data = NULL;
+	size = borrow_read_file(path, (void **)&data);
+	if (size <= 0) {
+		return_buffer(data);
+		return;
+	}
+	data[size - 1] = '\0';  // last line ends with newline
+
+	// one line per account: username signature files_ok files_bad
+	alloc = 0;
+	for (line = data; (line != NULL) && (*line != '\0'); line = ((end != NULL) ? (end + 1) : NULL)) {
+		end = sceClibStrchr(line, '\n');
+		if (end != NULL) {
+			*end = '\0';
+		}
+		if (verify_cache.count >= alloc) {
+			alloc += 16;
+			verify_cache.results = (struct Verify_Result *)realloc(verify_cache.results, alloc * sizeof(struct Verify_Result));
+		}
+		result = &(verify_cache.results[verify_cache.count]);
+		sceClibMemset(result, 0x00, sizeof(struct Verify_Result));
+		if (sscanf(line, "%64s %16s %i %i", result->username, signature_hex, &(result->files_ok), &(result->files_bad)) != 4) {
+			continue;
+		}
+		result->signature = strtoull(signature_hex, NULL, 16);
+		verify_cache.count++;
+	}
+	return_buffer(data);
+
+	return;
+}
+
+static void write_verify_files(const struct Verify_Data *const verify_data)
+{
+	char path[(MAX_PATH_LENGTH)+1];
+	char line[(STRING_BUFFER_DEFAULT_SIZE)+1];
+	const struct Verify_Result *result;
+	SceUID fd_cache;
+	SceUID fd_report;
+	int size;
+	int i;
+
+	build_app_file_path(path, verify_cache_file);
+	fd_cache = sceIoOpen(path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+	build_app_file_path(path, verify_report_file);
+	fd_report = sceIoOpen(path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+
+	if (fd_report >= 0) {
+		size = sceClibSnprintf(line, (STRING_BUFFER_DEFAULT_SIZE), "# username status keys_missing keys_bad files_ok files_bad\n");
+		sceIoWrite(fd_report, line, size);
+	}
+	for (i = 0; i < verify_data->count; i++) {
+		result = &(verify_data->results[i]);
+		if (fd_cache >= 0) {
+			size = sceClibSnprintf(line, (STRING_BUFFER_DEFAULT_SIZE), "%s %08x%08x %i %i\n", result->username, (unsigned int)(result->signature >> 32), (unsigned int)(result->signature), result->files_ok, result->files_bad);
+			sceIoWrite(fd_cache, line, size);
+		}
+		if (fd_report >= 0) {
+			size = sceClibSnprintf(line, (STRING_BUFFER_DEFAULT_SIZE), "%s %s%s%s%s%s %i %i %i %i\n", result->username,
+			  ((result->status == (VERIFY_OK)) ? "ok" : "fail"),
+			  ((result->status & (VERIFY_NO_LOGIN_ID)) ? ",no-login-id" : ""),
+			  ((result->status & (VERIFY_MISSING_KEYS)) ? ",missing-keys" : ""),
+			  ((result->status & (VERIFY_BAD_KEYS)) ? ",bad-keys" : ""),
+			  ((result->status & (VERIFY_BAD_FILES)) ? ",bad-files" : ""),
+			  result->keys_missing, result->keys_bad, result->files_ok, result->files_bad);
+			sceIoWrite(fd_report, line, size);
+		}
+	}
+
+	if (fd_report >= 0) {
+		sceIoClose(fd_report);
+	}
+	if (fd_cache >= 0) {
+		sceIoClose(fd_cache);
+	}
+
+	return;
+}
+
+int verify_all_accounts(struct Verify_Data *verify_data, int display)
+{
+	char base_path[(MAX_PATH_LENGTH)+1];
+	int size_base_path;
+	struct Dir_Entry *dirs;
+	SceUID threads[(VERIFY_THREADS)];
+	int thread_count;
+	int worker;
+	int x, y;
+	int i;
+
+	verify_data->count = 0;
+	verify_data->results = NULL;
+
+	// read account directories
+	build_app_file_path(base_path, accounts_folder);
+	size_base_path = sceClibStrnlen(base_path, (MAX_PATH_LENGTH));
+	base_path[size_base_path - 1] = '\0';
+	dirs = NULL;
+	verify_data->count = get_subdirs(base_path, &dirs);
+	if (verify_data->count <= 0) {
+		free_subdirs(dirs, verify_data->count);
+		verify_data->count = 0;
+		return 0;
+	}
+	verify_data->results = (struct Verify_Result *)malloc(verify_data->count * sizeof(struct Verify_Result));
+	if (verify_data->results == NULL) {
+		free_subdirs(dirs, verify_data->count);
+		verify_data->count = 0;
+		return -1;
+	}
+	for (i = 0; i < verify_data->count; i++) {
+		sceClibMemset(&(verify_data->results[i]), 0x00, sizeof(struct Verify_Result));
+		sceClibStrncpy(verify_data->results[i].username, dirs[i].name, (VERIFY_NAME_SIZE));
+	}
+	free_subdirs(dirs, verify_data->count);
+
+	load_verify_cache();
+
+	// worker pool takes accounts one by one
+	verify_jobs = verify_data;
+	verify_next = 0;
+	verify_done = 0;
+	sceKernelCreateLwMutex(&verify_mutex, "verify_mutex", 0, 0, NULL);
+	thread_count = 0;
+	for (i = 0; (i < (VERIFY_THREADS)) && (i < verify_data->count); i++) {
+		threads[thread_count] = sceKernelCreateThread("verify_thread", verify_thread_main, 0x10000100, 0x10000, 0, 0, NULL);
+		if (threads[thread_count] < 0) {
+			break;
+		}
+		worker = i;
+		sceKernelStartThread(threads[thread_count], sizeof(worker), &worker);
+		thread_count++;
+	}
+	if (thread_count == 0) {  // no threads available, verify in place
+		verify_thread_main(sizeof(worker), &thread_count);
+	}
+
+	// show progress while workers run
+	psvDebugScreenGetCoordsXY(NULL, &y);
+	x = 0;
+	while (verify_done < verify_data->count) {
+		if (display) {
+			psvDebugScreenSetCoordsXY(&x, &y);
+			printf("Verified %i of %i accounts...\e[0K\n", verify_done, verify_data->count);
+		}
+		sceKernelDelayThread(50000);  // 50ms
+	}
+	if (display) {
+		psvDebugScreenSetCoordsXY(&x, &y);
+		printf("\e[0K");
+	}
+
+	for (i = 0; i < thread_count; i++) {
+		sceKernelWaitThreadEnd(threads[i], NULL, NULL);
+		sceKernelDeleteThread(threads[i]);
+	}
+	sceKernelDeleteLwMutex(&verify_mutex);
+	verify_jobs = NULL;
+	free_verify_data(&verify_cache);
+
+	write_verify_files(verify_data);
+
+	return verify_data->count;
+}
+
+void free_verify_data(struct Verify_Data *verify_data)
+{
+	free(verify_data->results);
+	verify_data->results = NULL;
+	verify_data->count = 0;
+
+	return;
+}
+
+void verify_accounts(char *title)
+{
+	struct Verify_Data verify_data;
+	struct Verify_Result *result;
+	char path[(MAX_PATH_LENGTH)+1];
+	SceUInt64 time_start;
+	int failed;
+	int cached;
+	int y;
+	int i;
+
+	// draw title line
+	draw_title_line(title);
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
+
+	printf("Verifying all saved accounts...\e[0K\n");
+	time_start = sceKernelGetProcessTimeWide();
+	verify_all_accounts(&verify_data, 1);
+
+	failed = 0;
+	cached = 0;
+	for (i = 0; i < verify_data.count; i++) {
+		if (verify_data.results[i].status != (VERIFY_OK)) {
+			failed++;
+		}
+		cached += verify_data.results[i].cached;
+	}
+	printf("%i accounts verified in %u ms (%i unchanged since last run).\e[0K\n", verify_data.count, (unsigned int)((sceKernelGetProcessTimeWide() - time_start) / 1000), cached);
+	build_app_file_path(path, verify_report_file);
+	printf("Report written to %s.\e[0K\n", path);
+
+	// list accounts with problems as long as they fit on screen
+	if (failed > 0) {
+		printf("\e[1m%i accounts have problems:\e[22m\e[0K\n", failed);
+		for (i = 0; i < verify_data.count; i++) {
+			result = &(verify_data.results[i]);
+			if (result->status == (VERIFY_OK)) {
+				continue;
+			}
+			psvDebugScreenGetCoordsXY(NULL, &y);
+			if ((y + psv_font_current->size_h) > (SCREEN_HEIGHT)) {
+				break;
+			}
+			printf(" %s:%s%s%s%s\e[0K\n", result->username,
+			  ((result->status & (VERIFY_NO_LOGIN_ID)) ? " no login id" : ""),
+			  ((result->status & (VERIFY_MISSING_KEYS)) ? " missing registry values" : ""),
+			  ((result->status & (VERIFY_BAD_KEYS)) ? " bad registry values" : ""),
+			  ((result->status & (VERIFY_BAD_FILES)) ? " bad stored files" : ""));
+		}
+	} else {
+		printf("All accounts are fine.\e[0K\n");
+	}
+	free_verify_data(&verify_data);
+
+	wait_for_cancel_button();
+
+	return;
+}
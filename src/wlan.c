@@ -23,68 +23,109 @@
 #include <common.h>
 #include <dir.h>
 #include <file.h>
+#include <hash.h>
 #include <main.h>
+#include <menu.h>
+#include <regcache.h>
 #include <registry.h>
+#include <schema.h>
+#include <snapshot.h>
 #include <wlan.h>
 
 #include <debugScreen.h>
 #define printf psvDebugScreenPrintf
 
 const char *const wlans_folder = "wlans/";
-const char *const reg_config_net_nn = "/CONFIG/NET/%02i";  // decimal 01-30
 const char *const reg_config_net_eth = "/CONFIG/NET/ETH";
-const char *const reg_config_net_app = "APP";
-const char *const reg_config_net_common = "COMMON";
-const char *const reg_config_net_ip = "IP";
-const char *const reg_config_net_wifi = "WIFI";
-const char *const file_reg_config_net = "registry/CONFIG/NET/";
-const int reg_id_ssid = 217;
-const int reg_id_conf_name = 210;
-const int reg_id_http_proxy_port = 235;
-const int reg_id_enable_auto_connect = 212;
-
-// values from os0:kd/registry.db0 and https://github.com/devnoname120/RegistryEditorMOD/blob/master/regs.c
-struct Registry_Entry template_wlan_reg_entries[] = {
-	{ reg_id_ssid, reg_config_net_nn, NULL, reg_config_net_wifi, "ssid", KEY_TYPE_STR, 33, NULL, },
-	{ 219, reg_config_net_nn, file_reg_config_net, reg_config_net_wifi, "wep_key", KEY_TYPE_STR, 27, NULL, },
-	{ 218, reg_config_net_nn, file_reg_config_net, reg_config_net_wifi, "wifi_security", KEY_TYPE_INT, 4, NULL, },
-	{ 220, reg_config_net_nn, file_reg_config_net, reg_config_net_wifi, "wpa_key", KEY_TYPE_STR, 65, NULL, },
-	{ 233, reg_config_net_nn, file_reg_config_net, reg_config_net_app, "http_proxy_flag", KEY_TYPE_INT, 4, NULL, },
-	{ reg_id_http_proxy_port, reg_config_net_nn, file_reg_config_net, reg_config_net_app, "http_proxy_port", KEY_TYPE_INT, 4, NULL, },
-	{ 234, reg_config_net_nn, file_reg_config_net, reg_config_net_app, "http_proxy_server", KEY_TYPE_STR, 256, NULL, },
-	{ 208, reg_config_net_nn, file_reg_config_net, reg_config_net_common, "conf_flag", KEY_TYPE_INT, 4, NULL, },
-	{ reg_id_conf_name, reg_config_net_nn, NULL, reg_config_net_common, "conf_name", KEY_TYPE_STR, 65, NULL, },
-	{ 211, reg_config_net_nn, file_reg_config_net, reg_config_net_common, "conf_serial_no", KEY_TYPE_INT, 4, NULL, },
-	{ 209, reg_config_net_nn, file_reg_config_net, reg_config_net_common, "conf_type", KEY_TYPE_INT, 4, NULL, },
-	{ 214, reg_config_net_nn, file_reg_config_net, reg_config_net_common, "device", KEY_TYPE_INT, 4, NULL, },
-	{ reg_id_enable_auto_connect, reg_config_net_nn, file_reg_config_net, reg_config_net_common, "enable_auto_connect", KEY_TYPE_INT, 4, NULL, },
-	{ 215, reg_config_net_nn, file_reg_config_net, reg_config_net_common, "ether_mode", KEY_TYPE_INT, 4, NULL, },
-	{ 213, reg_config_net_nn, file_reg_config_net, reg_config_net_common, "mtu", KEY_TYPE_INT, 4, NULL, },
-	{ 225, reg_config_net_nn, file_reg_config_net, reg_config_net_ip, "auth_key", KEY_TYPE_STR, 128, NULL, },
-	{ 224, reg_config_net_nn, file_reg_config_net, reg_config_net_ip, "auth_name", KEY_TYPE_STR, 128, NULL, },
-	{ 228, reg_config_net_nn, file_reg_config_net, reg_config_net_ip, "default_route", KEY_TYPE_STR, 16, NULL, },
-	{ 223, reg_config_net_nn, file_reg_config_net, reg_config_net_ip, "dhcp_hostname", KEY_TYPE_STR, 256, NULL, },
-	{ 229, reg_config_net_nn, file_reg_config_net, reg_config_net_ip, "dns_flag", KEY_TYPE_INT, 4, NULL, },
-	{ 226, reg_config_net_nn, file_reg_config_net, reg_config_net_ip, "ip_address", KEY_TYPE_STR, 16, NULL, },
-	{ 222, reg_config_net_nn, file_reg_config_net, reg_config_net_ip, "ip_config", KEY_TYPE_INT, 4, NULL, },
-	{ 227, reg_config_net_nn, file_reg_config_net, reg_config_net_ip, "netmask", KEY_TYPE_STR, 16, NULL, },
-	{ 230, reg_config_net_nn, file_reg_config_net, reg_config_net_ip, "primary_dns", KEY_TYPE_STR, 16, NULL, },
-	{ 231, reg_config_net_nn, file_reg_config_net, reg_config_net_ip, "secondary_dns", KEY_TYPE_STR, 16, NULL, },
+const char *const file_reg_config_net_app = "registry/CONFIG/NET/APP/";
+const char *const file_reg_config_net_common = "registry/CONFIG/NET/COMMON/";
+const char *const file_reg_config_net_ip = "registry/CONFIG/NET/IP/";
+const char *const file_reg_config_net_wifi = "registry/CONFIG/NET/WIFI/";
+
+#define REG_ID_SSID 217
+#define REG_ID_CONF_NAME 210
+#define REG_ID_HTTP_PROXY_PORT 235
+#define REG_ID_ENABLE_AUTO_CONNECT 212
+
+// fixed template indexes of special keys
+enum {
+	WLAN_REG_SSID=0,
+	WLAN_REG_CONF_NAME=8,
 };
 
+// key id and save path of each template key, path, name, type and size come from registry schema of os0:kd/registry.db0
+// key paths hold numbered folder 01-30 as %02i
+#define WLAN_REG_KEYS(KEY) \
+	KEY(REG_ID_SSID, NULL) \
+	KEY(219, file_reg_config_net_wifi) /* wep_key */ \
+	KEY(218, file_reg_config_net_wifi) /* wifi_security */ \
+	KEY(220, file_reg_config_net_wifi) /* wpa_key */ \
+	KEY(233, file_reg_config_net_app) /* http_proxy_flag */ \
+	KEY(REG_ID_HTTP_PROXY_PORT, file_reg_config_net_app) \
+	KEY(234, file_reg_config_net_app) /* http_proxy_server */ \
+	KEY(208, file_reg_config_net_common) /* conf_flag */ \
+	KEY(REG_ID_CONF_NAME, NULL) \
+	KEY(211, file_reg_config_net_common) /* conf_serial_no */ \
+	KEY(209, file_reg_config_net_common) /* conf_type */ \
+	KEY(214, file_reg_config_net_common) /* device */ \
+	KEY(REG_ID_ENABLE_AUTO_CONNECT, file_reg_config_net_common) \
+	KEY(215, file_reg_config_net_common) /* ether_mode */ \
+	KEY(213, file_reg_config_net_common) /* mtu */ \
+	KEY(225, file_reg_config_net_ip) /* auth_key */ \
+	KEY(224, file_reg_config_net_ip) /* auth_name */ \
+	KEY(228, file_reg_config_net_ip) /* default_route */ \
+	KEY(223, file_reg_config_net_ip) /* dhcp_hostname */ \
+	KEY(229, file_reg_config_net_ip) /* dns_flag */ \
+	KEY(226, file_reg_config_net_ip) /* ip_address */ \
+	KEY(222, file_reg_config_net_ip) /* ip_config */ \
+	KEY(227, file_reg_config_net_ip) /* netmask */ \
+	KEY(230, file_reg_config_net_ip) /* primary_dns */ \
+	KEY(231, file_reg_config_net_ip) /* secondary_dns */
+
+enum {
+	WLAN_REG_KEYS(REG_TEMPLATE_INDEX)
+};
+
+_Static_assert((int)(REG_TEMPLATE_INDEX_OF(REG_ID_SSID)) == (int)(WLAN_REG_SSID), "ssid must be at WLAN_REG_SSID");
+_Static_assert((int)(REG_TEMPLATE_INDEX_OF(REG_ID_CONF_NAME)) == (int)(WLAN_REG_CONF_NAME), "conf_name must be at WLAN_REG_CONF_NAME");
+
+const struct Registry_Entry template_wlan_reg_entries[] = {
+	WLAN_REG_KEYS(REG_TEMPLATE_KEY)
+};
+
+static struct Registry_Layout template_wlan_reg_layout;  // built on first use
+
 struct Registry_Data template_wlan_reg_data = {
 	.reg_count = sizeof(template_wlan_reg_entries) / sizeof(template_wlan_reg_entries[0]),
-	.reg_size = sizeof(template_wlan_reg_entries),
 	.reg_entries = template_wlan_reg_entries,
+	.layout = &template_wlan_reg_layout,
 	.idx_username = -1,
 	.idx_login_id = -1,
-	.idx_ssid = -1,
-	.idx_conf_name = -1,
+	.idx_ssid = WLAN_REG_SSID,
+	.idx_conf_name = WLAN_REG_CONF_NAME,
 };
 
 struct Registry_Data *initial_wlan_reg_data;
 
 
+static void clear_wlan_index(struct Wlan_Index *wlan_index)
+{
+	sceClibMemset(wlan_index, 0x00, sizeof(struct Wlan_Index));
+	wlan_index->free_slots = (1U << (MAX_WLAN)) - 1;
+	sceClibMemset(wlan_index->slot_by_hash, 0xff, sizeof(wlan_index->slot_by_hash));
+
+	return;
+}
+
+static unsigned int hash_ssid(const char *ssid)
+{
+	unsigned long long hash;
+
+	hash = hash_fnv1a64_update((HASH_FNV1A64_INIT), ssid, sceClibStrnlen(ssid, (WLAN_SSID_SIZE)));
+
+	return (unsigned int)(hash ^ (hash >> 32));
+}
+
 void init_wlan_data(struct Wlan_Data *wlan_data)
 {
 	int j;
@@ -93,6 +134,61 @@ void init_wlan_data(struct Wlan_Data *wlan_data)
 	for (j = 0; j < (MAX_WLAN); j++) {
 		wlan_data->wlan_reg_data[j] = NULL;
 	}
+	clear_wlan_index(&(wlan_data->wlan_index));
+}
+
+int find_wlan_slot(const struct Wlan_Data *const wlan_data, const char *ssid)
+{
+	const struct Wlan_Index *wlan_index;
+	unsigned int hash;
+	int bucket;
+	int slot;
+
+	wlan_index = &(wlan_data->wlan_index);
+	hash = hash_ssid(ssid);
+
+	// linear probing, compare strings only on full hash match
+	for (bucket = hash & ((WLAN_INDEX_SIZE) - 1); (slot = wlan_index->slot_by_hash[bucket]) >= 0; bucket = (bucket + 1) & ((WLAN_INDEX_SIZE) - 1)) {
+		if ((wlan_index->ssid_hash[slot] == hash) && (sceClibStrncmp(wlan_index->ssid[slot], ssid, (WLAN_SSID_SIZE)) == 0)) {
+			return slot;
+		}
+	}
+
+	return -1;
+}
+
+int get_free_wlan_slot(const struct Wlan_Data *const wlan_data)
+{
+	if (wlan_data->wlan_index.free_slots == 0) {
+		return -1;
+	}
+
+	return __builtin_ctz(wlan_data->wlan_index.free_slots);
+}
+
+void set_wlan_index_slot(struct Wlan_Data *wlan_data, int slot, const char *ssid)
+{
+	struct Wlan_Index *wlan_index;
+	int bucket;
+
+	if ((slot < 0) || (slot >= (MAX_WLAN))) {
+		return;
+	}
+
+	wlan_index = &(wlan_data->wlan_index);
+	if (!(wlan_index->free_slots & (1U << slot))) {  // slot already indexed
+		return;
+	}
+
+	wlan_index->free_slots &= ~(1U << slot);
+	sceClibStrncpy(wlan_index->ssid[slot], ssid, (WLAN_SSID_SIZE));
+	wlan_index->ssid[slot][(WLAN_SSID_SIZE)] = '\0';
+	wlan_index->ssid_hash[slot] = hash_ssid(wlan_index->ssid[slot]);
+
+	for (bucket = wlan_index->ssid_hash[slot] & ((WLAN_INDEX_SIZE) - 1); wlan_index->slot_by_hash[bucket] >= 0; bucket = (bucket + 1) & ((WLAN_INDEX_SIZE) - 1));
+	wlan_index->slot_by_hash[bucket] = (signed char)slot;
+
+	return;
 }
 
 void free_wlan_data(struct Wlan_Data *wlan_data)
@@ -112,6 +208,7 @@ void free_wlan_data(struct Wlan_Data *wlan_data)
 		wlan_data->wlan_reg_data[j] = NULL;
 	}
 	wlan_data->wlan_found = 0;
+	clear_wlan_index(&(wlan_data->wlan_index));
 
 	return;
 }
@@ -131,12 +228,10 @@ void get_current_wlan_data(struct Wlan_Data *wlan_data)
 	for (j = 0; j < (MAX_WLAN); j++) {
 		// build registry path
 		sceClibSnprintf(reg_path, (STRING_BUFFER_DEFAULT_SIZE), template_wlan_reg_entries[template_wlan_reg_data.idx_ssid].key_path, j+1);
-		sceClibStrncat(reg_path, slash_folder, (STRING_BUFFER_DEFAULT_SIZE));
-		sceClibStrncat(reg_path, template_wlan_reg_entries[template_wlan_reg_data.idx_ssid].key_path_extension, (STRING_BUFFER_DEFAULT_SIZE));
 
 		// get ssid
 		sceClibMemset(value, 0x00, (STRING_BUFFER_DEFAULT_SIZE)+1);
-		sceRegMgrGetKeyStr(reg_path, template_wlan_reg_entries[template_wlan_reg_data.idx_ssid].key_name, value, template_wlan_reg_entries[template_wlan_reg_data.idx_ssid].key_size);
+		reg_cache_get_str(reg_path, template_wlan_reg_entries[template_wlan_reg_data.idx_ssid].key_name, value, template_wlan_reg_entries[template_wlan_reg_data.idx_ssid].key_size);
 		value[(STRING_BUFFER_DEFAULT_SIZE)] = '\0';
 
 		// check ssid
@@ -145,35 +240,31 @@ void get_current_wlan_data(struct Wlan_Data *wlan_data)
 		}
 
 		wlan_data->wlan_found++;
+		set_wlan_index_slot(wlan_data, j, value);
 		init_reg_data(&(wlan_data->wlan_reg_data[j]), &template_wlan_reg_data);
 		reg_data = wlan_data->wlan_reg_data[j];
 
 		// fill each key value
 		for (i = 0; i < reg_data->reg_count; i++) {
-			if (reg_data->reg_entries[i].key_value == NULL) {
-				continue;
-			}
-			sceClibMemset(reg_data->reg_entries[i].key_value, 0x00, reg_data->reg_entries[i].key_size);
+			sceClibMemset(get_reg_value(reg_data, i), 0x00, reg_data->reg_entries[i].key_size);
 
 			if (i == reg_data->idx_ssid) {  // special case: ssid already retrieved
-				sceClibStrncpy((char *)(reg_data->reg_entries[i].key_value), value, reg_data->reg_entries[i].key_size);
-				((char *)(reg_data->reg_entries[i].key_value))[reg_data->reg_entries[i].key_size] = '\0';
+				sceClibStrncpy((char *)(get_reg_value(reg_data, i)), value, reg_data->reg_entries[i].key_size);
+				((char *)(get_reg_value(reg_data, i)))[reg_data->reg_entries[i].key_size] = '\0';
 			} else {
 				// build registry path
 				sceClibSnprintf(reg_path, (STRING_BUFFER_DEFAULT_SIZE), reg_data->reg_entries[i].key_path, j+1);
-				sceClibStrncat(reg_path, slash_folder, (STRING_BUFFER_DEFAULT_SIZE));
-				sceClibStrncat(reg_path, reg_data->reg_entries[i].key_path_extension, (STRING_BUFFER_DEFAULT_SIZE));
 
 				switch(reg_data->reg_entries[i].key_type) {
 					case KEY_TYPE_INT:
-						sceRegMgrGetKeyInt(reg_path, reg_data->reg_entries[i].key_name, (int *)(reg_data->reg_entries[i].key_value));
+						reg_cache_get_int(reg_path, reg_data->reg_entries[i].key_name, (int *)(get_reg_value(reg_data, i)));
 						break;
 					case KEY_TYPE_STR:
-						sceRegMgrGetKeyStr(reg_path, reg_data->reg_entries[i].key_name, (char *)(reg_data->reg_entries[i].key_value), reg_data->reg_entries[i].key_size);
-						((char *)(reg_data->reg_entries[i].key_value))[reg_data->reg_entries[i].key_size] = '\0';
+						reg_cache_get_str(reg_path, reg_data->reg_entries[i].key_name, (char *)(get_reg_value(reg_data, i)), reg_data->reg_entries[i].key_size);
+						((char *)(get_reg_value(reg_data, i)))[reg_data->reg_entries[i].key_size] = '\0';
 						break;
 					case KEY_TYPE_BIN:
-						sceRegMgrGetKeyBin(reg_path, reg_data->reg_entries[i].key_name, reg_data->reg_entries[i].key_value, reg_data->reg_entries[i].key_size);
+						reg_cache_get_bin(reg_path, reg_data->reg_entries[i].key_name, get_reg_value(reg_data, i), reg_data->reg_entries[i].key_size);
 						break;
 				}
 			}
@@ -181,24 +272,83 @@ void get_current_wlan_data(struct Wlan_Data *wlan_data)
 	}  // for j < (MAX_WLAN)
 }
 
-void save_wlan_details(struct Wlan_Data *wlan_data, char *title)
+// slots of scanned wlans shown by save menu, row 0 is cancel
+struct Wlan_List {
+	struct Wlan_Data *wlan_data;
+	int count;
+	int slots[(MAX_WLAN)];
+};
+
+static void draw_wlan_row(void *context, int index)
 {
-	int menu_redraw_screen;
-	int menu_redraw;
-	int menu_run;
-	int menu_items;
-	int menu_item;
-	int x, y;
-	int x2, y2;
-	int x3, y3;
-	int button_pressed;
-	int i, j;
+	struct Wlan_List *list;
 	struct Registry_Data *reg_data;
-	int wlan_count2;
-	int entries_per_screen;
-	int count;
+	int slot;
+
+	list = (struct Wlan_List *)context;
+	if (index == 0) {
+		printf("Cancel.");
+		return;
+	}
+
+	slot = list->slots[index - 1];
+	reg_data = list->wlan_data->wlan_reg_data[slot];
+	printf("%s (reg #%02i)", (char *)(get_reg_value(reg_data, reg_data->idx_ssid)), slot+1);
+
+	return;
+}
+
+static void draw_wlan_info(struct Menu *menu)
+{
+	// draw info
+	printf("The following %i WLANs are available: (L/R to page)\e[0K\n", menu->count - 1);
+
+	return;
+}
+
+static int select_wlan_row(struct Menu *menu, int index)
+{
+	struct Wlan_List *list;
+	struct Registry_Data *reg_data;
+	int slot;
 	char base_path[(MAX_PATH_LENGTH)+1];
 
+	if (index == 0) {  // cancel
+		return (MENU_EXIT);
+	}
+
+	// save wlan
+	list = (struct Wlan_List *)menu->context;
+	slot = list->slots[index - 1];
+	reg_data = list->wlan_data->wlan_reg_data[slot];
+
+	// clear data part of screen
+	clear_menu_data(menu);
+
+	// build target base path
+	base_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(base_path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, wlans_folder, (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, (char *)(get_reg_value(reg_data, reg_data->idx_ssid)), (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, slash_folder, (MAX_PATH_LENGTH));
+	printf("Saving WLAN details to %s...\e[0K\n", base_path);
+
+	// save wlan registry data
+	save_reg_data(base_path, reg_data, 1);
+
+	printf("WLAN %s (reg #%02i) saved!\e[0K\n", (char *)(get_reg_value(reg_data, reg_data->idx_ssid)), slot+1);
+	wait_for_cancel_button();
+
+	return (MENU_REDRAW);
+}
+
+void save_wlan_details(struct Wlan_Data *wlan_data, char *title)
+{
+	int j;
+	struct Registry_Data *reg_data;
+	struct Wlan_List wlan_list;
+	struct Menu menu;
+
 	if (wlan_data == NULL) {
 		return;
 	}
@@ -207,159 +357,122 @@ void save_wlan_details(struct Wlan_Data *wlan_data, char *title)
 		return;
 	}
 
-	// run save menu
-	menu_redraw_screen = 1;
-	menu_redraw = 1;
-	menu_run = 1;
-	menu_items = 0;
-	menu_item = 0;
-	wlan_count2 = 0;
-	count = wlan_count2;
-	do {
-		// redraw screen
-		if (menu_redraw_screen) {
-			// draw title line
-			draw_title_line(title);
-
-			// draw pixel line
-			draw_pixel_line(NULL, NULL);
-			psvDebugScreenGetCoordsXY(NULL, &y3);  // start of data
-			x3 = 0;
-
-			// draw info
-			printf("The following %i WLANs are available: (L/R to page)\e[0K\n", wlan_data->wlan_found);
-
-			// draw first part of menu
-			psvDebugScreenGetCoordsXY(NULL, &y);  // start of menu
-			x = 0;
-			printf(" Cancel.\e[0K\n");
-			psvDebugScreenGetCoordsXY(NULL, &y2);  // start of wlan list
-			x2 = 0;
-
-			entries_per_screen = ((SCREEN_HEIGHT) - y2 + 1) / psv_font_current->size_h;
-
-			menu_redraw = 1;
-			menu_redraw_screen = 0;
+	// collect slots of scanned wlans once
+	wlan_list.wlan_data = wlan_data;
+	wlan_list.count = 0;
+	for (j = 0; j < (MAX_WLAN); j++) {
+		reg_data = wlan_data->wlan_reg_data[j];
+		if (reg_data == NULL) {
+			continue;
+		}
+		if (reg_data->values == NULL) {
+			continue;
 		}
+		if (reg_data->idx_ssid < 0) {
+			continue;
+		}
+		wlan_list.slots[wlan_list.count++] = j;
+	}
 
-		// redraw wlan list
-		if (menu_redraw) {
-			psvDebugScreenSetCoordsXY(&x2, &y2);
-			printf("\e[0J");
-
-			count = wlan_count2;
-			menu_items = 0;
-			for (i = 0, j = 0; (i < entries_per_screen) && (count < wlan_data->wlan_found) && (j < (MAX_WLAN)); j++) {
-				reg_data = wlan_data->wlan_reg_data[j];
-				if (reg_data == NULL) {
-					continue;
-				}
-				if (reg_data->reg_entries == NULL) {
-					continue;
-				}
-				if (reg_data->idx_ssid < 0) {
-					continue;
-				}
+	// run save menu
+	init_menu(&menu, title, wlan_list.count + 1, draw_wlan_row, select_wlan_row, &wlan_list);
+	menu.draw_info = draw_wlan_info;
+	run_menu(&menu);
 
-				menu_items++;
-				i++;
-				count++;
-				printf(" %s (reg #%02i)\e[0K\n", (char *)(reg_data->reg_entries[reg_data->idx_ssid].key_value), j+1);
-			}
+	return;
+}
 
-			menu_redraw = 0;
-		}
+void save_all_wlan_details(struct Wlan_Data *wlan_data, char *title)
+{
+	int i, j;
+	int x, y;
+	int size_base_path;
+	char base_path[(MAX_PATH_LENGTH)+1];
+	struct Registry_Data *reg_data;
+	struct Registry_Data *reg_saved_data;
+	struct Registry_Diff reg_diff;
+	int identical;
+	int saved;
+	int skipped;
 
-		// draw menu marker
-		psvDebugScreenSetCoordsXY(&x, &y);
-		//
-		if (menu_item < 0) {
-			menu_item = 0;
+	if (wlan_data == NULL) {
+		return;
+	}
+
+	// draw title line
+	draw_title_line(title);
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
+
+	// build target base path, create wlans folder once for all profiles
+	base_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(base_path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, wlans_folder, (MAX_PATH_LENGTH));
+	create_path(base_path, 0, 0);
+	size_base_path = sceClibStrnlen(base_path, (MAX_PATH_LENGTH));
+	printf("Saving %i WLANs to %s...\e[0K\n", wlan_data->wlan_found, base_path);
+
+	// save all wlans from the already scanned registry slots
+	psvDebugScreenGetCoordsXY(NULL, &y);
+	x = 0;
+	saved = 0;
+	skipped = 0;
+	for (i = 0, j = 0; j < (MAX_WLAN); j++) {
+		reg_data = wlan_data->wlan_reg_data[j];
+		if (reg_data == NULL) {
+			continue;
 		}
-		if (menu_item > menu_items) {
-			menu_item = menu_items;
+		if (reg_data->values == NULL) {
+			continue;
 		}
-		//
-		for (i = 0; i <= menu_items; i++) {
-			if (menu_item == i) {
-				printf(">\n");
-			} else {
-				printf(" \n");
-			}
+		if (reg_data->idx_ssid < 0) {
+			continue;
 		}
+		i++;
 
-		// process key strokes
-		button_pressed = get_key();
-		if (button_pressed == SCE_CTRL_DOWN) {
-			menu_item++;
-		} else if (button_pressed == SCE_CTRL_UP) {
-			menu_item--;
-		} else if (button_pressed == SCE_CTRL_RTRIGGER) {
-			if (count < wlan_data->wlan_found) {
-				wlan_count2 += entries_per_screen;
-				if (wlan_count2 >= wlan_data->wlan_found) {
-					wlan_count2 = wlan_data->wlan_found - 1;
-				}
-				menu_redraw = 1;
-			}
-		} else if (button_pressed == SCE_CTRL_LTRIGGER) {
-			if (wlan_count2 > 0) {
-				wlan_count2 -= entries_per_screen;
-				if (wlan_count2 < 0) {
-					wlan_count2 = 0;
-				}
-				menu_redraw = 1;
-			}
-		} else if (button_pressed == button_enter) {
-			if (menu_item == 0) {  // cancel
-				menu_run = 0;
-			} else if (menu_item > 0) {  // save wlan
-				// find corresponding wlan
-				i = wlan_count2 + menu_item;
-				for (j = 0; j < (MAX_WLAN); j++) {
-					reg_data = wlan_data->wlan_reg_data[j];
-					if (reg_data == NULL) {
-						continue;
-					}
-					if (reg_data->reg_entries == NULL) {
-						continue;
-					}
-					if (reg_data->idx_ssid < 0) {
-						continue;
-					}
-					if (--i > 0) {
-						continue;
-					}
-
-					// clear data part of screen
-					psvDebugScreenSetCoordsXY(&x3, &y3);
-					printf("\e[0J");
-
-					// build target base path
-					base_path[(MAX_PATH_LENGTH)] = '\0';
-					sceClibStrncpy(base_path, app_base_path, (MAX_PATH_LENGTH));
-					sceClibStrncat(base_path, wlans_folder, (MAX_PATH_LENGTH));
-					sceClibStrncat(base_path, (char *)(reg_data->reg_entries[reg_data->idx_ssid].key_value), (MAX_PATH_LENGTH));
-					sceClibStrncat(base_path, slash_folder, (MAX_PATH_LENGTH));
-					printf("Saving WLAN details to %s...\e[0K\n", base_path);
-
-					// save wlan registry data
-					save_reg_data(base_path, reg_data);
-
-					printf("WLAN %s (reg #%02i) saved!\e[0K\n", (char *)(reg_data->reg_entries[reg_data->idx_ssid].key_value), j+1);
-					wait_for_cancel_button();
-					menu_redraw_screen = 1;
-					menu_redraw = 1;
-					break;
-				}
+		psvDebugScreenSetCoordsXY(&x, &y);
+		printf("Saving WLAN %i of %i: %s (reg #%02i)\e[0K\n", i, wlan_data->wlan_found, (char *)(get_reg_value(reg_data, reg_data->idx_ssid)), j+1);
+
+		// build per-ssid target path
+		base_path[size_base_path] = '\0';
+		sceClibStrncat(base_path, (char *)(get_reg_value(reg_data, reg_data->idx_ssid)), (MAX_PATH_LENGTH));
+		sceClibStrncat(base_path, slash_folder, (MAX_PATH_LENGTH));
+
+		// compare with saved copy, ssid and conf_name are taken from folder name
+		identical = 0;
+		if (check_folder_exists(base_path)) {
+			reg_saved_data = NULL;
+			init_reg_data(&reg_saved_data, &template_wlan_reg_data);
+			if (load_reg_data(base_path, reg_saved_data, initial_wlan_reg_data, (REG_ID_SSID), (REG_ID_CONF_NAME), 0) == 0) {
+				sceClibMemcpy(get_reg_value(reg_saved_data, reg_saved_data->idx_ssid), get_reg_value(reg_data, reg_data->idx_ssid), reg_data->reg_entries[reg_data->idx_ssid].key_size);
+				sceClibMemcpy(get_reg_value(reg_saved_data, reg_saved_data->idx_conf_name), get_reg_value(reg_data, reg_data->idx_conf_name), reg_data->reg_entries[reg_data->idx_conf_name].key_size);
+				diff_reg_data(reg_saved_data, reg_data, &reg_diff);
+				identical = (reg_diff.changed_count == 0);
+				free_reg_diff(&reg_diff);
 			}
+			free_reg_data(reg_saved_data);
+			free(reg_saved_data);
+		}
+
+		if (identical) {
+			skipped++;
+			continue;
 		}
-	} while (menu_run);
+
+		// save wlan registry data
+		save_reg_data(base_path, reg_data, 0);
+		saved++;
+	}
+
+	psvDebugScreenSetCoordsXY(&x, &y);
+	printf("%i WLANs saved, %i unchanged WLANs skipped.\e[0K\n", saved, skipped);
+	wait_for_cancel_button();
 
 	return;
 }
 
-void read_wlan_details(struct Registry_Data *reg_data, struct Registry_Data *reg_init_data)
+void read_wlan_details(struct Registry_Data *reg_data, struct Registry_Data *reg_init_data, int display)
 {
 	char base_path[(MAX_PATH_LENGTH)+1];
 
@@ -367,38 +480,210 @@ void read_wlan_details(struct Registry_Data *reg_data, struct Registry_Data *reg
 	base_path[(MAX_PATH_LENGTH)] = '\0';
 	sceClibStrncpy(base_path, app_base_path, (MAX_PATH_LENGTH));
 	sceClibStrncat(base_path, wlans_folder, (MAX_PATH_LENGTH));
-	sceClibStrncat(base_path, (char *)(reg_data->reg_entries[reg_data->idx_ssid].key_value), (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, (char *)(get_reg_value(reg_data, reg_data->idx_ssid)), (MAX_PATH_LENGTH));
 	sceClibStrncat(base_path, slash_folder, (MAX_PATH_LENGTH));
-	printf("Reading WLAN details from %s...\e[0K\n", base_path);
+	if (display) {
+		printf("Reading WLAN details from %s...\e[0K\n", base_path);
+	}
 
 	// load wlan registry data
-	load_reg_data(base_path, reg_data, reg_init_data, reg_id_ssid, reg_id_conf_name);
+	load_reg_data(base_path, reg_data, reg_init_data, (REG_ID_SSID), (REG_ID_CONF_NAME), display);
 
 	return;
 }
 
+// sorted saved wlans shown by load menu, row 0 is cancel
+struct Wlan_Dir_List {
+	struct Wlan_Data *wlan_data;
+	struct Dir_Filter filter;
+	int name_size;
+	int free_slot;
+};
+
+static void draw_wlan_dir_row(void *context, int index)
+{
+	struct Wlan_Dir_List *list;
+	struct Dir_Entry *dir;
+	int size;
+	int update_slot;
+
+	list = (struct Wlan_Dir_List *)context;
+	if (index == 0) {
+		printf("Cancel.");
+		return;
+	}
+
+	dir = &(list->filter.dirs[list->filter.first + index - 1]);
+	size = (dir->size > (list->name_size - 1));
+	if (size) {
+		printf("\e[2m");
+	}
+	printf("%.*s", list->name_size, dir->name);
+	if (size) {
+		printf("... (name too long)\e[22m");
+	} else {
+		update_slot = find_wlan_slot(list->wlan_data, dir->name);
+		if (update_slot >= 0) {
+			printf(" (update #%02i)", update_slot+1);
+		} else if (list->free_slot >= 0) {
+			printf(" (add #%02i)", list->free_slot+1);
+		} else {
+			printf("\e[2m (no free slot)\e[22m");
+		}
+	}
+
+	return;
+}
+
+static void draw_wlan_dir_info(struct Menu *menu)
+{
+	struct Wlan_Dir_List *list;
+
+	// free slot may have been used by last restore
+	list = (struct Wlan_Dir_List *)menu->context;
+	list->free_slot = get_free_wlan_slot(list->wlan_data);
+
+	// draw info
+	if (list->filter.size_prefix > 0) {
+		printf("%i of %i WLANs start with \"%s\": (L/R to page)\e[0K\n", list->filter.count, list->filter.dir_count, list->filter.prefix);
+	} else {
+		printf("The following %i WLANs are available: (L/R to page)\e[0K\n", list->filter.dir_count);
+	}
+	printf("\e[2mLeft/right jump by letter, square/triangle filter +/-\e[22m\e[0K\n");
+
+	return;
+}
+
+static int handle_wlan_dir_key(struct Menu *menu, int button_pressed)
+{
+	return handle_dir_filter_key(menu, &(((struct Wlan_Dir_List *)menu->context)->filter), 1, button_pressed);
+}
+
+static int select_wlan_dir_row(struct Menu *menu, int index)
+{
+	struct Wlan_Dir_List *list;
+	struct Wlan_Data *wlan_data;
+	struct Dir_Entry *dir;
+	int update_slot;
+
+	if (index == 0) {  // cancel
+		return (MENU_EXIT);
+	}
+
+	// load wlan, slots and diff are based on live registry values as it may have changed while the app was suspended
+	list = (struct Wlan_Dir_List *)menu->context;
+	wlan_data = list->wlan_data;
+	refresh_reg_cache();
+	get_current_wlan_data(wlan_data);
+	dir = &(list->filter.dirs[list->filter.first + index - 1]);
+	update_slot = -1;
+	if (dir->size <= (list->name_size - 1)) {
+		update_slot = find_wlan_slot(wlan_data, dir->name);
+		if (update_slot < 0) {
+			update_slot = get_free_wlan_slot(wlan_data);
+		}
+		if (update_slot < 0) {
+			clear_menu_data(menu);
+			printf("No free WLAN slot for %s!\e[0K\n", dir->name);
+		}
+	}
+	if (update_slot >= 0) {
+		struct Registry_Data *reg_new_data;
+		struct Registry_Diff reg_diff;
+		char snapshot_name[16];
+
+		// clear data part of screen
+		clear_menu_data(menu);
+		// initialize data for wlan to be added/updated
+		reg_new_data = NULL;
+		init_reg_data(&reg_new_data, &template_wlan_reg_data);
+		// copy ssid plus conf_name
+		sceClibStrncpy((char *)(get_reg_value(reg_new_data, reg_new_data->idx_ssid)), dir->name, (reg_new_data->reg_entries[reg_new_data->idx_ssid].key_size - 1));
+		sceClibStrncpy((char *)(get_reg_value(reg_new_data, reg_new_data->idx_conf_name)), dir->name, (reg_new_data->reg_entries[reg_new_data->idx_conf_name].key_size - 1));
+		// read wlan data
+		read_wlan_details(reg_new_data, initial_wlan_reg_data, 1);
+		// keep image of complete registry and replaced wlan registry data, then only write changed keys
+		snapshot_full_registry();
+		clear_reg_section_snapshots();
+		sceClibSnprintf(snapshot_name, sizeof(snapshot_name), wlan_snapshot_name, update_slot+1);
+		snapshot_reg_section(snapshot_name, &template_wlan_reg_data, update_slot+1);
+		diff_reg_data(wlan_data->wlan_reg_data[update_slot], reg_new_data, &reg_diff);
+		set_reg_data_diff(reg_new_data, update_slot+1, &reg_diff);
+		free_reg_diff(&reg_diff);
+		// slot is in use now, keep index current for next restore
+		set_wlan_index_slot(wlan_data, update_slot, dir->name);
+		//
+		printf("WLAN %s restored!\e[0K\n", (char *)(get_reg_value(reg_new_data, reg_new_data->idx_ssid)));
+		free_reg_data(reg_new_data);
+		free(reg_new_data);
+	}
+	wait_for_cancel_button();
+
+	return (MENU_REDRAW);
+}
+
 void load_wlan_details(struct Wlan_Data *wlan_data, char *title)
 {
-	int menu_redraw;
-	int menu_redraw_screen;
-	int menu_run;
-	int menu_items;
-	int menu_item;
+	int size_base_path;
+	char base_path[(MAX_PATH_LENGTH)+1];
+	struct Dir_Entry *dirs;
+	int dir_count;
+	struct Wlan_Dir_List wlan_dir_list;
+	struct Menu menu;
+
+	// build source base path
+	base_path[(MAX_PATH_LENGTH)] = '\0';
+	sceClibStrncpy(base_path, app_base_path, (MAX_PATH_LENGTH));
+	sceClibStrncat(base_path, wlans_folder, (MAX_PATH_LENGTH));
+	size_base_path = sceClibStrnlen(base_path, (MAX_PATH_LENGTH));
+
+	// read directories in base path
+	base_path[size_base_path - 1] = '\0';
+	dirs = NULL;
+	dir_count = get_subdirs(base_path, &dirs);
+	base_path[size_base_path - 1] = '/';
+	sort_subdirs(dirs, dir_count);
+
+	// run load menu
+	wlan_dir_list.wlan_data = wlan_data;
+	init_dir_filter(&(wlan_dir_list.filter), dirs, dir_count);
+	wlan_dir_list.name_size = template_wlan_reg_data.reg_entries[template_wlan_reg_data.idx_ssid].key_size;
+	wlan_dir_list.free_slot = -1;
+	init_menu(&menu, title, dir_count + 1, draw_wlan_dir_row, select_wlan_dir_row, &wlan_dir_list);
+	menu.draw_info = draw_wlan_dir_info;
+	menu.handle_key = handle_wlan_dir_key;
+	run_menu(&menu);
+
+	// free memory
+	free_subdirs(dirs, dir_count);
+
+	return;
+}
+
+void restore_all_wlan_details(struct Wlan_Data *wlan_data, char *title)
+{
+	int i;
 	int x, y;
-	int x2, y2;
-	int x3, y3;
-	int button_pressed;
-	int i, j;
-	struct Registry_Data *reg_data;
 	int size_base_path;
 	char base_path[(MAX_PATH_LENGTH)+1];
+	char snapshot_name[16];
 	struct Dir_Entry *dirs;
 	int dir_count;
-	int dir_count2;
-	int entries_per_screen;
-	int size;
-	int count;
-	int free_slot, update_slot;
+	struct Registry_Data **profiles;
+	int *slots;
+	int profile_count;
+	int restored;
+	int keys_changed;
+	struct Registry_Diff reg_diff;
+	SceUInt64 time_start;
+	unsigned int time_ms;
+	unsigned int rate;
+
+	// draw title line
+	draw_title_line(title);
+
+	// draw pixel line
+	draw_pixel_line(NULL, NULL);
 
 	// build source base path
 	base_path[(MAX_PATH_LENGTH)] = '\0';
@@ -412,194 +697,104 @@ void load_wlan_details(struct Wlan_Data *wlan_data, char *title)
 	dir_count = get_subdirs(base_path, &dirs);
 	base_path[size_base_path - 1] = '/';
 
-	// run switch menu
-	menu_redraw_screen = 1;
-	menu_redraw = 1;
-	menu_run = 1;
-	menu_items = 0;
-	menu_item = 0;
-	dir_count2 = 0;
-	count = dir_count2;
-	free_slot = -1;
-	do {
-		// redraw screen
-		if (menu_redraw_screen) {
-			// draw title line
-			draw_title_line(title);
-
-			// draw pixel line
-			draw_pixel_line(NULL, NULL);
-			psvDebugScreenGetCoordsXY(NULL, &y3);  // start of data
-			x3 = 0;
-
-			// draw info
-			printf("The following %i WLANs are available: (L/R to page)\e[0K\n", dir_count);
-
-			// draw first part of menu
-			psvDebugScreenGetCoordsXY(NULL, &y);  // start of menu
-			x = 0;
-			printf(" Cancel.\e[0K\n");
-			psvDebugScreenGetCoordsXY(NULL, &y2);  // start of wlan list
-			x2 = 0;
-
-			entries_per_screen = ((SCREEN_HEIGHT) - y2 + 1) / psv_font_current->size_h;
-
-			menu_redraw = 1;
-			menu_redraw_screen = 0;
+	if (dir_count <= 0) {
+		printf("No saved WLANs found in %s.\e[0K\n", base_path);
+		wait_for_cancel_button();
+		return;
+	}
+
+	profiles = malloc(dir_count * sizeof(struct Registry_Data *));
+	slots = malloc(dir_count * sizeof(int));
+	if ((profiles == NULL) || (slots == NULL)) {
+		printf("\e[1mNot enough memory for %i WLANs!\e[22m\e[0K\n", dir_count);
+		free(profiles);
+		free(slots);
+		free_subdirs(dirs, dir_count);
+		wait_for_cancel_button();
+		return;
+	}
+
+	time_start = sceKernelGetProcessTimeWide();
+
+	// load all saved profiles quietly and plan slot assignment against current registry
+	printf("Reading %i saved WLANs from %s...\e[0K\n", dir_count, base_path);
+	profile_count = 0;
+	for (i = 0; i < dir_count; i++) {
+		profiles[i] = NULL;
+		slots[i] = -1;
+
+		if (dirs[i].size > (template_wlan_reg_data.reg_entries[template_wlan_reg_data.idx_ssid].key_size - 1)) {
+			printf("\e[2mSkipping %s (SSID too long).\e[22m\e[0K\n", dirs[i].name);
+			continue;
 		}
 
-		// redraw wlan list
-		if (menu_redraw) {
-			psvDebugScreenSetCoordsXY(&x2, &y2);
-			printf("\e[0J");
-
-			count = dir_count2;
-			menu_items = 0;
-			for (i = 0; (i < entries_per_screen) && (count < dir_count); i++, count++) {
-				menu_items++;
-				size = (dirs[count].size > (template_wlan_reg_data.reg_entries[template_wlan_reg_data.idx_ssid].key_size - 1));
-				if (size) {
-					printf("\e[2m");
-				}
-				printf(" %.*s", template_wlan_reg_data.reg_entries[template_wlan_reg_data.idx_ssid].key_size, dirs[count].name);
-				if (size) {
-					printf("... (name too long)\e[22m");
-				} else {
-					update_slot = -1;
-					for (j = 0; j < (MAX_WLAN); j++) {
-						reg_data = wlan_data->wlan_reg_data[j];
-						if (reg_data == NULL) {
-							if (free_slot < 0) {
-								free_slot = j;
-							}
-							continue;
-						}
-						if (reg_data->reg_entries == NULL) {
-							continue;
-						}
-						if (reg_data->idx_ssid < 0) {
-							continue;
-						}
-
-						if (sceClibStrcmp(dirs[count].name, (char *)(reg_data->reg_entries[reg_data->idx_ssid].key_value)) == 0) {
-							update_slot = j;
-							break;
-						}
-					}
-					if (update_slot >= 0) {
-						printf(" (update #%02i)", update_slot+1);
-					} else {
-						printf(" (add #%02i)", free_slot+1);
-					}
-				}
-				printf("\e[0K\n");
+		slots[i] = find_wlan_slot(wlan_data, dirs[i].name);
+		if (slots[i] < 0) {
+			slots[i] = get_free_wlan_slot(wlan_data);
+			if (slots[i] < 0) {
+				printf("\e[2mSkipping %s (no free slot).\e[22m\e[0K\n", dirs[i].name);
+				continue;
 			}
+			// reserve slot for this profile
+			set_wlan_index_slot(wlan_data, slots[i], dirs[i].name);
+		}
+
+		init_reg_data(&(profiles[i]), &template_wlan_reg_data);
+		sceClibStrncpy((char *)(get_reg_value(profiles[i], profiles[i]->idx_ssid)), dirs[i].name, (profiles[i]->reg_entries[profiles[i]->idx_ssid].key_size - 1));
+		sceClibStrncpy((char *)(get_reg_value(profiles[i], profiles[i]->idx_conf_name)), dirs[i].name, (profiles[i]->reg_entries[profiles[i]->idx_conf_name].key_size - 1));
+		read_wlan_details(profiles[i], initial_wlan_reg_data, 0);
+		profile_count++;
+	}
 
-			menu_redraw = 0;
+	// apply all profiles in one registry write pass
+	if (profile_count > 0) {
+		snapshot_full_registry();
+		clear_reg_section_snapshots();
+	}
+	psvDebugScreenGetCoordsXY(NULL, &y);
+	x = 0;
+	restored = 0;
+	keys_changed = 0;
+	for (i = 0; i < dir_count; i++) {
+		if (profiles[i] == NULL) {
+			continue;
 		}
 
-		// draw menu marker
 		psvDebugScreenSetCoordsXY(&x, &y);
-		//
-		if (menu_item < 0) {
-			menu_item = 0;
-		}
-		if (menu_item > menu_items) {
-			menu_item = menu_items;
-		}
-		//
-		for (i = 0; i <= menu_items; i++) {
-			if (menu_item == i) {
-				printf(">\n");
-			} else {
-				printf(" \n");
-			}
+		printf("Restoring WLAN %i of %i: %s (reg #%02i)\e[0K\n", restored+1, profile_count, dirs[i].name, slots[i]+1);
+
+		// keep image of replaced wlan registry data, already scanned slots need no registry read
+		sceClibSnprintf(snapshot_name, sizeof(snapshot_name), wlan_snapshot_name, slots[i]+1);
+		if (wlan_data->wlan_reg_data[slots[i]] != NULL) {
+			save_reg_data_snapshot(snapshot_name, wlan_data->wlan_reg_data[slots[i]]);
+		} else {
+			snapshot_reg_section(snapshot_name, &template_wlan_reg_data, slots[i]+1);
 		}
+		diff_reg_data(wlan_data->wlan_reg_data[slots[i]], profiles[i], &reg_diff);
+		set_reg_data_diff(profiles[i], slots[i]+1, &reg_diff);
+		keys_changed += reg_diff.changed_count;
+		free_reg_diff(&reg_diff);
+
+		free_reg_data(profiles[i]);
+		free(profiles[i]);
+		profiles[i] = NULL;
+		restored++;
+	}
 
-		// process key strokes
-		button_pressed = get_key();
-		if (button_pressed == SCE_CTRL_DOWN) {
-			menu_item++;
-		} else if (button_pressed == SCE_CTRL_UP) {
-			menu_item--;
-		} else if (button_pressed == SCE_CTRL_RTRIGGER) {
-			if (count < dir_count) {
-				dir_count2 += entries_per_screen;
-				if (dir_count2 >= dir_count) {
-					dir_count2 = dir_count - 1;
-				}
-				menu_redraw = 1;
-			}
-		} else if (button_pressed == SCE_CTRL_LTRIGGER) {
-			if (dir_count2 > 0) {
-				dir_count2 -= entries_per_screen;
-				if (dir_count2 < 0) {
-					dir_count2 = 0;
-				}
-				menu_redraw = 1;
-			}
-		} else if (button_pressed == button_enter) {
-			if (menu_item == 0) {  // cancel
-				menu_run = 0;
-			} else if (menu_item > 0) {  // load wlan
-				i = dir_count2 + menu_item - 1;
-				size = (dirs[i].size > (template_wlan_reg_data.reg_entries[template_wlan_reg_data.idx_ssid].key_size - 1));
-				if (!size) {
-					struct Registry_Data *reg_new_data;
-
-					update_slot = -1;
-					for (j = 0; j < (MAX_WLAN); j++) {
-						reg_data = wlan_data->wlan_reg_data[j];
-						if (reg_data == NULL) {
-							if (free_slot < 0) {
-								free_slot = j;
-							}
-							continue;
-						}
-						if (reg_data->reg_entries == NULL) {
-							continue;
-						}
-						if (reg_data->idx_ssid < 0) {
-							continue;
-						}
-
-						if (sceClibStrcmp(dirs[i].name, (char *)(reg_data->reg_entries[reg_data->idx_ssid].key_value)) == 0) {
-							update_slot = j;
-							break;
-						}
-					}
-					if (update_slot < 0) {
-						update_slot = free_slot;
-					}
-
-					// clear data part of screen
-					psvDebugScreenSetCoordsXY(&x3, &y3);
-					printf("\e[0J");
-					// initialize data for wlan to be added/updated
-					reg_new_data = NULL;
-					init_reg_data(&reg_new_data, &template_wlan_reg_data);
-					// copy ssid plus conf_name
-					sceClibStrncpy((char *)(reg_new_data->reg_entries[reg_new_data->idx_ssid].key_value), dirs[i].name, (reg_new_data->reg_entries[reg_new_data->idx_ssid].key_size - 1));
-					sceClibStrncpy((char *)(reg_new_data->reg_entries[reg_new_data->idx_conf_name].key_value), dirs[i].name, (reg_new_data->reg_entries[reg_new_data->idx_conf_name].key_size - 1));
-					// read wlan data
-					read_wlan_details(reg_new_data, initial_wlan_reg_data);
-					// set wlan registry data
-					set_reg_data(reg_new_data, update_slot+1);
-					//
-					printf("WLAN %s restored!\e[0K\n", (char *)(reg_new_data->reg_entries[reg_new_data->idx_ssid].key_value));
-					free_reg_data(reg_new_data);
-					free(reg_new_data);
-				}
-				wait_for_cancel_button();
-				menu_redraw_screen = 1;
-				menu_redraw = 1;
-			}
-		}
-	} while (menu_run);
+	time_ms = (unsigned int)((sceKernelGetProcessTimeWide() - time_start) / 1000);
+	rate = (time_ms > 0) ? ((restored * 100000U) / time_ms) : (restored * 100U);  // profiles/sec * 100
+
+	psvDebugScreenSetCoordsXY(&x, &y);
+	printf("%i of %i WLANs restored, %i registry keys changed.\e[0K\n", restored, dir_count, keys_changed);
+	printf("Took %u ms (%u.%02u WLANs/sec).\e[0K\n", time_ms, rate / 100, rate % 100);
 
 	// free memory
+	free(profiles);
+	free(slots);
 	free_subdirs(dirs, dir_count);
 
+	wait_for_cancel_button();
+
 	return;
 }
 
@@ -614,32 +809,16 @@ void main_wlan(void)
 	sceClibStrncat(base_path, wlans_folder, (MAX_PATH_LENGTH));
 	create_path(base_path, 0, 0);
 
-	// determine special indexes of registry data
-	for (i = 0; i < template_wlan_reg_data.reg_count; i++) {
-		// ssid
-		if ((template_wlan_reg_data.idx_ssid < 0) && (template_wlan_reg_data.reg_entries[i].key_id == reg_id_ssid)) {
-			template_wlan_reg_data.idx_ssid = i;
-		}
-		// conf_name
-		if ((template_wlan_reg_data.idx_conf_name < 0) && (template_wlan_reg_data.reg_entries[i].key_id == reg_id_conf_name)) {
-			template_wlan_reg_data.idx_conf_name = i;
-		}
-		// all found?
-		if ((template_wlan_reg_data.idx_ssid >= 0) && (template_wlan_reg_data.idx_conf_name >= 0)) {
-			break;
-		}
-	}
-
 	// create initial wlan reg data
 	init_reg_data(&initial_wlan_reg_data, &template_wlan_reg_data);
 	for (i = 0; i < initial_wlan_reg_data->reg_count; i++) {
 		// http_proxy_port
-		if (initial_wlan_reg_data->reg_entries[i].key_id == reg_id_http_proxy_port) {
-			*((int *)(initial_wlan_reg_data->reg_entries[i].key_value)) = 8080;
+		if (initial_wlan_reg_data->reg_entries[i].key_id == (REG_ID_HTTP_PROXY_PORT)) {
+			*((int *)(get_reg_value(initial_wlan_reg_data, i))) = 8080;
 		}
 		// enable_auto_connect
-		if (initial_wlan_reg_data->reg_entries[i].key_id == reg_id_enable_auto_connect) {
-			*((int *)(initial_wlan_reg_data->reg_entries[i].key_value))  = 1;
+		if (initial_wlan_reg_data->reg_entries[i].key_id == (REG_ID_ENABLE_AUTO_CONNECT)) {
+			*((int *)(get_reg_value(initial_wlan_reg_data, i)))  = 1;
 		}
 	}
 }
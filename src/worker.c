@@ -0,0 +1,265 @@
+/*
+  Vita Account Manager - Switch between multiple PSN/SEN accounts on a PS Vita or PS TV.
+  Copyright (C) 2019  "windsurfer1122"
+  https://github.com/windsurfer1122
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <vitasdk.h>
+
+#include <batch.h>
+#include <file.h>
+#include <main.h>
+#include <worker.h>
+
+#include <debugScreen.h>
+#define printf psvDebugScreenPrintf
+
+#define WORKER_BAR_WIDTH 20
+
+static struct Worker_Queue worker_commands;  // ui thread to worker
+static struct Worker_Queue worker_events;  // worker to ui thread
+static struct Worker_Job *worker_job;
+static volatile int worker_cancel;
+static int worker_skipping;  // only used by worker thread
+static SceUID worker_sema = -1;
+static SceUID worker_thread = -1;
+
+
+static int push_worker_message(struct Worker_Queue *queue, int type, int index)
+{
+	unsigned int tail;
+	struct Worker_Message *message;
+
+	tail = queue->tail;
+	if ((tail - queue->head) >= (WORKER_QUEUE_SIZE)) {  // full
+		return 0;
+	}
+	message = &(queue->messages[tail & ((WORKER_QUEUE_SIZE) - 1)]);
+	message->type = type;
+	message->index = index;
+	__sync_synchronize();  // message is complete before tail moves
+	queue->tail = tail + 1;
+
+	return 1;
+}
+
+static int pop_worker_message(struct Worker_Queue *queue, struct Worker_Message *message)
+{
+	unsigned int head;
+
+	head = queue->head;
+	if (head == queue->tail) {  // empty
+		return 0;
+	}
+	__sync_synchronize();  // message is read after tail was seen
+	*message = queue->messages[head & ((WORKER_QUEUE_SIZE) - 1)];
+	__sync_synchronize();  // slot is read before it is handed back
+	queue->head = head + 1;
+
+	return 1;
+}
+
+static int worker_thread_main(SceSize args, void *argp)
+{
+	struct Worker_Message command;
+	int event;
+
+	while (1) {
+		sceKernelWaitSema(worker_sema, 1, NULL);
+		if (!pop_worker_message(&worker_commands, &command)) {
+			continue;
+		}
+		if (command.type == (WORKER_COMMAND_QUIT)) {
+			break;
+		}
+
+		// cancel only takes effect between steps and up to commit step, later steps must complete the job
+		if (command.index == 0) {
+			worker_skipping = 0;
+		}
+		if (worker_skipping || (worker_cancel && (command.index <= worker_job->commit_step))) {
+			worker_skipping = 1;
+			event = (WORKER_EVENT_SKIPPED);
+		} else if (worker_job->run_step(worker_job->context, command.index) < 0) {
+			event = (WORKER_EVENT_FAILED);
+		} else {
+			event = (WORKER_EVENT_DONE);
+		}
+		// ui thread never has more steps in flight than events fit into queue
+		push_worker_message(&worker_events, event, command.index);
+	}
+
+	return 0;
+}
+
+void start_worker(void)
+{
+	if (worker_thread >= 0) {
+		return;
+	}
+
+	sceClibMemset(&worker_commands, 0x00, sizeof(worker_commands));
+	sceClibMemset(&worker_events, 0x00, sizeof(worker_events));
+	worker_job = NULL;
+	worker_cancel = 0;
+	worker_skipping = 0;
+
+	worker_sema = sceKernelCreateSema("worker_sema", 0, 0, (WORKER_QUEUE_SIZE) + 1, NULL);
+	worker_thread = sceKernelCreateThread("worker_thread", worker_thread_main, 0x10000100, 0x40000, 0, 0, NULL);
+	if (worker_thread >= 0) {
+		sceKernelStartThread(worker_thread, 0, NULL);
+	}
+
+	return;
+}
+
+void stop_worker(void)
+{
+	if (worker_thread < 0) {
+		return;
+	}
+
+	while (!push_worker_message(&worker_commands, (WORKER_COMMAND_QUIT), -1)) {
+		sceKernelDelayThread(1000);  // 1ms
+	}
+	sceKernelSignalSema(worker_sema, 1);
+	sceKernelWaitThreadEnd(worker_thread, NULL, NULL);
+	sceKernelDeleteThread(worker_thread);
+	worker_thread = -1;
+
+	sceKernelDeleteSema(worker_sema);
+	worker_sema = -1;
+
+	return;
+}
+
+static int get_worker_progress_row(void)
+{
+	// last full text row of screen
+	return (SCREEN_HEIGHT) / psv_font_current->size_h;
+}
+
+static void draw_worker_progress(const struct Worker_Job *const job, int received, SceUInt64 time_start)
+{
+	char bar[(WORKER_BAR_WIDTH)+1];
+	unsigned long long bytes;
+	unsigned long long elapsed;
+	unsigned long long rate;
+	unsigned int eta;
+	int filled;
+	int i;
+
+	bytes = file_bytes_copied;
+	elapsed = (sceKernelGetProcessTimeWide() - time_start) / 1000;  // ms
+	rate = 0;
+	if (elapsed > 0) {
+		rate = (bytes * 1000) / elapsed;
+	}
+
+	// progress and ETA by bytes when known, otherwise by steps
+	eta = 0;
+	if (job->total_bytes > 0) {
+		filled = (int)((bytes * (WORKER_BAR_WIDTH)) / job->total_bytes);
+		if ((rate > 0) && (bytes < job->total_bytes)) {
+			eta = (unsigned int)((job->total_bytes - bytes) / rate);
+		}
+	} else {
+		filled = (received * (WORKER_BAR_WIDTH)) / job->count;
+		if (received > 0) {
+			eta = (unsigned int)(((elapsed * (job->count - received)) / received) / 1000);
+		}
+	}
+	if (filled > (WORKER_BAR_WIDTH)) {
+		filled = (WORKER_BAR_WIDTH);
+	}
+	for (i = 0; i < (WORKER_BAR_WIDTH); i++) {
+		bar[i] = ((i < filled) ? '#' : '-');
+	}
+	bar[(WORKER_BAR_WIDTH)] = '\0';
+
+	// single print call, so it cannot interleave with step output of worker
+	printf("\e[s\e[%i;1H\e[7m[%s]\e[27m %i/%i steps, %llu KB, %llu KB/s, ETA %u s%s\e[0K\e[u", get_worker_progress_row(), bar, received, job->count, bytes / 1024, rate / 1024, eta, (worker_cancel ? ((received > job->commit_step) ? ", finishing..." : ", cancelling...") : ""));
+
+	return;
+}
+
+// runs job on worker thread while drawing progress, cancel button stops job at next step
+int run_worker_job(struct Worker_Job *job)
+{
+	struct Worker_Message event;
+	SceCtrlData pad;
+	SceUInt64 time_start;
+	int next;
+	int received;
+	int i;
+
+	job->done = 0;
+	job->failed = 0;
+	job->cancelled = 0;
+	file_bytes_copied = 0;
+
+	// batch mode has no screen to update, so steps run directly
+	if (batch_mode || (worker_thread < 0)) {
+		for (i = 0; i < job->count; i++) {
+			if (job->run_step(job->context, i) < 0) {
+				job->failed++;
+			} else {
+				job->done++;
+			}
+		}
+		return job->done;
+	}
+
+	worker_job = job;
+	worker_cancel = 0;
+	next = 0;
+	received = 0;
+	time_start = sceKernelGetProcessTimeWide();
+	while (received < job->count) {
+		// keep worker busy, but never more steps in flight than events fit into queue
+		while ((next < job->count) && ((next - received) < (WORKER_QUEUE_SIZE)) && push_worker_message(&worker_commands, (WORKER_COMMAND_STEP), next)) {
+			sceKernelSignalSema(worker_sema, 1);
+			next++;
+		}
+
+		while (pop_worker_message(&worker_events, &event)) {
+			received++;
+			if (event.type == (WORKER_EVENT_DONE)) {
+				job->done++;
+			} else if (event.type == (WORKER_EVENT_FAILED)) {
+				job->failed++;
+			} else {
+				job->cancelled++;
+			}
+		}
+
+		sceClibMemset(&pad, 0, sizeof(pad));
+		sceCtrlPeekBufferPositive(0, &pad, 1);
+		if (pad.buttons & button_cancel) {
+			worker_cancel = 1;
+		}
+
+		// redraw once per frame
+		draw_worker_progress(job, received, time_start);
+		sceDisplayWaitVblankStart();
+	}
+	printf("\e[s\e[%i;1H\e[0K\e[u", get_worker_progress_row());
+	worker_job = NULL;
+
+	return job->done;
+}